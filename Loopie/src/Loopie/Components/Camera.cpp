@@ -11,8 +11,9 @@
 namespace Loopie
 {
 	Camera* Camera::s_Main = nullptr;
+	uint32_t Camera::s_NextCullingContext = 0;
 
-	Camera::Camera(float fov, float near_plane, float far_plane, bool canBeMainCamera) : m_fov(fov), m_nearPlane(near_plane), m_farPlane(far_plane), m_canBeMainCamera(canBeMainCamera)
+	Camera::Camera(float fov, float near_plane, float far_plane, bool canBeMainCamera) : m_fov(fov), m_nearPlane(near_plane), m_farPlane(far_plane), m_canBeMainCamera(canBeMainCamera), m_cullingContext(s_NextCullingContext++)
 	{
 		m_renderTarget = nullptr;
 		Renderer::RegisterCamera(*this);
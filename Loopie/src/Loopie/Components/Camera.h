@@ -34,6 +34,7 @@ namespace Loopie
 		float GetFarPlane() const;
 		vec4 GetViewport() const { return m_viewport; }
 		const Frustum& GetFrustum() const;
+		uint32_t GetCullingContext() const { return m_cullingContext; }
 
 		void SetDirty() const;
 
@@ -70,7 +71,9 @@ namespace Loopie
 		std::shared_ptr<FrameBuffer> m_renderTarget = nullptr;
 
 		static Camera* s_Main;
+		static uint32_t s_NextCullingContext;
 		bool m_canBeMainCamera = true;
 		bool m_isMainCamera = false;
+		uint32_t m_cullingContext; // Octree frustum coherence slot, see Octree::VisitVisibleEntitiesFrustum
 	};
 }
\ No newline at end of file
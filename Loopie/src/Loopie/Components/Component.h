@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <cstdint>
 
 #include "Loopie/Core/IIdentificable.h"
 #include "Loopie/Core/ISerializable.h"
@@ -16,6 +17,7 @@ namespace Loopie {
 	class Component : public IIdentificable, public ISerializable
 	{
 		friend class Entity;
+		template<typename T> friend class ComponentPool;
 	public:
 		Component() = default;
 		virtual ~Component();
@@ -48,5 +50,6 @@ namespace Loopie {
 		std::weak_ptr<Entity> m_owner;
 		UUID m_uuid;
 		bool m_isActive = true;
+		uint32_t m_registrySlot = UINT32_MAX; // Slot inside its ComponentPool, unused when not pooled
 	};
 }
\ No newline at end of file
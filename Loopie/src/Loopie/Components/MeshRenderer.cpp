@@ -8,6 +8,10 @@
 #include "Loopie/Resources/AssetRegistry.h"
 #include "Loopie/Resources/ResourceManager.h"
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace Loopie {
 
 	MeshRenderer::MeshRenderer() {
@@ -16,11 +20,15 @@ namespace Loopie {
 
 	MeshRenderer::~MeshRenderer()
 	{
-		if (GetOwner() && GetTransform())
-			GetTransform()->m_transformNotifier.RemoveObserver(this);
+		if (GetOwner() && GetTransform()) {
+			GetTransform()->m_transformNotifier.RemoveObserver(static_cast<IObserver<TransformNotification>*>(this));
+			GetTransform()->m_transformNotifier.Notify(TransformNotification::OnBoundsChanged);
+		}
 
-		if (m_mesh)
+		if (m_mesh) {
+			m_mesh->m_resourceNotifier.RemoveObserver(static_cast<IObserver<ResourceNotification>*>(this));
 			m_mesh->DecrementReferenceCount();
+		}
 		if (m_material)
 			m_material->DecrementReferenceCount();
 	}
@@ -28,7 +36,7 @@ namespace Loopie {
 	void MeshRenderer::Init()
 	{
 		RecalculateBoundingBoxes();
-		GetTransform()->m_transformNotifier.AddObserver(this);
+		GetTransform()->m_transformNotifier.AddObserver(static_cast<IObserver<TransformNotification>*>(this));
 	}
 
 	void MeshRenderer::OnNotify(const TransformNotification& id)
@@ -38,6 +46,15 @@ namespace Loopie {
 		}
 	}
 
+	void MeshRenderer::OnNotify(const ResourceNotification& id)
+	{
+		if (id == ResourceNotification::OnLoaded) {
+			SetBoundingBoxesDirty();
+			if (GetOwner() && GetTransform())
+				GetTransform()->m_transformNotifier.Notify(TransformNotification::OnBoundsChanged);
+		}
+	}
+
 	void MeshRenderer::RenderGizmo() {
 		if (m_mesh) {
 			///TEST
@@ -58,12 +75,20 @@ namespace Loopie {
 
 	void MeshRenderer::SetMesh(std::shared_ptr<Mesh> mesh)
 	{
-		if (m_mesh)
+		if (m_mesh) {
+			m_mesh->m_resourceNotifier.RemoveObserver(static_cast<IObserver<ResourceNotification>*>(this));
 			m_mesh->DecrementReferenceCount();
+		}
 		m_mesh = mesh;
-		if (m_mesh)
+		if (m_mesh) {
 			m_mesh->IncrementReferenceCount();
+			if (!m_mesh->IsLoaded())
+				m_mesh->m_resourceNotifier.AddObserver(static_cast<IObserver<ResourceNotification>*>(this));
+		}
 		SetBoundingBoxesDirty();
+
+		if (GetOwner() && GetTransform())
+			GetTransform()->m_transformNotifier.Notify(TransformNotification::OnBoundsChanged);
 	}
 
 	void MeshRenderer::SetMaterial(std::shared_ptr<Material> material)
@@ -118,7 +143,7 @@ namespace Loopie {
 
 			Metadata* meta = AssetRegistry::GetMetadata(id);
 			if (meta)
-				SetMesh(ResourceManager::GetMesh(*meta, index));
+				SetMesh(ResourceManager::GetMeshAsync(*meta, index));
 		}
 		if (data.Contains("material_uuid")) {
 			UUID id = UUID(data.GetValue<std::string>("material_uuid").Result);
@@ -130,6 +155,9 @@ namespace Loopie {
 
 	bool MeshRenderer::GetTriangle(int triangleIndex, Triangle& triangle)
 	{
+		if (!m_mesh || !m_mesh->IsLoaded())
+			return false;
+
 		const BufferLayout& layout = m_mesh->m_vbo->GetLayout();
 		const BufferElement* posElem = layout.GetElementByIndex(0);
 		if (posElem->Type == GLVariableType::NONE)
@@ -161,6 +189,27 @@ namespace Loopie {
 		return true;
 	}
 
+	bool MeshRenderer::Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance,
+							   float& distance, unsigned int& triangleIndex, vec2& barycentric)
+	{
+		if (!m_mesh || !m_mesh->IsLoaded())
+			return false;
+
+		const BufferElement* posElem = m_mesh->m_vbo->GetLayout().GetElementByIndex(0);
+		if (posElem->Type == GLVariableType::NONE)
+			return false;
+
+		// The direction is not normalized after the transform, so hit distances stay in world units
+		const matrix4& worldToLocal = GetTransform()->GetWorldToLocalMatrix();
+		vec3 localOrigin = vec3(worldToLocal * vec4(rayOrigin, 1));
+		vec3 localDirection = vec3(worldToLocal * vec4(rayDirection, 0));
+
+		const MeshData& meshData = m_mesh->GetData();
+		return meshData.TriangleBVH.Raycast(localOrigin, localDirection, maxDistance,
+											meshData.Vertices.data(), meshData.VertexElements, posElem->Offset / sizeof(float), meshData.Indices.data(),
+											distance, triangleIndex, barycentric);
+	}
+
 	void MeshRenderer::RecalculateBoundingBoxes() const
 	{
 		if (!m_boundingBoxesDirty || !m_mesh)
@@ -197,22 +246,54 @@ namespace Loopie {
 		if (posElem->Type == GLVariableType::NONE)
 			return;
 
-		unsigned int  triangleCount = (unsigned int)data.Indices.size() / 3;
-
-		for (unsigned int i = 0; i + 1 < triangleCount; i += 2) {
-			Triangle t1, t2;
-
-			if (!GetTriangle(i, t1)) continue;
-			if (!GetTriangle(i+1, t2)) continue;
-
-
-			vec3 n1 = normalize(cross(t1.v1 - t1.v0, t1.v2 - t1.v0));
-			vec3 n2 = normalize(cross(t2.v1 - t2.v0, t2.v2 - t2.v0));
-			vec3 faceNormal = normalize(n1 + n2);
+		// The importer reorders triangles for the vertex cache, so the two halves of a quad are rarely
+		// consecutive anymore. They are paired by a shared edge instead, when both lie on the same plane
+		constexpr unsigned int NO_TRIANGLE = ~0u;
+		const std::vector<unsigned int>& indices = data.Indices;
+		unsigned int  triangleCount = (unsigned int)indices.size() / 3;
+
+		auto edgeKey = [&indices](unsigned int triangle, int edge) {
+			unsigned int a = indices[triangle * 3 + edge];
+			unsigned int b = indices[triangle * 3 + (edge + 1) % 3];
+			return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+		};
+
+		std::unordered_map<uint64_t, std::pair<unsigned int, unsigned int>> edgeTriangles;
+		edgeTriangles.reserve(indices.size());
+		for (unsigned int i = 0; i < triangleCount; i++) {
+			for (int edge = 0; edge < 3; edge++) {
+				auto [it, inserted] = edgeTriangles.try_emplace(edgeKey(i, edge), i, NO_TRIANGLE);
+				if (!inserted && it->second.second == NO_TRIANGLE)
+					it->second.second = i;
+			}
+		}
 
-			vec3 centroid1 = (t1.v0 + t1.v1 + t1.v2) / 3.0f;
-			vec3 centroid2 = (t2.v0 + t2.v1 + t2.v2) / 3.0f;
-			vec3 faceCentroid = (centroid1 + centroid2) * 0.5f;
+		std::vector<bool> drawn(triangleCount, false);
+		for (unsigned int i = 0; i < triangleCount; i++) {
+			Triangle t1;
+			if (drawn[i] || !GetTriangle(i, t1))
+				continue;
+			drawn[i] = true;
+
+			vec3 faceNormal = normalize(cross(t1.v1 - t1.v0, t1.v2 - t1.v0));
+			vec3 faceCentroid = (t1.v0 + t1.v1 + t1.v2) / 3.0f;
+
+			for (int edge = 0; edge < 3; edge++) {
+				const std::pair<unsigned int, unsigned int>& owners = edgeTriangles[edgeKey(i, edge)];
+				unsigned int other = owners.first == i ? owners.second : owners.first;
+				Triangle t2;
+				if (other == NO_TRIANGLE || drawn[other] || !GetTriangle(other, t2))
+					continue;
+
+				vec3 n2 = normalize(cross(t2.v1 - t2.v0, t2.v2 - t2.v0));
+				if (dot(faceNormal, n2) < 0.999f)
+					continue;
+
+				drawn[other] = true;
+				faceNormal = normalize(faceNormal + n2);
+				faceCentroid = (faceCentroid + (t2.v0 + t2.v1 + t2.v2) / 3.0f) * 0.5f;
+				break;
+			}
 
 			Gizmo::DrawLine(faceCentroid, faceCentroid + faceNormal * length, color);
 		}
@@ -13,7 +13,7 @@ namespace Loopie {
 		vec3 v0, v1, v2;
 	};
 
-	class MeshRenderer : public Component, public IObserver<TransformNotification> {
+	class MeshRenderer : public Component, public IObserver<TransformNotification>, public IObserver<ResourceNotification> {
 	public:
 		DEFINE_TYPE(MeshRenderer)
 
@@ -21,6 +21,7 @@ namespace Loopie {
 		~MeshRenderer();
 		void Init() override; //// From Component
 		void OnNotify(const TransformNotification& id) override;
+		void OnNotify(const ResourceNotification& id) override; // The mesh finished an async load
 
 		void RenderGizmo() override;
 		
@@ -50,6 +51,10 @@ namespace Loopie {
 		void Deserialize(const JsonNode& data) override;
 
 		bool GetTriangle(int triangleIndex, Triangle& triangle);
+		// Closest triangle hit by a world space ray, found through the mesh's BVH. The ray is moved to mesh
+		// space instead of moving the triangles to world space, distance stays in world units when rayDirection is normalized
+		bool Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance,
+					 float& distance, unsigned int& triangleIndex, vec2& barycentric);
 
 	private:
 		void RecalculateBoundingBoxes() const;
@@ -12,6 +12,12 @@ namespace Loopie
         m_localScale = scale;
     };
 
+    Transform::~Transform()
+    {
+        if (m_systemSlot.System)
+            m_systemSlot.System->Remove(this);
+    }
+
     void Transform::Init() 
     {
         ForceRefreshMatrices();
@@ -302,12 +308,25 @@ namespace Loopie
 
     void Transform::MarkLocalDirty()
     {
+        if (m_systemSlot.System)
+        {
+            m_systemSlot.System->MarkLocalDirty(this);
+            return;
+        }
+
         m_localDirty = true;
         MarkWorldDirty();
     }
 
     void Transform::MarkWorldDirty()
     {
+        // Children of a system transform find out through the system on its next Update
+        if (m_systemSlot.System)
+        {
+            m_systemSlot.System->MarkWorldDirty(this);
+            return;
+        }
+
         if (m_worldDirty) 
             return;
         m_worldDirty = true;
@@ -320,11 +339,20 @@ namespace Loopie
     }
 
     bool Transform::IsDirty() const{
+        if (m_systemSlot.System)
+            return m_systemSlot.System->IsStale(this);
         return m_worldDirty || m_localDirty;
     }
 
     void Transform::ForceRefreshMatrices()
     {
+        if (m_systemSlot.System)
+        {
+            m_systemSlot.System->MarkLocalDirty(this);
+            m_systemSlot.System->Refresh(this);
+            return;
+        }
+
         m_localDirty = true;
         m_worldDirty = true;
         RefreshMatrices();
@@ -332,6 +360,14 @@ namespace Loopie
             if (child) child->GetTransform()->ForceRefreshMatrices();
     }
 
+    void Transform::OnParentChanged(Transform* parent)
+    {
+        if (m_systemSlot.System)
+            m_systemSlot.System->SetParent(this, parent);
+        else
+            MarkWorldDirty();
+    }
+
     JsonNode Transform::Serialize(JsonNode& parent) const
     {
         JsonNode transformObj = parent.CreateObjectField("transform");
@@ -398,9 +434,15 @@ namespace Loopie
 
     void Transform::RefreshMatrices() const
     {
+        if (m_systemSlot.System)
+        {
+            m_systemSlot.System->Refresh(this);
+            return;
+        }
+
         if (!IsDirty()) return;
 
-        matrix4 localMat = translate(matrix4(1.0f), m_localPosition) * toMat4(m_localRotation) * scale(matrix4(1.0f), m_localScale);
+        matrix4 localMat = ComputeLocalMatrix();
 
         if (auto parent = GetOwner()->GetParent().lock())
         {
@@ -420,4 +462,9 @@ namespace Loopie
 
         m_transformNotifier.Notify(TransformNotification::OnChanged);
     }
+
+    matrix4 Transform::ComputeLocalMatrix() const
+    {
+        return translate(matrix4(1.0f), m_localPosition) * toMat4(m_localRotation) * scale(matrix4(1.0f), m_localScale);
+    }
 };
\ No newline at end of file
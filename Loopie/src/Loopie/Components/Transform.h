@@ -4,6 +4,7 @@
 #include "Loopie/Math/MathTypes.h"
 #include "Loopie/Events/Event.h"
 #include "Loopie/Events/EventTypes.h"
+#include "Loopie/Scene/TransformSystem.h"
 
 #include <memory>
 namespace Loopie
@@ -12,11 +13,12 @@ namespace Loopie
 
     class Transform : public Component
     {
+        friend class TransformSystem;
     public:
         DEFINE_TYPE(Transform)
 
         Transform(vec3 position = { 0,0,0 }, quaternion rotation = { 1, 0,0,0 }, vec3 scale = { 1,1,1 });
-        ~Transform() = default;
+        ~Transform();
         void Init()override;
 
         vec3 GetPosition();
@@ -61,6 +63,8 @@ namespace Loopie
         bool IsDirty() const;
 
         void ForceRefreshMatrices();
+        // Called by Entity whenever this transform's entity is attached to or detached from a parent
+        void OnParentChanged(Transform* parent);
 
         // Serialize & Deserialize
         JsonNode Serialize(JsonNode& parent) const override;
@@ -73,6 +77,7 @@ namespace Loopie
         vec3 GetWorldScale() const;
 
         void RefreshMatrices() const;
+        matrix4 ComputeLocalMatrix() const;
 
     public:
         Event<TransformNotification> m_transformNotifier;
@@ -88,7 +93,10 @@ namespace Loopie
         mutable matrix4 m_localToWorld = matrix4(1);
         mutable matrix4 m_worldToLocal = matrix4(1);
 
+        // Only used by transforms outside a TransformSystem, the system keeps its own flags
         mutable bool m_localDirty = true;
         mutable bool m_worldDirty = true;
+
+        TransformSystemSlot m_systemSlot;
     };
 }
\ No newline at end of file
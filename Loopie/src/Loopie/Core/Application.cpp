@@ -1,10 +1,13 @@
 #include "Application.h"
 
 #include "Loopie/Core/Assert.h"
+#include "Loopie/Core/JobSystem.h"
 #include "Loopie/Core/Log.h"
 #include "Loopie/Core/Time.h"
 #include "Loopie/Render/Renderer.h"
 #include "Loopie/Core/AudioManager.h"
+#include "Loopie/Resources/ResourceManager.h"
+#include "Loopie/Resources/TextureStreamer.h"
 
 namespace Loopie {
 	Application* Application::s_Instance = nullptr;
@@ -19,6 +22,8 @@ namespace Loopie {
 
 		Log::Info("Application Started");
 
+		JobSystem::Init();
+
 		// Window Creation
 		m_window = new Window();
 		Log::Info("Window created successfully.");
@@ -41,6 +46,7 @@ namespace Loopie {
 		m_modules.clear();
 
 		AudioManager::Shutdown();
+		JobSystem::Shutdown();
 
 		//// Cleaning
 		delete(m_window); 
@@ -96,13 +102,16 @@ namespace Loopie {
 	{
 		while (m_running)
 		{
-
+			Renderer::BeginFrame();
 			Renderer::Clear();
 
 			Time::CalculateFrame();
 
 			AudioManager::Update();
 
+			ResourceManager::ProcessUploads();
+			TextureStreamer::Update();
+
 			m_imguiManager.StartFrame();
 
 			m_inputEvent.Update();
@@ -0,0 +1,77 @@
+#pragma once
+#include "Loopie/Core/JobSystem.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Loopie {
+	// *** Async upload queue ***
+	// Loads read by a job and finished on the main thread, usually a GL upload, under a time budget.
+	// Start dispatches the read job, which hands the load back with Push as its last step, and
+	// ProcessFinished finishes loads in the order they were pushed. What doesn't fit the budget waits
+	// for the next call in the same order.
+	template<typename T>
+	class AsyncUploadQueue
+	{
+	public:
+		// Main thread. read gets the T* and owns it from then on
+		void Start(std::unique_ptr<T> load, JobFunction read)
+		{
+			++m_pending;
+
+			// Jobs queued from the main thread are only picked up by the workers, without any the
+			// read happens here and just the upload is deferred
+			if (JobSystem::GetThreadCount() > 1)
+				JobSystem::Run(read, load.release());
+			else
+				read(load.release());
+		}
+
+		// Any thread
+		void Push(std::unique_ptr<T> load)
+		{
+			std::lock_guard<std::mutex> lock(m_finishedMutex);
+			m_finished.push_back(std::move(load));
+		}
+
+		// Main thread. Calls finish(T&) on finished loads until budgetMs is spent, always at least one
+		template<typename Finish>
+		void ProcessFinished(float budgetMs, Finish&& finish)
+		{
+			if (m_pending == 0)
+				return;
+
+			std::vector<std::unique_ptr<T>> finished;
+			{
+				std::lock_guard<std::mutex> lock(m_finishedMutex);
+				finished.swap(m_finished);
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			size_t done = 0;
+			for (; done < finished.size(); ++done) {
+				if (done > 0 && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+					break;
+				--m_pending;
+				finish(*finished[done]);
+			}
+
+			if (done < finished.size()) {
+				std::lock_guard<std::mutex> lock(m_finishedMutex);
+				m_finished.insert(m_finished.begin(), std::make_move_iterator(finished.begin() + done), std::make_move_iterator(finished.end()));
+			}
+		}
+
+		// Started and not finished yet, main thread only
+		size_t GetPendingCount() const { return m_pending; }
+
+	private:
+		std::vector<std::unique_ptr<T>> m_finished; // Read by a job, waiting for the upload
+		std::mutex m_finishedMutex;
+		size_t m_pending = 0;
+	};
+}
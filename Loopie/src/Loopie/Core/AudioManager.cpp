@@ -52,46 +52,31 @@ namespace Loopie {
 
         if (!scene) return;
 
-        glm::vec3 listenerPos(0, 0, 0);
         bool listenerFound = false;
 
-        auto& allEntities = scene->GetAllEntities();
-
-        for (auto& [uuid, entity] : allEntities)
+        // Only entities with the component are visited, straight from the component pools
+        scene->View<AudioListener, Transform>([&](Entity& entity, AudioListener& listener, Transform& t)
         {
-            if (entity->GetIsActive())
-            {
-                auto listener = entity->GetComponent<AudioListener>();
-                if (listener)
-                {
-                    Transform* t = entity->GetTransform();
-                    if (t) {
-                        listenerPos = t->GetPosition();
-                        SetListenerAttributes(t->GetPosition(), t->Forward(), t->Up());
-                        listenerFound = true;
-                        break;
-                    }
-                }
-            }
-        }
+            if (listenerFound || !entity.GetIsActive())
+                return;
+
+            SetListenerAttributes(t.GetPosition(), t.Forward(), t.Up());
+            listenerFound = true;
+        });
 
         if (!listenerFound) SetListenerAttributes({ 0,0,0 }, { 0,0,1 }, { 0,1,0 });
 
 
-        for (auto& [uuid, entity] : allEntities)
+        scene->View<AudioSource, Transform>([](Entity& entity, AudioSource& source, Transform& t)
         {
-            if (entity->GetIsActive())
-            {
-                auto source = entity->GetComponent<AudioSource>();
-                if (source) {
-                    source->OnUpdate();
+            if (!entity.GetIsActive())
+                return;
 
-                    Transform* t = entity->GetTransform();
-                    if (t && AudioManager::IsInTunnel(t->GetPosition())) source->SetPitch(0.5f);
-                    else source->SetPitch(1.0f);
-                }
-            }
-        }
+            source.OnUpdate();
+
+            if (AudioManager::IsInTunnel(t.GetPosition())) source.SetPitch(0.5f);
+            else source.SetPitch(1.0f);
+        });
     }
 
     void AudioManager::SetTunnelZone(const glm::vec3& center, const glm::vec3& size) {
@@ -0,0 +1,323 @@
+#include "JobSystem.h"
+#include "Loopie/Core/Log.h"
+
+#include <algorithm>
+
+namespace Loopie {
+	namespace {
+		constexpr unsigned int INVALID_THREAD_INDEX = UINT32_MAX;
+		constexpr int64_t JOB_DEQUE_MASK = JOB_DEQUE_CAPACITY - 1;
+		constexpr uint32_t JOB_BATCHES_PER_THREAD = 4; // Leaves room for stealing when batches are unbalanced
+
+		thread_local unsigned int t_threadIndex = INVALID_THREAD_INDEX;
+		thread_local std::vector<Job*> t_freeJobs;
+
+		struct ParallelForBatch
+		{
+			ParallelForFunction Function;
+			void* UserData;
+			uint32_t First;
+			uint32_t End;
+		};
+	}
+
+	std::vector<std::unique_ptr<JobSystem::JobDeque>> JobSystem::s_deques;
+	std::vector<std::thread> JobSystem::s_threads;
+	bool JobSystem::s_running = false;
+
+	std::atomic<uint32_t> JobSystem::s_queuedJobs{ 0 };
+	std::atomic<uint32_t> JobSystem::s_sleepingWorkers{ 0 };
+	std::atomic<bool> JobSystem::s_stopping{ false };
+	std::mutex JobSystem::s_wakeMutex;
+	std::condition_variable JobSystem::s_wakeCondition;
+
+	// *** Chase-Lev deque ***
+	// Only the owner touches m_bottom, thieves race on m_top with a CAS. The last job is claimed
+	// through m_top by the owner too, so it cannot be taken twice. All orderings on m_top and
+	// m_bottom that need a store followed by a load are sequentially consistent.
+	bool JobSystem::JobDeque::Push(Job* job)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		int64_t top = m_top.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(JOB_DEQUE_CAPACITY))
+			return false;
+
+		m_jobs[bottom & JOB_DEQUE_MASK].store(job, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job* JobSystem::JobDeque::Pop()
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(bottom, std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = m_jobs[bottom & JOB_DEQUE_MASK].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* JobSystem::JobDeque::Steal()
+	{
+		int64_t top = m_top.load(std::memory_order_seq_cst);
+		int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+		if (top >= bottom)
+			return nullptr;
+
+		Job* job = m_jobs[top & JOB_DEQUE_MASK].load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+	void JobSystem::Init(unsigned int threadCount)
+	{
+		if (s_running)
+			return;
+
+		if (threadCount == 0)
+			threadCount = std::thread::hardware_concurrency();
+		if (threadCount == 0)
+			threadCount = 1;
+
+		for (unsigned int i = 0; i < threadCount; ++i)
+			s_deques.push_back(std::make_unique<JobDeque>());
+
+		s_stopping = false;
+		s_running = true;
+		t_threadIndex = 0;
+
+		for (unsigned int i = 1; i < threadCount; ++i)
+			s_threads.emplace_back(&JobSystem::WorkerLoop, i);
+
+		Log::Info("Job system started with {0} threads", threadCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!s_running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(s_wakeMutex);
+			s_stopping = true;
+		}
+		s_wakeCondition.notify_all();
+
+		for (std::thread& thread : s_threads)
+			thread.join();
+		s_threads.clear();
+
+		// Whatever the main thread queued and never waited for still runs
+		while (Job* job = s_deques[0]->Pop())
+			Execute(job);
+
+		s_deques.clear();
+		s_running = false;
+		t_threadIndex = INVALID_THREAD_INDEX;
+
+		for (Job* job : t_freeJobs)
+			delete job;
+		t_freeJobs.clear();
+	}
+
+	void JobSystem::Run(JobFunction function, void* userData, JobCounter* counter)
+	{
+		if (counter)
+			counter->m_value.fetch_add(1, std::memory_order_relaxed);
+
+		Job* job = AllocateJob();
+		job->Function = function;
+		job->UserData = userData;
+		job->Counter = counter;
+		Submit(job);
+	}
+
+	void JobSystem::RunAfter(JobCounter& dependency, JobFunction function, void* userData, JobCounter* counter)
+	{
+		if (counter)
+			counter->m_value.fetch_add(1, std::memory_order_relaxed);
+
+		Job* job = AllocateJob();
+		job->Function = function;
+		job->UserData = userData;
+		job->Counter = counter;
+
+		{
+			// FinishJob takes the same lock after the counter reaches zero, so the job is either
+			// picked up there or queued here, never both
+			std::lock_guard<std::mutex> lock(dependency.m_continuationsMutex);
+			if (dependency.m_value.load(std::memory_order_acquire) != 0)
+			{
+				dependency.m_continuations.push_back(job);
+				return;
+			}
+		}
+		Submit(job);
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		unsigned int threadIndex = t_threadIndex;
+		while (!counter.IsDone())
+		{
+			Job* job = threadIndex != INVALID_THREAD_INDEX ? GetJob(threadIndex) : nullptr;
+			if (job)
+				Execute(job);
+			else
+				std::this_thread::yield();
+		}
+
+		// Waits for the thread that finished the last job to let go of the counter
+		std::lock_guard<std::mutex> lock(counter.m_continuationsMutex);
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t minBatchSize, ParallelForFunction function, void* userData)
+	{
+		if (count == 0)
+			return;
+
+		minBatchSize = std::max(minBatchSize, 1u);
+		uint32_t batchCount = std::min((count + minBatchSize - 1) / minBatchSize, GetThreadCount() * JOB_BATCHES_PER_THREAD);
+		if (batchCount <= 1 || t_threadIndex == INVALID_THREAD_INDEX)
+		{
+			function(0, count, userData);
+			return;
+		}
+
+		std::vector<ParallelForBatch> batches(batchCount);
+		for (uint32_t i = 0; i < batchCount; ++i)
+		{
+			batches[i].Function = function;
+			batches[i].UserData = userData;
+			batches[i].First = static_cast<uint32_t>(uint64_t(count) * i / batchCount);
+			batches[i].End = static_cast<uint32_t>(uint64_t(count) * (i + 1) / batchCount);
+		}
+
+		// The first batch stays on this thread, the rest are up for grabs
+		JobCounter counter;
+		for (uint32_t i = 1; i < batchCount; ++i)
+		{
+			Run([](void* data) {
+				ParallelForBatch& batch = *static_cast<ParallelForBatch*>(data);
+				batch.Function(batch.First, batch.End, batch.UserData);
+			}, &batches[i], &counter);
+		}
+
+		function(batches[0].First, batches[0].End, userData);
+		Wait(counter);
+	}
+
+	void JobSystem::WorkerLoop(unsigned int threadIndex)
+	{
+		t_threadIndex = threadIndex;
+
+		while (true)
+		{
+			if (Job* job = GetJob(threadIndex))
+			{
+				Execute(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(s_wakeMutex);
+			if (s_stopping)
+				break;
+
+			s_sleepingWorkers.fetch_add(1);
+			s_wakeCondition.wait(lock, [] { return s_stopping || s_queuedJobs.load() > 0; });
+			s_sleepingWorkers.fetch_sub(1);
+		}
+
+		for (Job* job : t_freeJobs)
+			delete job;
+		t_freeJobs.clear();
+	}
+
+	Job* JobSystem::GetJob(unsigned int threadIndex)
+	{
+		Job* job = s_deques[threadIndex]->Pop();
+
+		size_t threadCount = s_deques.size();
+		for (size_t i = 1; !job && i < threadCount; ++i)
+			job = s_deques[(threadIndex + i) % threadCount]->Steal();
+
+		if (job)
+			s_queuedJobs.fetch_sub(1);
+		return job;
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		job->Function(job->UserData);
+		JobCounter* counter = job->Counter;
+		FreeJob(job);
+
+		if (counter)
+			FinishJob(counter);
+	}
+
+	void JobSystem::Submit(Job* job)
+	{
+		unsigned int threadIndex = t_threadIndex;
+		if (threadIndex == INVALID_THREAD_INDEX || !s_deques[threadIndex]->Push(job))
+		{
+			// Not a job system thread, or its deque is full
+			Execute(job);
+			return;
+		}
+
+		s_queuedJobs.fetch_add(1);
+		if (s_sleepingWorkers.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(s_wakeMutex);
+			s_wakeCondition.notify_one();
+		}
+	}
+
+	void JobSystem::FinishJob(JobCounter* counter)
+	{
+		// Decremented under the lock: once a waiter sees zero it takes the same lock before returning,
+		// so the counter is not destroyed while this thread still holds it
+		std::vector<Job*> continuations;
+		{
+			std::lock_guard<std::mutex> lock(counter->m_continuationsMutex);
+			if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				continuations.swap(counter->m_continuations);
+		}
+		for (Job* job : continuations)
+			Submit(job);
+	}
+
+	Job* JobSystem::AllocateJob()
+	{
+		if (t_freeJobs.empty())
+			return new Job();
+
+		Job* job = t_freeJobs.back();
+		t_freeJobs.pop_back();
+		return job;
+	}
+
+	void JobSystem::FreeJob(Job* job)
+	{
+		if (t_freeJobs.size() >= JOB_FREE_LIST_LIMIT)
+		{
+			delete job;
+			return;
+		}
+		t_freeJobs.push_back(job);
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Loopie {
+	using JobFunction = void(*)(void* userData);
+	// Called by JobSystem::ParallelFor once per batch with the range [first, end) of indices
+	using ParallelForFunction = void(*)(uint32_t first, uint32_t end, void* userData);
+
+	constexpr uint32_t JOB_DEQUE_CAPACITY = 4096; // Per thread, must be a power of two
+	constexpr size_t JOB_FREE_LIST_LIMIT = 1024; // Finished jobs each thread keeps for reuse
+
+	class JobCounter;
+
+	struct Job
+	{
+		JobFunction Function = nullptr;
+		void* UserData = nullptr;
+		JobCounter* Counter = nullptr; // Decremented once the job has run
+	};
+
+	// Number of jobs still pending. Jobs queued with JobSystem::RunAfter wait for it to reach zero.
+	// A counter must outlive the jobs referencing it, call JobSystem::Wait on it before it goes away.
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> m_value{ 0 };
+		std::mutex m_continuationsMutex;
+		std::vector<Job*> m_continuations;
+	};
+
+	// *** Job system ***
+	// One worker per hardware thread besides the main one, each with a lock free work stealing deque
+	// (Chase-Lev). A thread pushes and pops at the bottom of its own deque, idle threads steal from
+	// the top of the others. Threads waiting on a counter keep running jobs meanwhile, so waiting from
+	// inside a job is fine. Jobs can only be queued from the main thread and from inside other jobs,
+	// anywhere else (or before Init) they run right away on the calling thread.
+	class JobSystem
+	{
+	public:
+		// Call from the main thread. threadCount counts the main thread, 0 uses one per hardware thread
+		static void Init(unsigned int threadCount = 0);
+		static void Shutdown();
+
+		static bool IsRunning() { return s_running; }
+		static unsigned int GetThreadCount() { return static_cast<unsigned int>(s_deques.size()); }
+
+		static void Run(JobFunction function, void* userData, JobCounter* counter = nullptr);
+		// Queues the job once dependency reaches zero, counter is incremented right away
+		static void RunAfter(JobCounter& dependency, JobFunction function, void* userData, JobCounter* counter = nullptr);
+		// Runs other jobs on the calling thread until counter reaches zero
+		static void Wait(JobCounter& counter);
+
+		// Splits [0, count) into batches of at least minBatchSize indices, a few per thread, runs them
+		// as jobs and waits for all of them
+		static void ParallelFor(uint32_t count, uint32_t minBatchSize, ParallelForFunction function, void* userData);
+
+		// Calls func(index) for every index in [0, count)
+		template<typename Func>
+		static void ParallelFor(uint32_t count, uint32_t minBatchSize, Func&& func)
+		{
+			ParallelFor(count, minBatchSize, [](uint32_t first, uint32_t end, void* userData) {
+				Func& batchFunc = *static_cast<std::remove_reference_t<Func>*>(userData);
+				for (uint32_t i = first; i < end; ++i)
+					batchFunc(i);
+			}, const_cast<void*>(static_cast<const void*>(&func)));
+		}
+
+	private:
+		class JobDeque
+		{
+		public:
+			bool Push(Job* job);
+			Job* Pop();
+			Job* Steal();
+
+		private:
+			std::atomic<int64_t> m_top{ 0 };
+			std::atomic<int64_t> m_bottom{ 0 };
+			std::atomic<Job*> m_jobs[JOB_DEQUE_CAPACITY] = {};
+		};
+
+		static void WorkerLoop(unsigned int threadIndex);
+		static Job* GetJob(unsigned int threadIndex);
+		static void Execute(Job* job);
+		static void Submit(Job* job);
+		static void FinishJob(JobCounter* counter);
+		static Job* AllocateJob();
+		static void FreeJob(Job* job);
+
+	private:
+		static std::vector<std::unique_ptr<JobDeque>> s_deques; // s_deques[0] belongs to the main thread
+		static std::vector<std::thread> s_threads;
+		static bool s_running;
+
+		static std::atomic<uint32_t> s_queuedJobs; // Pushed but not taken yet, lets idle workers sleep
+		static std::atomic<uint32_t> s_sleepingWorkers;
+		static std::atomic<bool> s_stopping;
+		static std::mutex s_wakeMutex;
+		static std::condition_variable s_wakeCondition;
+	};
+}
@@ -3,6 +3,8 @@
 namespace Loopie {
 
     std::vector<Log::LogEntry> Log::s_LogEntries;
+    std::vector<Log::LogEntry> Log::s_PendingEntries;
+    std::mutex Log::s_PendingMutex;
 
 	void Log::Init() {
         auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -12,4 +14,18 @@ namespace Loopie {
         auto logger = std::make_shared<spdlog::logger>("LoopieLogger", console_sink);
         spdlog::set_default_logger(logger);
 	}
+
+    const std::vector<Log::LogEntry>& Log::GetLogEntries() {
+        std::lock_guard<std::mutex> lock(s_PendingMutex);
+        for (LogEntry& entry : s_PendingEntries)
+            s_LogEntries.emplace_back(std::move(entry));
+        s_PendingEntries.clear();
+        return s_LogEntries;
+    }
+
+    void Log::Clear() {
+        std::lock_guard<std::mutex> lock(s_PendingMutex);
+        s_PendingEntries.clear();
+        s_LogEntries.clear();
+    }
 }
\ No newline at end of file
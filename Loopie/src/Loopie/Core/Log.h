@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <mutex>
 #include <vector>
 
 namespace Loopie {
@@ -50,16 +51,21 @@ namespace Loopie {
             LogMessage(spdlog::level::critical, fmt::format(msg, std::forward<Args>(args)...));
         }
 
-		static const std::vector<LogEntry>& GetLogEntries() { return s_LogEntries; }
-		static void Clear() { s_LogEntries.clear(); }
+		// Logging is safe from any thread. Entries logged by other threads show up here on the
+		// next call, so GetLogEntries and Clear are meant for the main thread only.
+		static const std::vector<LogEntry>& GetLogEntries();
+		static void Clear();
 
 	private:
 		static void LogMessage(spdlog::level::level_enum level, const std::string& text) {
 			spdlog::log(level, text);
-			s_LogEntries.emplace_back(LogEntry(level, fmt::format("[{}] {}", spdlog::level::to_string_view(level), text)));
+			std::lock_guard<std::mutex> lock(s_PendingMutex);
+			s_PendingEntries.emplace_back(LogEntry(level, fmt::format("[{}] {}", spdlog::level::to_string_view(level), text)));
 		}
 
 	private:
 		static std::vector<LogEntry> s_LogEntries;
+		static std::vector<LogEntry> s_PendingEntries;
+		static std::mutex s_PendingMutex;
 	};
 }
\ No newline at end of file
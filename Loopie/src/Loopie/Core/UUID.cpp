@@ -1,38 +1,121 @@
 #include "Loopie/Core/UUID.h"
-#include "Loopie/Core/Random.h"
-#include "Loopie/Core/Assert.h"
+#include "Loopie/Core/Log.h"
+
+#include <chrono>
+#include <random>
 
 namespace Loopie {
 
-    UUID::UUID() : m_id(Generate()) {
-    }
+    namespace {
+        // Byte offset of every hex digit in the text form, skipping the dashes
+        constexpr unsigned char s_digitPositions[32] = {
+            0, 1, 2, 3, 4, 5, 6, 7,
+            9, 10, 11, 12,
+            14, 15, 16, 17,
+            19, 20, 21, 22,
+            24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35
+        };
+
+        // Maps a character to its hex value, 0x10 flags anything that is not a hex digit
+        struct HexTable {
+            unsigned char Values[256];
 
-    UUID::UUID(const std::string& id)
-        : m_id(id) {
-        ASSERT(m_id.size() != UUID_SIZE, "UUID id does not have a correct size of {0}, current size is {1}", UUID_SIZE, m_id.size());
+            constexpr HexTable() : Values() {
+                for (int i = 0; i < 256; i++)
+                    Values[i] = 0x10;
+                for (int i = 0; i < 10; i++)
+                    Values['0' + i] = static_cast<unsigned char>(i);
+                for (int i = 0; i < 6; i++) {
+                    Values['a' + i] = static_cast<unsigned char>(10 + i);
+                    Values['A' + i] = static_cast<unsigned char>(10 + i);
+                }
+            }
+        };
+        constexpr HexTable s_hexTable;
+
+        uint64_t SplitMix64(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        uint64_t SeedGenerator() {
+            std::random_device device;
+            uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+            // Mix in the clock in case random_device is deterministic on this platform
+            seed ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+            return seed;
+        }
+
+        // FNV-1a of the text stretched to 128 bits, so the same malformed id always maps to the same UUID
+        void HashText(const std::string& text, uint64_t& outHigh, uint64_t& outLow) {
+            uint64_t state = 0xCBF29CE484222325ull;
+            for (unsigned char c : text)
+                state = (state ^ c) * 0x100000001B3ull;
+            outHigh = SplitMix64(state);
+            outLow = SplitMix64(state);
+        }
     }
 
-    const std::string& UUID::Get() const {
-        return m_id;
+    UUID::UUID() {
+        *this = Generate();
     }
 
-    std::string UUID::Generate() {
-        const char* v = "0123456789abcdef";
-        const bool dash[] = { 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0 };
+    UUID::UUID(uint64_t high, uint64_t low)
+        : m_high(high), m_low(low) {
+    }
 
-        std::string res;
-        res.reserve(UUID_SIZE);
+    UUID::UUID(const std::string& id) {
+        // Ids come from files on disk, a bad one must not stop the load nor collide with other bad ones.
+        // Hashing keeps references to the same text (parent_uuid, material_uuid, ...) resolving.
+        if (!Parse(id, m_high, m_low)) {
+            HashText(id, m_high, m_low);
+            Log::Warn("UUID '{0}' is not a valid UUID, using {1} instead", id, Get());
+        }
+    }
 
+    std::string UUID::Get() const {
+        const char* digits = "0123456789abcdef";
+        std::string res(UUID_SIZE, '-');
         for (int i = 0; i < 16; i++) {
-            if (dash[i]) res += '-';
-            res += v[Random::Get(0, 15)];
-            res += v[Random::Get(0, 15)];
+            res[s_digitPositions[i]] = digits[(m_high >> (60 - i * 4)) & 0xF];
+            res[s_digitPositions[16 + i]] = digits[(m_low >> (60 - i * 4)) & 0xF];
         }
         return res;
     }
 
-    bool UUID::operator==(const UUID& other) const {
-        return m_id == other.m_id;
+    UUID UUID::Generate() {
+        // Each thread owns its state, so ids can be generated from workers without locking
+        thread_local uint64_t state = SeedGenerator();
+        uint64_t high = SplitMix64(state);
+        uint64_t low = SplitMix64(state);
+        return UUID(high, low);
+    }
+
+    bool UUID::Parse(const std::string& id, uint64_t& outHigh, uint64_t& outLow) {
+        if (id.size() != UUID_SIZE)
+            return false;
+
+        const unsigned char* text = reinterpret_cast<const unsigned char*>(id.data());
+        uint64_t high = 0;
+        uint64_t low = 0;
+        unsigned char invalid = 0;
+        for (int i = 0; i < 16; i++) {
+            unsigned char highDigit = s_hexTable.Values[text[s_digitPositions[i]]];
+            unsigned char lowDigit = s_hexTable.Values[text[s_digitPositions[16 + i]]];
+            invalid |= highDigit | lowDigit;
+            high = (high << 4) | (highDigit & 0xF);
+            low = (low << 4) | (lowDigit & 0xF);
+        }
+        invalid &= 0x10;
+        invalid |= (text[8] ^ '-') | (text[13] ^ '-') | (text[18] ^ '-') | (text[23] ^ '-');
+
+        if (invalid)
+            return false;
+        outHigh = high;
+        outLow = low;
+        return true;
     }
 
 }
@@ -1,23 +1,36 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Loopie {
+    // 128 bit identifier kept as two integers. The text form is the usual
+    // 8-4-4-4-12 lowercase hex string used by scene, .meta and material files.
     class UUID {
     public:
         UUID();
+        UUID(uint64_t high, uint64_t low);
+        // Text that is not a valid UUID (see Parse) is hashed into one instead, never 0 or an assert
         UUID(const std::string& id);
 
-        const std::string& Get() const;
-        static std::string Generate();
+        std::string Get() const;
+        uint64_t GetHigh() const { return m_high; }
+        uint64_t GetLow() const { return m_low; }
 
-        bool operator==(const UUID& other) const;
+        static UUID Generate();
+        // Returns false and leaves outHigh/outLow untouched when id is not a valid text UUID
+        static bool Parse(const std::string& id, uint64_t& outHigh, uint64_t& outLow);
+
+        bool operator==(const UUID& other) const { return m_high == other.m_high && m_low == other.m_low; }
+        bool operator!=(const UUID& other) const { return !(*this == other); }
+        bool operator<(const UUID& other) const { return m_high < other.m_high || (m_high == other.m_high && m_low < other.m_low); }
 
     public:
-        static const unsigned int UUID_SIZE = 36;
+        static constexpr unsigned int UUID_SIZE = 36; // Length of the text form
 
     private:
-        std::string m_id;
+        uint64_t m_high = 0;
+        uint64_t m_low = 0;
     };
 }
 
@@ -25,7 +38,9 @@ namespace std {
     template <>
     struct hash<Loopie::UUID> {
         std::size_t operator()(const Loopie::UUID& uuid) const noexcept {
-            return std::hash<std::string>()(uuid.Get());
+            // Generated ids are already random, the multiply only spreads hand written ones
+            uint64_t h = uuid.GetHigh() ^ (uuid.GetLow() * 0x9E3779B97F4A7C15ull);
+            return static_cast<std::size_t>(h ^ (h >> 32));
         }
     };
-}
\ No newline at end of file
+}
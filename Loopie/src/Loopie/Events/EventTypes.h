@@ -3,7 +3,12 @@
 namespace Loopie {
     enum class TransformNotification {
         OnDirty,
-        OnChanged
+        OnChanged,
+        OnBoundsChanged // The entity's spatial bounds changed without moving (e.g. new mesh)
+    };
+
+    enum class ResourceNotification {
+        OnLoaded // Sent on the main thread once an async load has been uploaded
     };
 
     enum class EngineNotification {
@@ -0,0 +1,70 @@
+#include "ChunkedLZ4.h"
+
+#include "Loopie/Core/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <lz4.h>
+
+namespace Loopie {
+	bool ChunkedLZ4::Compress(const unsigned char* data, size_t size, size_t chunkSize, std::vector<char>& output, std::vector<uint32_t>& chunkSizes)
+	{
+		uint32_t chunkCount = static_cast<uint32_t>(GetChunkCount(size, chunkSize));
+		if (chunkCount == 0)
+			return true;
+
+		// Every chunk gets its worst case slot, then they are packed together
+		size_t slotSize = static_cast<size_t>(LZ4_compressBound(static_cast<int>(chunkSize)));
+		std::vector<char> slots(slotSize * chunkCount);
+		std::vector<int> compressedSizes(chunkCount);
+
+		JobSystem::ParallelFor(chunkCount, 1, [&](uint32_t chunk) {
+			size_t offset = size_t(chunk) * chunkSize;
+			int chunkBytes = static_cast<int>(std::min(chunkSize, size - offset));
+			compressedSizes[chunk] = LZ4_compress_default(reinterpret_cast<const char*>(data + offset), slots.data() + size_t(chunk) * slotSize,
+														  chunkBytes, static_cast<int>(slotSize));
+		});
+
+		size_t start = output.size();
+		size_t total = 0;
+		for (int compressedSize : compressedSizes) {
+			if (compressedSize <= 0)
+				return false;
+			total += compressedSize;
+		}
+
+		output.resize(start + total);
+		char* write = output.data() + start;
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+			std::memcpy(write, slots.data() + size_t(chunk) * slotSize, compressedSizes[chunk]);
+			write += compressedSizes[chunk];
+			chunkSizes.push_back(static_cast<uint32_t>(compressedSizes[chunk]));
+		}
+		return true;
+	}
+
+	bool ChunkedLZ4::Decompress(const char* compressed, const uint32_t* chunkSizes, unsigned char* output, size_t size, size_t chunkSize)
+	{
+		uint32_t chunkCount = static_cast<uint32_t>(GetChunkCount(size, chunkSize));
+
+		std::vector<size_t> offsets(chunkCount);
+		size_t offset = 0;
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+			offsets[chunk] = offset;
+			offset += chunkSizes[chunk];
+		}
+
+		std::atomic<bool> succeeded{ true };
+		JobSystem::ParallelFor(chunkCount, 1, [&](uint32_t chunk) {
+			size_t outputOffset = size_t(chunk) * chunkSize;
+			int chunkBytes = static_cast<int>(std::min(chunkSize, size - outputOffset));
+			int decompressedSize = LZ4_decompress_safe(compressed + offsets[chunk], reinterpret_cast<char*>(output + outputOffset),
+													   static_cast<int>(chunkSizes[chunk]), chunkBytes);
+			if (decompressedSize != chunkBytes)
+				succeeded.store(false, std::memory_order_relaxed);
+		});
+		return succeeded.load();
+	}
+}
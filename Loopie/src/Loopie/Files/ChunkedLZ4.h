@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Loopie {
+	constexpr size_t LZ4_CHUNK_SIZE = 256 * 1024; // Uncompressed bytes per independent LZ4 block
+
+	// *** Chunked LZ4 ***
+	// Splits a buffer into LZ4 blocks of chunkSize bytes (the last one shorter) compressed on their
+	// own, so both ways run one chunk per job on the JobSystem. Reading them back only needs the
+	// compressed size of each chunk.
+	class ChunkedLZ4
+	{
+	public:
+		static size_t GetChunkCount(size_t size, size_t chunkSize) { return (size + chunkSize - 1) / chunkSize; }
+
+		// Appends the blocks back to back to output and their compressed sizes to chunkSizes
+		static bool Compress(const unsigned char* data, size_t size, size_t chunkSize, std::vector<char>& output, std::vector<uint32_t>& chunkSizes);
+		// compressed holds GetChunkCount(size, chunkSize) blocks as Compress wrote them, output exactly size bytes
+		static bool Decompress(const char* compressed, const uint32_t* chunkSizes, unsigned char* output, size_t size, size_t chunkSize);
+	};
+}
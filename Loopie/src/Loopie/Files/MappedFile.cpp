@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+
+#include "Loopie/Core/PlatformChecker.h"
+
+#if defined(LOOPIE_WINDOWS)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Loopie {
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#if defined(LOOPIE_WINDOWS)
+	bool MappedFile::Open(const std::filesystem::path& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_mapping = mapping;
+		m_data = static_cast<const char*>(view);
+		m_size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		if (m_file)
+			CloseHandle(m_file);
+
+		m_data = nullptr;
+		m_size = 0;
+		m_mapping = nullptr;
+		m_file = nullptr;
+	}
+#else
+	bool MappedFile::Open(const std::filesystem::path& path)
+	{
+		Close();
+
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0) {
+			close(file);
+			return false;
+		}
+
+		// The mapping keeps its own reference to the file
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (view == MAP_FAILED)
+			return false;
+
+		m_data = static_cast<const char*>(view);
+		m_size = static_cast<size_t>(info.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data)
+			munmap(const_cast<char*>(m_data), m_size);
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+
+	// *** MemoryStreamBuffer ***
+	void MemoryStreamBuffer::SetData(const char* data, size_t size)
+	{
+		// The get area is never written through, std::streambuf just wants non const pointers
+		char* begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+
+	MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode)
+	{
+		if (!(mode & std::ios_base::in))
+			return pos_type(off_type(-1));
+
+		off_type base = 0;
+		if (direction == std::ios_base::cur)
+			base = gptr() - eback();
+		else if (direction == std::ios_base::end)
+			base = egptr() - eback();
+
+		off_type position = base + offset;
+		if (position < 0 || position > egptr() - eback())
+			return pos_type(off_type(-1));
+
+		setg(eback(), eback() + position, egptr());
+		return pos_type(position);
+	}
+
+	MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type position, std::ios_base::openmode mode)
+	{
+		return seekoff(off_type(position), std::ios_base::beg, mode);
+	}
+}
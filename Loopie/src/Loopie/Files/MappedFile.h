@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Loopie/Core/PlatformChecker.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <streambuf>
+
+namespace Loopie {
+	// Read only view of a whole file mapped into memory. The data stays valid until Close,
+	// pages are loaded by the OS on first access instead of copied up front.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::filesystem::path& path);
+		void Close();
+
+		bool IsOpen() const { return m_data != nullptr; }
+		const char* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+#if defined(LOOPIE_WINDOWS)
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+
+	// Lets the loaders written against std::istream read straight from memory (e.g. a MappedFile)
+	class MemoryStreamBuffer : public std::streambuf
+	{
+	public:
+		MemoryStreamBuffer() = default;
+		MemoryStreamBuffer(const char* data, size_t size) { SetData(data, size); }
+
+		void SetData(const char* data, size_t size);
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override;
+		pos_type seekpos(pos_type position, std::ios_base::openmode mode) override;
+	};
+}
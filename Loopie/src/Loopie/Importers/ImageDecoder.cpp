@@ -0,0 +1,188 @@
+#include "ImageDecoder.h"
+
+#include "Loopie/Math/SIMD.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include <IL/il.h>
+#include <IL/ilu.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO // Files are read here, so paths don't go through fopen
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_TGA
+#define STBI_ONLY_BMP
+#define STBI_ONLY_PSD
+#define STBI_ONLY_GIF
+#include <stb_image.h>
+
+namespace Loopie {
+	// DevIL works on a single global bound image, so every DevIL call goes through this lock
+	static std::mutex s_devilMutex;
+
+	// stb_image guesses the format from the contents and TGA has no signature, so only these extensions go to it
+	static bool IsStbImageFormat(const std::string& filepath)
+	{
+		std::string extension = std::filesystem::path(filepath).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+			extension == ".bmp" || extension == ".psd" || extension == ".gif";
+	}
+
+	bool ImageDecoder::Decode(const std::string& filepath, std::vector<unsigned char>& rgba, int& width, int& height, int& sourceChannels)
+	{
+		if (!IsStbImageFormat(filepath))
+			return DecodeWithDevIL(filepath, rgba, width, height, sourceChannels);
+
+		std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+		std::vector<unsigned char> encoded(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		file.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+
+		// Native channel count, expanding here is faster than letting stb_image do it pixel by pixel
+		stbi_uc* decoded = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &width, &height, &sourceChannels, 0);
+		if (!decoded) {
+			// Variants stb_image doesn't cover (e.g. 12 bit JPEG) may still load through DevIL
+			return DecodeWithDevIL(filepath, rgba, width, height, sourceChannels);
+		}
+
+		size_t pixelCount = size_t(width) * height;
+		rgba.resize(pixelCount * 4);
+		ExpandToRGBA(decoded, sourceChannels, pixelCount, rgba.data());
+		stbi_image_free(decoded);
+		return true;
+	}
+
+	bool ImageDecoder::DecodeWithDevIL(const std::string& filepath, std::vector<unsigned char>& rgba, int& width, int& height, int& sourceChannels)
+	{
+		std::lock_guard<std::mutex> lock(s_devilMutex);
+
+		ILuint imageID;
+		ilGenImages(1, &imageID);
+		ilBindImage(imageID);
+
+		if (!ilLoadImage(filepath.c_str())) {
+			ilDeleteImages(1, &imageID);
+			return false;
+		}
+		sourceChannels = ilGetInteger(IL_IMAGE_CHANNELS);
+
+		ILint format = ilGetInteger(IL_IMAGE_FORMAT);
+		ILint type = ilGetInteger(IL_IMAGE_TYPE);
+		if ((format != IL_RGBA || type != IL_UNSIGNED_BYTE) && !ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE)) {
+			ilDeleteImages(1, &imageID);
+			return false;
+		}
+
+		// DevIL keeps the file's origin, stb_image always hands rows over top first
+		if (ilGetInteger(IL_IMAGE_ORIGIN) == IL_ORIGIN_LOWER_LEFT)
+			iluFlipImage();
+
+		width = ilGetInteger(IL_IMAGE_WIDTH);
+		height = ilGetInteger(IL_IMAGE_HEIGHT);
+
+		ILubyte* data = ilGetData();
+		if (!data || width <= 0 || height <= 0) {
+			ilDeleteImages(1, &imageID);
+			return false;
+		}
+
+		rgba.assign(data, data + size_t(width) * height * 4);
+		ilDeleteImages(1, &imageID);
+		return true;
+	}
+
+	bool ImageDecoder::CanDecode(const std::string& filepath)
+	{
+		std::lock_guard<std::mutex> lock(s_devilMutex);
+		return ilDetermineType(filepath.c_str()) != IL_TYPE_UNKNOWN;
+	}
+
+	void ImageDecoder::ExpandToRGBA(const unsigned char* src, int channels, size_t pixelCount, unsigned char* dst)
+	{
+		size_t i = 0;
+#if defined(LOOPIE_SIMD_SSE2)
+		const __m128i opaque = _mm_set1_epi8(-1);
+		switch (channels) {
+			case 1:
+				// 16 grey values to 16 RGBA pixels: gg and g255 pairs, interleaved
+				for (; i + 16 <= pixelCount; i += 16) {
+					__m128i grey = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					__m128i greyGreyLow = _mm_unpacklo_epi8(grey, grey);
+					__m128i greyGreyHigh = _mm_unpackhi_epi8(grey, grey);
+					__m128i greyAlphaLow = _mm_unpacklo_epi8(grey, opaque);
+					__m128i greyAlphaHigh = _mm_unpackhi_epi8(grey, opaque);
+					__m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+					_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(greyGreyLow, greyAlphaLow));
+					_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(greyGreyLow, greyAlphaLow));
+					_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(greyGreyHigh, greyAlphaHigh));
+					_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(greyGreyHigh, greyAlphaHigh));
+				}
+				break;
+			case 2:
+				// 8 grey + alpha pairs, the grey byte is copied over the alpha one to get the gg pair
+				for (; i + 8 <= pixelCount; i += 8) {
+					__m128i greyAlpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+					__m128i grey = _mm_and_si128(greyAlpha, _mm_set1_epi16(0x00FF));
+					__m128i greyGrey = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+					__m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+					_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(greyGrey, greyAlpha));
+					_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(greyGrey, greyAlpha));
+				}
+				break;
+			case 3: {
+				// 4 pixels per 16 byte load: each one is shifted to the start of a lane, the byte after
+				// it (the next pixel's red) is overwritten with alpha. Stops 2 pixels early to stay inside src
+				const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+				for (; i + 6 <= pixelCount; i += 4) {
+					__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+					__m128i pixels01 = _mm_unpacklo_epi32(rgb, _mm_srli_si128(rgb, 3));
+					__m128i pixels23 = _mm_unpacklo_epi32(_mm_srli_si128(rgb, 6), _mm_srli_si128(rgb, 9));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_unpacklo_epi64(pixels01, pixels23), alpha));
+				}
+				break;
+			}
+			default:
+				break;
+		}
+#endif
+		ExpandToRGBAScalar(src + i * channels, channels, pixelCount - i, dst + i * 4);
+	}
+
+	void ImageDecoder::ExpandToRGBAScalar(const unsigned char* src, int channels, size_t pixelCount, unsigned char* dst)
+	{
+		switch (channels) {
+			case 1:
+				for (size_t i = 0; i < pixelCount; ++i, dst += 4) {
+					dst[0] = dst[1] = dst[2] = src[i];
+					dst[3] = 255;
+				}
+				break;
+			case 2:
+				for (size_t i = 0; i < pixelCount; ++i, src += 2, dst += 4) {
+					dst[0] = dst[1] = dst[2] = src[0];
+					dst[3] = src[1];
+				}
+				break;
+			case 3:
+				for (size_t i = 0; i < pixelCount; ++i, src += 3, dst += 4) {
+					dst[0] = src[0];
+					dst[1] = src[1];
+					dst[2] = src[2];
+					dst[3] = 255;
+				}
+				break;
+			default:
+				std::memcpy(dst, src, pixelCount * 4);
+				break;
+		}
+	}
+}
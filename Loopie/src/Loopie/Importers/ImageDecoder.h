@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Loopie {
+	// *** Image decoder ***
+	// Source images to RGBA8 with rows top first. PNG, JPEG, TGA, BMP, PSD and GIF go through
+	// stb_image, which keeps no global state and decodes on any number of threads at once. Anything
+	// else falls back to DevIL, serialized behind a lock as it works on a single bound image.
+	class ImageDecoder
+	{
+	public:
+		// sourceChannels is what the file stored (1 to 4), the output always has 4
+		static bool Decode(const std::string& filepath, std::vector<unsigned char>& rgba, int& width, int& height, int& sourceChannels);
+		static bool DecodeWithDevIL(const std::string& filepath, std::vector<unsigned char>& rgba, int& width, int& height, int& sourceChannels);
+		static bool CanDecode(const std::string& filepath);
+
+		// Grey, grey + alpha, RGB or RGBA pixels to RGBA8, SSE2 when available. dst must not overlap src
+		static void ExpandToRGBA(const unsigned char* src, int channels, size_t pixelCount, unsigned char* dst);
+		static void ExpandToRGBAScalar(const unsigned char* src, int channels, size_t pixelCount, unsigned char* dst);
+	};
+}
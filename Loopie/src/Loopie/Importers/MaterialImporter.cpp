@@ -5,6 +5,7 @@
 #include "Loopie/Files/Json.h"
 
 #include "Loopie/Resources/ResourceManager.h"
+#include "Loopie/Resources/AssetPack.h"
 
 #include <fstream>
 #include <iostream>
@@ -23,7 +24,7 @@ namespace Loopie {
 		return out;
 	}
 
-	void MaterialImporter::ImportMaterial(const std::string& filepath, Metadata& metadata) {
+	void MaterialImporter::ImportMaterial(const std::string& filepath, Metadata& metadata, bool saveMetadata) {
 		if (metadata.HasCache && !metadata.IsOutdated)
 			return;
 
@@ -123,7 +124,8 @@ namespace Loopie {
 		metadata.CachesPath.push_back(locationPath.string());
 		metadata.Type = ResourceType::MATERIAL;
 
-		MetadataRegistry::SaveMetadata(filepath, metadata);
+		if (saveMetadata)
+			MetadataRegistry::SaveMetadata(filepath, metadata);
 
 	}
 
@@ -131,12 +133,10 @@ namespace Loopie {
 	
 		Project project = Application::GetInstance().m_activeProject;
 		std::filesystem::path filepath = project.GetChachePath() / path;
-		if (!std::filesystem::exists(filepath))
-			return;
 
-		/// READ
-		std::ifstream file(filepath, std::ios::binary);
-		if (!file) {
+		/// READ (from the mounted asset pack when it has the file)
+		CacheFileStream file(filepath);
+		if (!file.IsOpen()) {
 			Log::Warn("Error opening .material file -> {0}", filepath.string());
 			return;
 		}
@@ -164,7 +164,7 @@ namespace Loopie {
 			UUID textureUUID = UUID(textureId);
 			Metadata* meta = AssetRegistry::GetMetadata(textureUUID);
 			if(meta)
-				material.SetTexture(ResourceManager::GetTexture(*meta));
+				material.SetTexture(ResourceManager::GetTextureAsync(*meta));
 		}
 		
 
@@ -260,7 +260,6 @@ namespace Loopie {
 			material.SetShaderVariable(propertyName, uv);
 		}
 
-		file.close();
 	}
 
 	void MaterialImporter::SaveMaterial(const std::string& filepath, Material& material, Metadata& metadata)
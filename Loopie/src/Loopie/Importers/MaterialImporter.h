@@ -10,7 +10,9 @@
 namespace Loopie {
 	class MaterialImporter {
 	public:
-		static void ImportMaterial(const std::string& filepath, Metadata& metadata);
+		// Safe to call from several threads at once for different assets. saveMetadata = false leaves
+		// writing the .meta file to the caller
+		static void ImportMaterial(const std::string& filepath, Metadata& metadata, bool saveMetadata = true);
 		static void LoadMaterial(const std::string& path, Material& material);
 		static void SaveMaterial(const std::string& filepath, Material& material, Metadata& metadata);
 		static bool CheckIfIsMaterial(const char* path);
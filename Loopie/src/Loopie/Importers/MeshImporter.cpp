@@ -3,18 +3,109 @@
 #include "Loopie/Core/Log.h"
 #include "Loopie/Core/Application.h"
 #include "Loopie/Resources/Types/Mesh.h"
+#include "Loopie/Resources/AssetPack.h"
+#include "Loopie/Importers/MeshOptimizer.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <filesystem> // Used for checking the extension
 
 
 namespace Loopie {
-	void MeshImporter::ImportModel(const std::string& filepath, Metadata& metadata) {
+	// *** .mesh cache layout ***
+	// MeshFileHeader | name, zero padded to MESH_FILE_ALIGNMENT | interleaved vertices | indices | BVH block
+	// Vertices are floats, or the packed GPU layout when CompactAttributes is set (version 2).
+	// Indices are uint32, or uint16 when ShortIndices is set (version 3).
+	// The header size is a multiple of the alignment too, so the vertex block always starts aligned.
+	// Caches without the magic come from before the header existed and are still read.
+	constexpr uint32_t MESH_FILE_MAGIC = 0x48534D4C; // "LMSH"
+	constexpr uint32_t MESH_FILE_VERSION = 3;
+	constexpr uint32_t MESH_FILE_ALIGNMENT = 16;
+	constexpr uint32_t MESH_SHORT_INDICES_MAX_VERTICES = 65536; // Every index fits in uint16
+
+	struct MeshFileHeader {
+		uint32_t Magic = MESH_FILE_MAGIC;
+		uint32_t Version = MESH_FILE_VERSION;
+		uint32_t VerticesAmount = 0;
+		uint32_t VertexElements = 0;
+		uint32_t IndicesAmount = 0;
+		uint32_t NameLength = 0;
+
+		uint8_t HasPosition = 0;
+		uint8_t HasNormal = 0;
+		uint8_t HasTexCoord = 0;
+		uint8_t HasTangent = 0;
+		uint8_t HasColor = 0;
+		uint8_t CompactAttributes = 0; // Version 2, zero in version 1 caches
+		uint8_t QuantizedPositions = 0;
+		uint8_t ShortIndices = 0; // Version 3, zero before
+
+		vec3 BoundsMin = vec3(0);
+		vec3 BoundsMax = vec3(0);
+		vec3 Position = vec3(0);
+		quaternion Rotation = quaternion(1, 0, 0, 0);
+		vec3 Scale = vec3(0);
+	};
+	static_assert(sizeof(MeshFileHeader) % MESH_FILE_ALIGNMENT == 0, "MeshFileHeader must keep the vertex block aligned");
+
+	static uint32_t MeshFileNamePadding(uint32_t nameLength) {
+		return (MESH_FILE_ALIGNMENT - nameLength % MESH_FILE_ALIGNMENT) % MESH_FILE_ALIGNMENT;
+	}
+
+	// Quantized positions map the bounding box into [-1, 1] with the same scale on every axis,
+	// so the decode transform does not skew the normals
+	static void GetPositionQuantization(const AABB& bounds, vec3& center, float& extent) {
+		center = (bounds.MinPoint + bounds.MaxPoint) * 0.5f;
+		vec3 halfSize = (bounds.MaxPoint - bounds.MinPoint) * 0.5f;
+		extent = std::max(halfSize.x, std::max(halfSize.y, halfSize.z));
+		if (extent <= 0.0f)
+			extent = 1.0f;
+	}
+
+	static uint8_t* WritePacked(uint8_t* vertex, uint32_t value) {
+		std::memcpy(vertex, &value, sizeof(value));
+		return vertex + sizeof(value);
+	}
+
+	// Positions for the CPU side queries (BVH, raycasts, gizmos), as the GPU ends up seeing them
+	static void UnpackPositions(MeshData& data, unsigned int stride) {
+		vec3 center;
+		float extent;
+		GetPositionQuantization(data.BoundingBox, center, extent);
+
+		data.Vertices.resize(size_t(data.VerticesAmount) * 3);
+		for (unsigned int i = 0; i < data.VerticesAmount; ++i) {
+			const uint8_t* vertex = data.PackedVertices.data() + size_t(i) * stride;
+			float* position = &data.Vertices[size_t(i) * 3];
+			if (data.QuantizedPositions) {
+				int16_t quantized[3];
+				std::memcpy(quantized, vertex, sizeof(quantized));
+				for (int c = 0; c < 3; ++c)
+					position[c] = center[c] + extent * std::max(quantized[c] / 32767.0f, -1.0f);
+			}
+			else {
+				std::memcpy(position, vertex, 3 * sizeof(float));
+			}
+		}
+	}
+
+	MeshImportSettings MeshImporter::s_settings;
+
+	void MeshImporter::ImportModel(const std::string& filepath, Metadata& metadata, bool saveMetadata) {
+		MeshImportSettings settings = s_settings;
+		ImportModel(filepath, metadata, settings, saveMetadata);
+	}
+
+	void MeshImporter::ImportModel(const std::string& filepath, Metadata& metadata, const MeshImportSettings& settings, bool saveMetadata) {
 		if (metadata.HasCache && !metadata.IsOutdated)
 			return;
 
@@ -30,9 +121,10 @@ namespace Loopie {
 		metadata.CachesPath.clear();
 		metadata.HasCache = true;
 		metadata.Type = ResourceType::MESH;
-		ProcessNode(scene->mRootNode, scene, metadata.CachesPath);
+		ProcessNode(scene->mRootNode, scene, settings, metadata.CachesPath);
 
-		MetadataRegistry::SaveMetadata(filepath, metadata);
+		if (saveMetadata)
+			MetadataRegistry::SaveMetadata(filepath, metadata);
 
 		Log::Trace("Mesh Imported -> {0}", filepath);
 	}
@@ -40,16 +132,18 @@ namespace Loopie {
 	void MeshImporter::LoadModel(const std::string& path ,Mesh& mesh)
 	{
 		Project project = Application::GetInstance().m_activeProject;
-		std::filesystem::path filepath = project.GetChachePath() / path;
-		if (!std::filesystem::exists(filepath))
-			return;
-
+		MeshData data;
+		if (ReadModel(project.GetChachePath() / path, data))
+			UploadModel(std::move(data), mesh);
+	}
 
-		/// READ
-		std::ifstream file(filepath, std::ios::binary);
-		if (!file) {
+	bool MeshImporter::ReadModel(const std::filesystem::path& filepath, MeshData& data)
+	{
+		/// READ (from the mounted asset pack when it has the file)
+		CacheFileStream file(filepath);
+		if (!file.IsOpen()) {
 			Log::Warn("Error opening .mesh file -> {0}", filepath.string());
-			return;
+			return false;
 		}
 
 		file.seekg(0, std::ios::end);
@@ -58,11 +152,95 @@ namespace Loopie {
 
 		if (size <= 0) {
 			Log::Warn("Error reading .mesh file -> {0}", filepath.string());
-			return;
+			return false;
 		}
 
-		MeshData data;
+		uint32_t magic = 0;
+		file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		file.seekg(0, std::ios::beg);
+
+		bool headerRead = magic == MESH_FILE_MAGIC ? ReadHeader(file, data) : ReadLegacyHeader(file, data);
+		if (!headerRead) {
+			Log::Warn("Error reading .mesh file header -> {0}", filepath.string());
+			return false;
+		}
+
+		// Both blocks are stored exactly as they are kept in memory, one read each
+		unsigned int packedStride = data.CompactAttributes ? GetPackedVertexStride(data) : 0;
+		uint64_t vertexBytes = data.CompactAttributes ? uint64_t(data.VerticesAmount) * packedStride
+													  : uint64_t(data.VerticesAmount) * data.VertexElements * sizeof(float);
+		uint64_t indexBytes = uint64_t(data.IndicesAmount) * (data.ShortIndices ? sizeof(uint16_t) : sizeof(unsigned int));
+		if (uint64_t(file.tellg()) + vertexBytes + indexBytes > uint64_t(size)) {
+			Log::Warn("Truncated .mesh file -> {0}", filepath.string());
+			return false;
+		}
 
+		if (data.CompactAttributes) {
+			data.PackedVertices.resize(vertexBytes);
+			file.read(reinterpret_cast<char*>(data.PackedVertices.data()), vertexBytes);
+		}
+		else {
+			data.Vertices.resize(size_t(data.VerticesAmount) * data.VertexElements);
+			file.read(reinterpret_cast<char*>(data.Vertices.data()), vertexBytes);
+		}
+		data.Indices.resize(data.IndicesAmount);
+		if (data.ShortIndices) {
+			// The CPU side queries work on uint32, widened here and narrowed again by UploadModel
+			std::vector<uint16_t> indices(data.IndicesAmount);
+			file.read(reinterpret_cast<char*>(indices.data()), indexBytes);
+			std::copy(indices.begin(), indices.end(), data.Indices.begin());
+		}
+		else {
+			file.read(reinterpret_cast<char*>(data.Indices.data()), indexBytes);
+		}
+
+		if (data.CompactAttributes && data.HasPosition)
+			UnpackPositions(data, packedStride);
+
+		// Caches written before the BVH block existed end here, build it instead
+		if (!data.TriangleBVH.Read(file, data.IndicesAmount / 3) && data.HasPosition) {
+			data.TriangleBVH.Build(data.Vertices.data(), data.VertexElements, 0, data.Indices.data(), data.IndicesAmount);
+			Log::Trace("Mesh BVH built -> {0} ({1} nodes)", filepath.string(), data.TriangleBVH.GetNodeCount());
+		}
+		///
+
+		Log::Trace("Mesh Loaded -> {0}", filepath.string());
+		return true;
+	}
+
+	bool MeshImporter::ReadHeader(std::istream& file, MeshData& data)
+	{
+		MeshFileHeader header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Version == 0 || header.Version > MESH_FILE_VERSION)
+			return false;
+
+		data.Name.resize(header.NameLength);
+		file.read(data.Name.data(), header.NameLength);
+		file.seekg(MeshFileNamePadding(header.NameLength), std::ios::cur);
+
+		data.BoundingBox.MinPoint = header.BoundsMin;
+		data.BoundingBox.MaxPoint = header.BoundsMax;
+		data.Position = header.Position;
+		data.Rotation = header.Rotation;
+		data.Scale = header.Scale;
+
+		data.VerticesAmount = header.VerticesAmount;
+		data.VertexElements = header.VertexElements;
+		data.IndicesAmount = header.IndicesAmount;
+
+		data.HasPosition = header.HasPosition != 0;
+		data.HasNormal = header.HasNormal != 0;
+		data.HasTexCoord = header.HasTexCoord != 0;
+		data.HasTangent = header.HasTangent != 0;
+		data.HasColor = header.HasColor != 0;
+		data.CompactAttributes = header.CompactAttributes != 0;
+		data.QuantizedPositions = header.QuantizedPositions != 0;
+		data.ShortIndices = header.ShortIndices != 0 && header.VerticesAmount <= MESH_SHORT_INDICES_MAX_VERTICES;
+		return bool(file);
+	}
+
+	bool MeshImporter::ReadLegacyHeader(std::istream& file, MeshData& data)
+	{
 		unsigned int nameLength = 0;
 		file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
 		data.Name.resize(nameLength);
@@ -84,42 +262,65 @@ namespace Loopie {
 		file.read(reinterpret_cast<char*>(&data.HasTexCoord), sizeof data.HasTexCoord);
 		file.read(reinterpret_cast<char*>(&data.HasTangent), sizeof data.HasTangent);
 		file.read(reinterpret_cast<char*>(&data.HasColor), sizeof data.HasColor);
+		return bool(file);
+	}
 
-		data.Vertices.clear();
-		data.Vertices = std::vector<float>(data.VerticesAmount * data.VertexElements);
-
-		for (unsigned int i = 0; i < data.VerticesAmount * data.VertexElements; ++i) {
-			file.read(reinterpret_cast<char*>(&data.Vertices[i]), sizeof data.Vertices[i]);
+	void MeshImporter::UploadModel(MeshData&& data, Mesh& mesh)
+	{
+		if (data.CompactAttributes)
+			mesh.m_vbo = std::make_shared<VertexBuffer>(data.PackedVertices.data(), (unsigned int)data.PackedVertices.size());
+		else
+			mesh.m_vbo = std::make_shared<VertexBuffer>(data.Vertices.data(), (unsigned int)(sizeof(float) * data.VerticesAmount * data.VertexElements));
+		if (data.ShortIndices) {
+			std::vector<uint16_t> indices(data.Indices.begin(), data.Indices.end());
+			mesh.m_ebo = std::make_shared<IndexBuffer>(indices.data(), data.IndicesAmount);
 		}
-		data.Indices.clear();
-		data.Indices = std::vector<unsigned int>(data.IndicesAmount);
-		for (unsigned int i = 0; i < data.IndicesAmount; ++i) {
-			file.read(reinterpret_cast<char*>(&data.Indices[i]), sizeof data.Indices[i]);
+		else {
+			mesh.m_ebo = std::make_shared<IndexBuffer>(data.Indices.data(), data.IndicesAmount);
 		}
-		file.close();
-		///
-
-		mesh.m_vbo = std::make_shared<VertexBuffer>(data.Vertices.data(), (unsigned int)(sizeof(float) * data.VerticesAmount * data.VertexElements));
-		mesh.m_ebo = std::make_shared<IndexBuffer>(data.Indices.data(), data.IndicesAmount);
 		mesh.m_vao = std::make_shared<VertexArray>();
 
 		BufferLayout& layout = mesh.m_vbo->GetLayout();
 
-		if (data.HasPosition)
-			layout.AddLayoutElement(0, GLVariableType::FLOAT, 3, "a_Position");
-		if (data.HasTexCoord)
-			layout.AddLayoutElement(1, GLVariableType::FLOAT, 2, "a_TexCoord");
-		if (data.HasNormal)
-			layout.AddLayoutElement(2, GLVariableType::FLOAT, 3, "a_Normal");
-		if (data.HasTangent)
-			layout.AddLayoutElement(3, GLVariableType::FLOAT, 3, "a_Tangent");
-		if (data.HasColor)
-			layout.AddLayoutElement(4, GLVariableType::FLOAT, 4, "a_Color");
-
-		mesh.m_data = data;
-		mesh.m_vao->AddBuffer(mesh.m_vbo.get(), mesh.m_ebo.get());
+		if (data.CompactAttributes) {
+			if (data.HasPosition && data.QuantizedPositions) {
+				layout.AddLayoutElement(0, GLVariableType::SHORT, 4, "a_Position", true); // w is padding
 
-		Log::Trace("Mesh Loaded -> {0}", filepath.string());
+				vec3 center;
+				float extent;
+				GetPositionQuantization(data.BoundingBox, center, extent);
+				mesh.m_vao->SetPositionDecode(glm::scale(glm::translate(matrix4(1.0f), center), vec3(extent)));
+			}
+			else if (data.HasPosition) {
+				layout.AddLayoutElement(0, GLVariableType::FLOAT, 3, "a_Position");
+			}
+			if (data.HasTexCoord)
+				layout.AddLayoutElement(1, GLVariableType::HALF_FLOAT, 2, "a_TexCoord");
+			if (data.HasNormal)
+				layout.AddLayoutElement(2, GLVariableType::INT_2_10_10_10_REV, 4, "a_Normal", true);
+			if (data.HasTangent)
+				layout.AddLayoutElement(3, GLVariableType::INT_2_10_10_10_REV, 4, "a_Tangent", true);
+			if (data.HasColor)
+				layout.AddLayoutElement(4, GLVariableType::UNSIGNED_BYTE, 4, "a_Color", true);
+
+			// Already on the GPU, the CPU side only needs the positions kept in Vertices
+			data.PackedVertices = std::vector<uint8_t>();
+		}
+		else {
+			if (data.HasPosition)
+				layout.AddLayoutElement(0, GLVariableType::FLOAT, 3, "a_Position");
+			if (data.HasTexCoord)
+				layout.AddLayoutElement(1, GLVariableType::FLOAT, 2, "a_TexCoord");
+			if (data.HasNormal)
+				layout.AddLayoutElement(2, GLVariableType::FLOAT, 3, "a_Normal");
+			if (data.HasTangent)
+				layout.AddLayoutElement(3, GLVariableType::FLOAT, 3, "a_Tangent");
+			if (data.HasColor)
+				layout.AddLayoutElement(4, GLVariableType::FLOAT, 4, "a_Color");
+		}
+
+		mesh.m_data = std::move(data);
+		mesh.m_vao->AddBuffer(mesh.m_vbo.get(), mesh.m_ebo.get());
 	}
 
 	bool MeshImporter::CheckIfIsModel(const char* path)
@@ -138,21 +339,21 @@ namespace Loopie {
 		return importer.IsExtensionSupported(extension);
 	}
 
-	void MeshImporter::ProcessNode(void* nodePtr, const void* scenePtr, std::vector<std::string>& outputPaths) {
+	void MeshImporter::ProcessNode(void* nodePtr, const void* scenePtr, const MeshImportSettings& settings, std::vector<std::string>& outputPaths) {
 		auto node = static_cast<const aiNode*>(nodePtr);
 		auto scene = static_cast<const aiScene*>(scenePtr);
 
 		for (unsigned int i = 0; i < node->mNumMeshes; i++) {
 			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			outputPaths.push_back(ProcessMesh(nodePtr, mesh, scene));
+			outputPaths.push_back(ProcessMesh(nodePtr, mesh, scene, settings));
 		}
 
 		for (unsigned int i = 0; i < node->mNumChildren; i++) {
-			ProcessNode(node->mChildren[i], scene, outputPaths);
+			ProcessNode(node->mChildren[i], scene, settings, outputPaths);
 		}
 	}
 
-	std::string MeshImporter::ProcessMesh(void* nodePtr, void* meshPtr, const void* scenePtr) {
+	std::string MeshImporter::ProcessMesh(void* nodePtr, void* meshPtr, const void* scenePtr, const MeshImportSettings& settings) {
 		auto node = static_cast<const aiNode*>(nodePtr);
 		auto mesh = static_cast<const aiMesh*>(meshPtr);
 		MeshData data;
@@ -185,11 +386,17 @@ namespace Loopie {
 		data.HasTangent = mesh->HasTangentsAndBitangents();
 		data.HasColor = mesh->HasVertexColors(0);
 
+		data.CompactAttributes = settings.CompactVertices || settings.QuantizePositions;
+		data.QuantizedPositions = settings.QuantizePositions;
+
+		// Vertices only keeps the positions of compact meshes
 		data.VertexElements = data.HasPosition ? 3 : 0;
-		data.VertexElements += data.HasTexCoord ? 2 : 0;
-		data.VertexElements += data.HasNormal ? 3 : 0;
-		data.VertexElements += data.HasTangent ? 3 : 0;
-		data.VertexElements += data.HasColor ? 4 : 0;
+		if (!data.CompactAttributes) {
+			data.VertexElements += data.HasTexCoord ? 2 : 0;
+			data.VertexElements += data.HasNormal ? 3 : 0;
+			data.VertexElements += data.HasTangent ? 3 : 0;
+			data.VertexElements += data.HasColor ? 4 : 0;
+		}
 
 
 		///// File Creation
@@ -200,86 +407,192 @@ namespace Loopie {
 
 		std::filesystem::path pathToWrite = project.GetChachePath() / locationPath;
 
-		std::ofstream fs(pathToWrite, std::ios::binary | std::ios::trunc);
-
-		
-		fs.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
-		fs.write(data.Name.data(), nameLength);
-
-		fs.write(reinterpret_cast<const char*>(&data.BoundingBox.MinPoint), sizeof(data.BoundingBox.MinPoint));
-		fs.write(reinterpret_cast<const char*>(&data.BoundingBox.MaxPoint), sizeof(data.BoundingBox.MaxPoint));
-
-		fs.write(reinterpret_cast<const char*>(&data.Position), sizeof(data.Position));
-		fs.write(reinterpret_cast<const char*>(&data.Rotation), sizeof(data.Rotation));
-		fs.write(reinterpret_cast<const char*>(&data.Scale), sizeof(data.Scale));
-
-		fs.write(reinterpret_cast<const char*>(&data.VerticesAmount), sizeof data.VerticesAmount);
-		fs.write(reinterpret_cast<const char*>(&data.VertexElements), sizeof data.VertexElements);
+		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+			const aiFace& face = mesh->mFaces[i];
+			data.IndicesAmount += face.mNumIndices;
+		}
 
+		// Interleaved in memory first, so each block goes out with a single write
+		if (data.CompactAttributes) {
+			PackVertices(mesh, data);
+		}
+		else {
+			data.Vertices.reserve(size_t(data.VerticesAmount) * data.VertexElements);
+			for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+				///Position
+				data.Vertices.insert(data.Vertices.end(), { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z });
+
+				///TexCoords
+				if (data.HasTexCoord)
+					data.Vertices.insert(data.Vertices.end(), { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y });
+
+				///Normals
+				if (data.HasNormal)
+					data.Vertices.insert(data.Vertices.end(), { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z });
+
+				///Tangent
+				if (data.HasTangent)
+					data.Vertices.insert(data.Vertices.end(), { mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z });
+
+				///Color
+				if (data.HasColor) {
+					const aiColor4D& c = mesh->mColors[0][i];
+					data.Vertices.insert(data.Vertices.end(), { c.r, c.g, c.b, c.a });
+				}
+			}
+		}
 
+		data.Indices.reserve(data.IndicesAmount);
 		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
 			const aiFace& face = mesh->mFaces[i];
-			data.IndicesAmount += face.mNumIndices;
+			data.Indices.insert(data.Indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
 		}
 
-		fs.write(reinterpret_cast<const char*>(&data.IndicesAmount), sizeof data.IndicesAmount);
+		OptimizeMesh(data);
+		data.ShortIndices = data.VerticesAmount <= MESH_SHORT_INDICES_MAX_VERTICES;
+
+		MeshFileHeader header;
+		header.VerticesAmount = data.VerticesAmount;
+		header.VertexElements = data.VertexElements;
+		header.IndicesAmount = data.IndicesAmount;
+		header.NameLength = nameLength;
+		header.HasPosition = data.HasPosition;
+		header.HasNormal = data.HasNormal;
+		header.HasTexCoord = data.HasTexCoord;
+		header.HasTangent = data.HasTangent;
+		header.HasColor = data.HasColor;
+		header.CompactAttributes = data.CompactAttributes;
+		header.QuantizedPositions = data.QuantizedPositions;
+		header.ShortIndices = data.ShortIndices;
+		header.BoundsMin = data.BoundingBox.MinPoint;
+		header.BoundsMax = data.BoundingBox.MaxPoint;
+		header.Position = data.Position;
+		header.Rotation = data.Rotation;
+		header.Scale = data.Scale;
+
+		const char padding[MESH_FILE_ALIGNMENT] = {};
+		std::ofstream fs(pathToWrite, std::ios::binary | std::ios::trunc);
+		fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		fs.write(data.Name.data(), nameLength);
+		fs.write(padding, MeshFileNamePadding(nameLength));
+		if (data.CompactAttributes)
+			fs.write(reinterpret_cast<const char*>(data.PackedVertices.data()), data.PackedVertices.size());
+		else
+			fs.write(reinterpret_cast<const char*>(data.Vertices.data()), data.Vertices.size() * sizeof(float));
+		if (data.ShortIndices) {
+			std::vector<uint16_t> indices(data.Indices.begin(), data.Indices.end());
+			fs.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint16_t));
+		}
+		else {
+			fs.write(reinterpret_cast<const char*>(data.Indices.data()), data.Indices.size() * sizeof(unsigned int));
+		}
 
-		fs.write(reinterpret_cast<const char*>(&data.HasPosition), sizeof data.HasPosition);
-		fs.write(reinterpret_cast<const char*>(&data.HasNormal), sizeof data.HasNormal);
-		fs.write(reinterpret_cast<const char*>(&data.HasTexCoord), sizeof data.HasTexCoord);
-		fs.write(reinterpret_cast<const char*>(&data.HasTangent), sizeof data.HasTangent);
-		fs.write(reinterpret_cast<const char*>(&data.HasColor), sizeof data.HasColor);
+		///BVH (stores triangle ids only, built over the positions the CPU keeps so quantized meshes pick what is drawn)
+		if (data.HasPosition) {
+			data.TriangleBVH.Build(data.Vertices.data(), data.VertexElements, 0, data.Indices.data(), data.IndicesAmount);
+		}
+		data.TriangleBVH.Write(fs);
+		fs.close();
 
 
+		return locationPath.string();
+	}
+
+	void MeshImporter::PackVertices(const void* meshPtr, MeshData& data)
+	{
+		auto mesh = static_cast<const aiMesh*>(meshPtr);
+		unsigned int stride = GetPackedVertexStride(data);
+		data.PackedVertices.assign(size_t(data.VerticesAmount) * stride, 0);
+		data.Vertices.reserve(size_t(data.VerticesAmount) * data.VertexElements);
+
+		vec3 center;
+		float extent;
+		GetPositionQuantization(data.BoundingBox, center, extent);
+
 		for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+			uint8_t* vertex = data.PackedVertices.data() + size_t(i) * stride;
+
 			///Position
-			fs.write(reinterpret_cast<const char*>(&mesh->mVertices[i].x), sizeof mesh->mVertices[i].x);
-			fs.write(reinterpret_cast<const char*>(&mesh->mVertices[i].y), sizeof mesh->mVertices[i].y);
-			fs.write(reinterpret_cast<const char*>(&mesh->mVertices[i].z), sizeof mesh->mVertices[i].z);
+			vec3 position(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+			if (data.QuantizedPositions) {
+				int16_t quantized[4] = {};
+				for (int c = 0; c < 3; ++c) {
+					quantized[c] = int16_t(std::round(glm::clamp((position[c] - center[c]) / extent, -1.0f, 1.0f) * 32767.0f));
+					position[c] = center[c] + extent * (quantized[c] / 32767.0f);
+				}
+				std::memcpy(vertex, quantized, sizeof(quantized));
+				vertex += sizeof(quantized);
+			}
+			else {
+				std::memcpy(vertex, &position.x, 3 * sizeof(float));
+				vertex += 3 * sizeof(float);
+			}
+			data.Vertices.insert(data.Vertices.end(), { position.x, position.y, position.z });
 
 			///TexCoords
-			if (data.HasTexCoord) {
-				fs.write(reinterpret_cast<const char*>(&mesh->mTextureCoords[0][i].x), sizeof mesh->mTextureCoords[0][i].x);
-				fs.write(reinterpret_cast<const char*>(&mesh->mTextureCoords[0][i].y), sizeof mesh->mTextureCoords[0][i].y);
-			}
+			if (data.HasTexCoord)
+				vertex = WritePacked(vertex, glm::packHalf2x16(vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y)));
 
 			///Normals
-			if (data.HasNormal) {
-
-				fs.write(reinterpret_cast<const char*>(&mesh->mNormals[i].x), sizeof mesh->mNormals[i].x);
-				fs.write(reinterpret_cast<const char*>(&mesh->mNormals[i].y), sizeof mesh->mNormals[i].y);
-				fs.write(reinterpret_cast<const char*>(&mesh->mNormals[i].z), sizeof mesh->mNormals[i].z);
-			}
+			if (data.HasNormal)
+				vertex = WritePacked(vertex, glm::packSnorm3x10_1x2(vec4(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z, 0.0f)));
 
 			///Tangent
-			if (data.HasTangent) {
-
-				fs.write(reinterpret_cast<const char*>(&mesh->mTangents[i].x), sizeof mesh->mTangents[i].x);
-				fs.write(reinterpret_cast<const char*>(&mesh->mTangents[i].y), sizeof mesh->mTangents[i].y);
-				fs.write(reinterpret_cast<const char*>(&mesh->mTangents[i].z), sizeof mesh->mTangents[i].z);
-			}
+			if (data.HasTangent)
+				vertex = WritePacked(vertex, glm::packSnorm3x10_1x2(vec4(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z, 0.0f)));
 
 			///Color
 			if (data.HasColor) {
 				const aiColor4D& c = mesh->mColors[0][i];
-
-				fs.write(reinterpret_cast<const char*>(&c.r), sizeof c.r);
-				fs.write(reinterpret_cast<const char*>(&c.g), sizeof c.g);
-				fs.write(reinterpret_cast<const char*>(&c.b), sizeof c.b);
-				fs.write(reinterpret_cast<const char*>(&c.a), sizeof c.a);
+				vertex = WritePacked(vertex, glm::packUnorm4x8(vec4(c.r, c.g, c.b, c.a)));
 			}
-
 		}
+	}
 
-		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
-			const aiFace& face = mesh->mFaces[i];
-			for (unsigned int j = 0; j < face.mNumIndices; ++j) {
-				fs.write(reinterpret_cast<const char*>(&face.mIndices[j]), sizeof face.mIndices[j]);
-			}
-		}
-		fs.close();
+	unsigned int MeshImporter::GetPackedVertexStride(const MeshData& data)
+	{
+		unsigned int stride = 0;
+		if (data.HasPosition)
+			stride += data.QuantizedPositions ? 4 * sizeof(int16_t) : 3 * sizeof(float);
+		stride += data.HasTexCoord ? sizeof(uint32_t) : 0; // 2 x half
+		stride += data.HasNormal ? sizeof(uint32_t) : 0; // 10:10:10:2
+		stride += data.HasTangent ? sizeof(uint32_t) : 0;
+		stride += data.HasColor ? sizeof(uint32_t) : 0; // RGBA8
+		return stride;
+	}
 
+	void MeshImporter::OptimizeMesh(MeshData& data)
+	{
+		// Meshes with point or line faces are left as they are, the passes work on triangle lists
+		if (data.IndicesAmount < 3 || data.IndicesAmount % 3 != 0 || !data.HasPosition)
+			return;
 
-		return locationPath.string();
+		float acmrBefore = MeshOptimizer::ComputeACMR(data.Indices.data(), data.Indices.size(), data.VerticesAmount);
+		unsigned int verticesBefore = data.VerticesAmount;
+		unsigned int packedStride = data.CompactAttributes ? GetPackedVertexStride(data) : 0;
+		std::vector<unsigned int> remap;
+
+		auto applyRemap = [&](unsigned int vertexCount) {
+			MeshOptimizer::RemapIndices(data.Indices, remap);
+			MeshOptimizer::RemapVertices(data.Vertices, data.VertexElements, remap, vertexCount);
+			if (data.CompactAttributes)
+				MeshOptimizer::RemapVertices(data.PackedVertices, packedStride, remap, vertexCount);
+			data.VerticesAmount = vertexCount;
+		};
+
+		// Identical vertices as the GPU sees them, so packing can make more of them match
+		if (data.CompactAttributes)
+			applyRemap(MeshOptimizer::GenerateVertexRemap(remap, data.Indices.data(), data.Indices.size(), data.PackedVertices.data(), data.VerticesAmount, packedStride));
+		else
+			applyRemap(MeshOptimizer::GenerateVertexRemap(remap, data.Indices.data(), data.Indices.size(), data.Vertices.data(), data.VerticesAmount, data.VertexElements * sizeof(float)));
+
+		MeshOptimizer::OptimizeVertexCache(data.Indices, data.VerticesAmount);
+		MeshOptimizer::OptimizeOverdraw(data.Indices, data.Vertices.data(), data.VertexElements, data.VerticesAmount);
+
+		// Vertices in the order the triangles use them, so the fetches walk memory forwards
+		applyRemap(MeshOptimizer::GenerateVertexFetchRemap(remap, data.Indices.data(), data.Indices.size(), data.VerticesAmount));
+
+		float acmrAfter = MeshOptimizer::ComputeACMR(data.Indices.data(), data.Indices.size(), data.VerticesAmount);
+		Log::Trace("Mesh Optimized -> {0}: {1} -> {2} vertices, ACMR {3:.3f} -> {4:.3f}", data.Name, verticesBefore, data.VerticesAmount, acmrBefore, acmrAfter);
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Loopie/Resources/MetadataRegistry.h"
 #include "Loopie/Importers/ImportSettings.h"
 
+#include <iosfwd>
 #include <memory>
 #include <vector>
 #include <string>
@@ -10,19 +11,42 @@
 
 namespace Loopie {
 
-	struct MeshImportSettigns : public ImportSettings {
-
-
+	struct MeshImportSettings : public ImportSettings {
+		bool CompactVertices = true; // See MeshData::CompactAttributes
+		bool QuantizePositions = false; // Lossy, implies CompactVertices
 	};
 
 	class MeshImporter {
 	public:
-		static void ImportModel(const std::string& filepath, Metadata& metadata);
+		// Imports with a copy of the current settings, call it from the main thread
+		static void ImportModel(const std::string& filepath, Metadata& metadata, bool saveMetadata = true);
+		// Safe to call from several threads at once for different assets, as long as every job owns its
+		// settings copy (taken before dispatch, the menu may change them meanwhile). saveMetadata = false
+		// leaves writing the .meta file to the caller
+		static void ImportModel(const std::string& filepath, Metadata& metadata, const MeshImportSettings& settings, bool saveMetadata = true);
 		static void LoadModel(const std::string& path, Mesh& mesh);
+		// LoadModel in two steps. ReadModel reads a .mesh cache (and builds the BVH of old caches)
+		// without touching GL so it can run on any thread, UploadModel creates the buffers on the main thread.
+		static bool ReadModel(const std::filesystem::path& filepath, MeshData& data);
+		static void UploadModel(MeshData&& data, Mesh& mesh);
 		static bool CheckIfIsModel(const char* path);
 
+		// Used by every import from then on, existing caches keep their format until reimported
+		static void SetImportSettings(const MeshImportSettings& settings) { s_settings = settings; }
+		static const MeshImportSettings& GetImportSettings() { return s_settings; }
+
+	private:
+		// Fill everything in data but the vertex, index and BVH blocks, leaving file right before them
+		static bool ReadHeader(std::istream& file, MeshData& data);
+		static bool ReadLegacyHeader(std::istream& file, MeshData& data); // Caches written before MeshFileHeader
+		static void ProcessNode(void* node, const void* scene, const MeshImportSettings& settings, std::vector<std::string>& outputPaths);
+		static std::string ProcessMesh(void* nodePtr, void* mesh, const void* scene, const MeshImportSettings& settings);
+		static void PackVertices(const void* mesh, MeshData& data);
+		// Deduplicates the vertices and reorders triangles and vertices for the GPU caches, logs the ACMR
+		static void OptimizeMesh(MeshData& data);
+		static unsigned int GetPackedVertexStride(const MeshData& data);
+
 	private:
-		static void ProcessNode(void* node, const void* scene, std::vector<std::string>& outputPaths);
-		static std::string ProcessMesh(void* nodePtr, void* mesh, const void* scene);
+		static MeshImportSettings s_settings;
 	};
 }
\ No newline at end of file
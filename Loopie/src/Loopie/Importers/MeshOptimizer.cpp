@@ -0,0 +1,316 @@
+#include "MeshOptimizer.h"
+
+#include "Loopie/Math/MathTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Loopie {
+	namespace {
+		// Forsyth's scoring, tuned for the 32 entry LRU cache
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		float GetVertexScore(int cachePosition, unsigned int remainingTriangles)
+		{
+			// No triangle left to draw, the vertex is of no use in the cache anymore
+			if (remainingTriangles == 0)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0) {
+				// The last triangle's vertices get a fixed score so its neighbours do not win just by being close
+				if (cachePosition < 3)
+					score = LAST_TRIANGLE_SCORE;
+				else
+					score = std::pow(1.0f - float(cachePosition - 3) / float(MESH_OPTIMIZER_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+			}
+
+			// Vertices with few triangles left are finished first, so they stop taking cache space
+			score += VALENCE_BOOST_SCALE * std::pow(float(remainingTriangles), -VALENCE_BOOST_POWER);
+			return score;
+		}
+
+		uint32_t HashVertex(const unsigned char* vertex, size_t stride)
+		{
+			uint32_t hash = 2166136261u; // FNV-1a
+			for (size_t i = 0; i < stride; ++i) {
+				hash ^= vertex[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+
+		vec3 GetPosition(const float* positions, size_t positionStride, unsigned int index)
+		{
+			const float* position = positions + size_t(index) * positionStride;
+			return vec3(position[0], position[1], position[2]);
+		}
+	}
+
+	unsigned int MeshOptimizer::GenerateVertexRemap(std::vector<unsigned int>& remap, const unsigned int* indices, size_t indexCount,
+													const void* vertices, unsigned int vertexCount, size_t vertexStride)
+	{
+		remap.assign(vertexCount, MESH_OPTIMIZER_UNUSED_VERTEX);
+		const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+
+		// Open addressing over the original vertex ids, at most half full
+		size_t tableSize = 1;
+		while (tableSize < size_t(vertexCount) * 2)
+			tableSize *= 2;
+		std::vector<unsigned int> table(tableSize, MESH_OPTIMIZER_UNUSED_VERTEX);
+
+		unsigned int uniqueCount = 0;
+		for (size_t i = 0; i < indexCount; ++i) {
+			unsigned int index = indices[i];
+			if (remap[index] != MESH_OPTIMIZER_UNUSED_VERTEX)
+				continue;
+
+			const unsigned char* vertex = bytes + size_t(index) * vertexStride;
+			size_t slot = HashVertex(vertex, vertexStride) & (tableSize - 1);
+			while (table[slot] != MESH_OPTIMIZER_UNUSED_VERTEX &&
+				   std::memcmp(bytes + size_t(table[slot]) * vertexStride, vertex, vertexStride) != 0)
+				slot = (slot + 1) & (tableSize - 1);
+
+			if (table[slot] == MESH_OPTIMIZER_UNUSED_VERTEX) {
+				table[slot] = index;
+				remap[index] = uniqueCount++;
+			}
+			else {
+				remap[index] = remap[table[slot]];
+			}
+		}
+		return uniqueCount;
+	}
+
+	unsigned int MeshOptimizer::GenerateVertexFetchRemap(std::vector<unsigned int>& remap, const unsigned int* indices, size_t indexCount,
+														 unsigned int vertexCount)
+	{
+		remap.assign(vertexCount, MESH_OPTIMIZER_UNUSED_VERTEX);
+
+		unsigned int nextVertex = 0;
+		for (size_t i = 0; i < indexCount; ++i) {
+			if (remap[indices[i]] == MESH_OPTIMIZER_UNUSED_VERTEX)
+				remap[indices[i]] = nextVertex++;
+		}
+		return nextVertex;
+	}
+
+	void MeshOptimizer::RemapIndices(std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap)
+	{
+		for (unsigned int& index : indices)
+			index = remap[index];
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount)
+	{
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0 || vertexCount == 0)
+			return;
+
+		// Triangles not drawn yet of each vertex, as ranges of one shared array
+		std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+		for (unsigned int index : indices)
+			++remainingTriangles[index];
+
+		std::vector<unsigned int> adjacencyOffsets(vertexCount);
+		unsigned int offset = 0;
+		for (unsigned int v = 0; v < vertexCount; ++v) {
+			adjacencyOffsets[v] = offset;
+			offset += remainingTriangles[v];
+		}
+
+		std::vector<unsigned int> adjacency(indices.size());
+		std::vector<unsigned int> adjacencyFill = adjacencyOffsets;
+		for (size_t i = 0; i < indices.size(); ++i)
+			adjacency[adjacencyFill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+		std::vector<int> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (unsigned int v = 0; v < vertexCount; ++v)
+			vertexScores[v] = GetVertexScore(-1, remainingTriangles[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		size_t bestTriangle = 0;
+		for (size_t t = 0; t < triangleCount; ++t) {
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			if (triangleScores[t] > triangleScores[bestTriangle])
+				bestTriangle = t;
+		}
+
+		unsigned int cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+		unsigned int newCache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+		unsigned int cacheCount = 0;
+
+		std::vector<unsigned int> result;
+		result.reserve(indices.size());
+		size_t nextUnemitted = 0;
+
+		while (result.size() < indices.size()) {
+			// Nothing in the cache leads anywhere, continue from the first triangle left
+			if (bestTriangle == triangleCount) {
+				while (emitted[nextUnemitted])
+					++nextUnemitted;
+				bestTriangle = nextUnemitted;
+			}
+
+			const unsigned int* triangle = &indices[bestTriangle * 3];
+			result.insert(result.end(), triangle, triangle + 3);
+			emitted[bestTriangle] = 1;
+
+			unsigned int newCacheCount = 0;
+			for (int c = 0; c < 3; ++c) {
+				unsigned int v = triangle[c];
+
+				// Take the triangle out of the vertex's list, one entry per corner using it
+				unsigned int* begin = adjacency.data() + adjacencyOffsets[v];
+				unsigned int* end = begin + remainingTriangles[v];
+				unsigned int* found = std::find(begin, end, static_cast<unsigned int>(bestTriangle));
+				*found = *(end - 1);
+				--remainingTriangles[v];
+
+				if (std::find(newCache, newCache + newCacheCount, v) == newCache + newCacheCount)
+					newCache[newCacheCount++] = v;
+			}
+			unsigned int triangleVertexCount = newCacheCount;
+			for (unsigned int i = 0; i < cacheCount; ++i) {
+				if (std::find(newCache, newCache + triangleVertexCount, cache[i]) == newCache + triangleVertexCount)
+					newCache[newCacheCount++] = cache[i];
+			}
+
+			// Rescore everything that moved, the entries pushed past the cache size fall out
+			for (unsigned int i = 0; i < newCacheCount; ++i) {
+				unsigned int v = newCache[i];
+				cachePositions[v] = i < MESH_OPTIMIZER_CACHE_SIZE ? int(i) : -1;
+
+				float score = GetVertexScore(cachePositions[v], remainingTriangles[v]);
+				float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+
+				const unsigned int* adjacent = adjacency.data() + adjacencyOffsets[v];
+				for (unsigned int a = 0; a < remainingTriangles[v]; ++a)
+					triangleScores[adjacent[a]] += delta;
+			}
+
+			cacheCount = std::min(newCacheCount, MESH_OPTIMIZER_CACHE_SIZE);
+			std::copy(newCache, newCache + cacheCount, cache);
+
+			// Only the triangles of cached vertices had their score raised
+			bestTriangle = triangleCount;
+			float bestScore = -1.0f;
+			for (unsigned int i = 0; i < cacheCount; ++i) {
+				unsigned int v = cache[i];
+				const unsigned int* adjacent = adjacency.data() + adjacencyOffsets[v];
+				for (unsigned int a = 0; a < remainingTriangles[v]; ++a) {
+					if (triangleScores[adjacent[a]] > bestScore) {
+						bestScore = triangleScores[adjacent[a]];
+						bestTriangle = adjacent[a];
+					}
+				}
+			}
+		}
+
+		indices.swap(result);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+										 unsigned int vertexCount, float threshold)
+	{
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2 || vertexCount == 0)
+			return;
+
+		float acmr = ComputeACMR(indices.data(), indices.size(), vertexCount);
+
+		// A triangle missing all of its vertices starts a new patch of the mesh, moving whole
+		// patches around barely changes the cache behaviour
+		std::vector<size_t> clusterStarts;
+		std::vector<unsigned int> timestamps(vertexCount, 0);
+		unsigned int time = MESH_OPTIMIZER_FIFO_SIZE + 1;
+		for (size_t t = 0; t < triangleCount; ++t) {
+			unsigned int misses = 0;
+			for (int c = 0; c < 3; ++c) {
+				unsigned int v = indices[t * 3 + c];
+				if (time - timestamps[v] > MESH_OPTIMIZER_FIFO_SIZE) {
+					timestamps[v] = time++;
+					++misses;
+				}
+			}
+			if (t == 0 || misses == 3)
+				clusterStarts.push_back(t);
+		}
+		if (clusterStarts.size() < 2)
+			return;
+		clusterStarts.push_back(triangleCount);
+
+		// Area weighted centroid and normal of each cluster and of the whole mesh
+		size_t clusterCount = clusterStarts.size() - 1;
+		std::vector<vec3> clusterCentroids(clusterCount, vec3(0.0f));
+		std::vector<vec3> clusterNormals(clusterCount, vec3(0.0f));
+		vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+		for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+			float clusterArea = 0.0f;
+			for (size_t t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; ++t) {
+				vec3 p0 = GetPosition(positions, positionStride, indices[t * 3]);
+				vec3 p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+				vec3 p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+
+				vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+				clusterNormals[cluster] += normal;
+				clusterArea += area;
+			}
+			meshCentroid += clusterCentroids[cluster];
+			meshArea += clusterArea;
+			if (clusterArea > 0.0f)
+				clusterCentroids[cluster] /= clusterArea;
+		}
+		if (meshArea <= 0.0f)
+			return;
+		meshCentroid /= meshArea;
+
+		// Clusters facing away from the centre are likely in front of the rest, draw them first
+		std::vector<float> sortKeys(clusterCount);
+		std::vector<size_t> order(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+			float normalLength = glm::length(clusterNormals[cluster]);
+			vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : vec3(0.0f);
+			sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, normal);
+			order[cluster] = cluster;
+		}
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<unsigned int> result;
+		result.reserve(indices.size());
+		for (size_t cluster : order)
+			result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+
+		if (ComputeACMR(result.data(), result.size(), vertexCount) <= acmr * threshold)
+			indices.swap(result);
+	}
+
+	float MeshOptimizer::ComputeACMR(const unsigned int* indices, size_t indexCount, unsigned int vertexCount, unsigned int cacheSize)
+	{
+		if (indexCount < 3)
+			return 0.0f;
+
+		// A vertex is still cached while fewer than cacheSize others were loaded after it
+		std::vector<unsigned int> timestamps(vertexCount, 0);
+		unsigned int time = cacheSize + 1;
+		unsigned int misses = 0;
+		for (size_t i = 0; i < indexCount; ++i) {
+			unsigned int v = indices[i];
+			if (time - timestamps[v] > cacheSize) {
+				timestamps[v] = time++;
+				++misses;
+			}
+		}
+		return float(misses) / float(indexCount / 3);
+	}
+}
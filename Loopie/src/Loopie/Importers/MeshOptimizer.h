@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace Loopie {
+	constexpr unsigned int MESH_OPTIMIZER_UNUSED_VERTEX = ~0u; // Remap entry of a vertex no triangle references
+	constexpr unsigned int MESH_OPTIMIZER_CACHE_SIZE = 32; // LRU cache modelled by OptimizeVertexCache
+	constexpr unsigned int MESH_OPTIMIZER_FIFO_SIZE = 16; // FIFO cache used to measure ACMR, close to real hardware
+	constexpr float MESH_OPTIMIZER_OVERDRAW_THRESHOLD = 1.05f; // ACMR the overdraw pass may give up, as a ratio
+
+	// *** Mesh optimizer ***
+	// Import time passes over indexed triangle lists. The vertex data stays with the caller:
+	// passes that move vertices return a remap table (remap[oldIndex] = newIndex) to apply to
+	// every vertex stream with RemapVertices, and the indices are rewritten in place.
+	class MeshOptimizer
+	{
+	public:
+		// Merges vertices whose stride bytes are identical, returns the unique vertex count
+		static unsigned int GenerateVertexRemap(std::vector<unsigned int>& remap, const unsigned int* indices, size_t indexCount,
+												const void* vertices, unsigned int vertexCount, size_t vertexStride);
+		// Renumbers vertices in the order the triangles first use them, returns the referenced vertex count
+		static unsigned int GenerateVertexFetchRemap(std::vector<unsigned int>& remap, const unsigned int* indices, size_t indexCount,
+													 unsigned int vertexCount);
+		static void RemapIndices(std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap);
+
+		// Reorders the triangles for the post transform vertex cache (Forsyth's linear speed algorithm)
+		static void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+		// Reorders the clusters OptimizeVertexCache left so the ones facing outwards are drawn first,
+		// as long as the ACMR does not grow past threshold times the current one. positionStride is counted in floats
+		static void OptimizeOverdraw(std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+									 unsigned int vertexCount, float threshold = MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+
+		// Average cache miss ratio: transformed vertices per triangle, from 3 (no reuse) down to ~0.5
+		static float ComputeACMR(const unsigned int* indices, size_t indexCount, unsigned int vertexCount,
+								 unsigned int cacheSize = MESH_OPTIMIZER_FIFO_SIZE);
+
+		// elementsPerVertex values of T per vertex
+		template<typename T>
+		static void RemapVertices(std::vector<T>& vertices, size_t elementsPerVertex, const std::vector<unsigned int>& remap, unsigned int newVertexCount)
+		{
+			std::vector<T> result(size_t(newVertexCount) * elementsPerVertex);
+			for (size_t i = 0; i < remap.size(); ++i) {
+				if (remap[i] != MESH_OPTIMIZER_UNUSED_VERTEX)
+					std::memcpy(&result[size_t(remap[i]) * elementsPerVertex], &vertices[i * elementsPerVertex], elementsPerVertex * sizeof(T));
+			}
+			vertices.swap(result);
+		}
+	};
+}
@@ -0,0 +1,305 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Loopie {
+	namespace {
+		constexpr int BLOCK_PIXELS = TEXTURE_BLOCK_SIZE * TEXTURE_BLOCK_SIZE;
+		constexpr int POWER_ITERATIONS = 4;
+
+		// 4x4 pixels out of the image, clamping to the edges
+		void ReadBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, unsigned char block[BLOCK_PIXELS][4])
+		{
+			for (int y = 0; y < TEXTURE_BLOCK_SIZE; ++y) {
+				int sourceY = std::min(blockY * TEXTURE_BLOCK_SIZE + y, height - 1);
+				for (int x = 0; x < TEXTURE_BLOCK_SIZE; ++x) {
+					int sourceX = std::min(blockX * TEXTURE_BLOCK_SIZE + x, width - 1);
+					const unsigned char* pixel = rgba + (size_t(sourceY) * width + sourceX) * 4;
+					std::copy(pixel, pixel + 4, block[y * TEXTURE_BLOCK_SIZE + x]);
+				}
+			}
+		}
+
+		uint16_t PackRGB565(const float color[3])
+		{
+			int r = std::clamp(int(std::lround(color[0] * 31.0f / 255.0f)), 0, 31);
+			int g = std::clamp(int(std::lround(color[1] * 63.0f / 255.0f)), 0, 63);
+			int b = std::clamp(int(std::lround(color[2] * 31.0f / 255.0f)), 0, 31);
+			return uint16_t((r << 11) | (g << 5) | b);
+		}
+
+		void UnpackRGB565(uint16_t packed, int color[3])
+		{
+			int r = (packed >> 11) & 31;
+			int g = (packed >> 5) & 63;
+			int b = packed & 31;
+			color[0] = (r << 3) | (r >> 2);
+			color[1] = (g << 2) | (g >> 4);
+			color[2] = (b << 3) | (b >> 2);
+		}
+
+		// Index of the closest palette entry to every pixel, 2 bits each with pixel 0 in the lowest bits
+		uint32_t FindColorIndices(const unsigned char block[BLOCK_PIXELS][4], uint16_t color0, uint16_t color1)
+		{
+			int palette[4][3];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (int c = 0; c < 3; ++c) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			uint32_t indices = 0;
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				int bestIndex = 0;
+				int bestDistance = INT32_MAX;
+				for (int p = 0; p < 4; ++p) {
+					int dr = block[i][0] - palette[p][0];
+					int dg = block[i][1] - palette[p][1];
+					int db = block[i][2] - palette[p][2];
+					int distance = dr * dr + dg * dg + db * db;
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+				indices |= uint32_t(bestIndex) << (i * 2);
+			}
+			return indices;
+		}
+
+		// Endpoints that best fit the given indices in the least squares sense, false if they are degenerate
+		bool RefineEndpoints(const unsigned char block[BLOCK_PIXELS][4], uint32_t indices, float endpoint0[3], float endpoint1[3])
+		{
+			static const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f }; // Of endpoint0 per index
+
+			float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+			float ax[3] = {}, bx[3] = {};
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				float a = WEIGHTS[(indices >> (i * 2)) & 3];
+				float b = 1.0f - a;
+				aa += a * a;
+				bb += b * b;
+				ab += a * b;
+				for (int c = 0; c < 3; ++c) {
+					ax[c] += a * block[i][c];
+					bx[c] += b * block[i][c];
+				}
+			}
+
+			float determinant = aa * bb - ab * ab;
+			if (std::fabs(determinant) < 1e-6f)
+				return false;
+
+			for (int c = 0; c < 3; ++c) {
+				endpoint0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+				endpoint1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+			}
+			return true;
+		}
+
+		void EncodeColorBlock(const unsigned char block[BLOCK_PIXELS][4], unsigned char* output)
+		{
+			float mean[3] = {};
+			float minColor[3] = { 255.0f, 255.0f, 255.0f };
+			float maxColor[3] = {};
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				for (int c = 0; c < 3; ++c) {
+					mean[c] += block[i][c];
+					minColor[c] = std::min(minColor[c], float(block[i][c]));
+					maxColor[c] = std::max(maxColor[c], float(block[i][c]));
+				}
+			}
+			for (int c = 0; c < 3; ++c)
+				mean[c] /= BLOCK_PIXELS;
+
+			// Principal axis of the colors by power iteration over the covariance, starting from the bounding box diagonal
+			float covariance[6] = {};
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				float r = block[i][0] - mean[0];
+				float g = block[i][1] - mean[1];
+				float b = block[i][2] - mean[2];
+				covariance[0] += r * r;
+				covariance[1] += r * g;
+				covariance[2] += r * b;
+				covariance[3] += g * g;
+				covariance[4] += g * b;
+				covariance[5] += b * b;
+			}
+
+			float axis[3] = { maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2] };
+			for (int iteration = 0; iteration < POWER_ITERATIONS; ++iteration) {
+				float x = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+				float y = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+				float z = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+				float length = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+				if (length <= 0.0f)
+					break;
+				axis[0] = x / length;
+				axis[1] = y / length;
+				axis[2] = z / length;
+			}
+
+			// The extreme colors along the axis become the endpoints
+			float minProjection = 0.0f, maxProjection = 0.0f;
+			int minIndex = 0, maxIndex = 0;
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				float projection = block[i][0] * axis[0] + block[i][1] * axis[1] + block[i][2] * axis[2];
+				if (i == 0 || projection < minProjection) {
+					minProjection = projection;
+					minIndex = i;
+				}
+				if (i == 0 || projection > maxProjection) {
+					maxProjection = projection;
+					maxIndex = i;
+				}
+			}
+
+			float endpoint0[3], endpoint1[3];
+			for (int c = 0; c < 3; ++c) {
+				endpoint0[c] = block[maxIndex][c];
+				endpoint1[c] = block[minIndex][c];
+			}
+
+			uint16_t color0 = PackRGB565(endpoint0);
+			uint16_t color1 = PackRGB565(endpoint1);
+			uint32_t indices = 0;
+			if (color0 != color1) {
+				if (color0 < color1)
+					std::swap(color0, color1);
+				indices = FindColorIndices(block, color0, color1);
+
+				// One least squares pass over the chosen indices, kept only if it helps
+				if (RefineEndpoints(block, indices, endpoint0, endpoint1)) {
+					uint16_t refined0 = PackRGB565(endpoint0);
+					uint16_t refined1 = PackRGB565(endpoint1);
+					if (refined0 < refined1)
+						std::swap(refined0, refined1);
+					if (refined0 != refined1) {
+						color0 = refined0;
+						color1 = refined1;
+						indices = FindColorIndices(block, color0, color1);
+					}
+				}
+			}
+
+			// color0 > color1 selects the four color mode, equal endpoints decode every index 0 to color0
+			output[0] = uint8_t(color0 & 0xFF);
+			output[1] = uint8_t(color0 >> 8);
+			output[2] = uint8_t(color1 & 0xFF);
+			output[3] = uint8_t(color1 >> 8);
+			output[4] = uint8_t(indices & 0xFF);
+			output[5] = uint8_t((indices >> 8) & 0xFF);
+			output[6] = uint8_t((indices >> 16) & 0xFF);
+			output[7] = uint8_t(indices >> 24);
+		}
+
+		void EncodeAlphaBlock(const unsigned char block[BLOCK_PIXELS][4], unsigned char* output)
+		{
+			int alpha0 = 0, alpha1 = 255;
+			for (int i = 0; i < BLOCK_PIXELS; ++i) {
+				alpha0 = std::max(alpha0, int(block[i][3]));
+				alpha1 = std::min(alpha1, int(block[i][3]));
+			}
+
+			// alpha0 > alpha1 selects the 8 value mode: alpha0, alpha1 and 6 steps between them
+			int palette[8] = { alpha0, alpha1 };
+			for (int i = 2; i < 8; ++i)
+				palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+
+			uint64_t indices = 0;
+			if (alpha0 != alpha1) {
+				for (int i = 0; i < BLOCK_PIXELS; ++i) {
+					int bestIndex = 0;
+					int bestDistance = INT32_MAX;
+					for (int p = 0; p < 8; ++p) {
+						int distance = std::abs(block[i][3] - palette[p]);
+						if (distance < bestDistance) {
+							bestDistance = distance;
+							bestIndex = p;
+						}
+					}
+					indices |= uint64_t(bestIndex) << (i * 3);
+				}
+			}
+
+			output[0] = uint8_t(alpha0);
+			output[1] = uint8_t(alpha1);
+			for (int i = 0; i < 6; ++i)
+				output[2 + i] = uint8_t((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	void TextureCompressor::CompressBC1(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output)
+	{
+		int blocksX = (width + TEXTURE_BLOCK_SIZE - 1) / TEXTURE_BLOCK_SIZE;
+		int blocksY = (height + TEXTURE_BLOCK_SIZE - 1) / TEXTURE_BLOCK_SIZE;
+		size_t start = output.size();
+		output.resize(start + size_t(blocksX) * blocksY * TEXTURE_BC1_BLOCK_BYTES);
+
+		unsigned char block[BLOCK_PIXELS][4];
+		unsigned char* destination = output.data() + start;
+		for (int y = 0; y < blocksY; ++y) {
+			for (int x = 0; x < blocksX; ++x) {
+				ReadBlock(rgba, width, height, x, y, block);
+				EncodeColorBlock(block, destination);
+				destination += TEXTURE_BC1_BLOCK_BYTES;
+			}
+		}
+	}
+
+	void TextureCompressor::CompressBC3(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output)
+	{
+		int blocksX = (width + TEXTURE_BLOCK_SIZE - 1) / TEXTURE_BLOCK_SIZE;
+		int blocksY = (height + TEXTURE_BLOCK_SIZE - 1) / TEXTURE_BLOCK_SIZE;
+		size_t start = output.size();
+		output.resize(start + size_t(blocksX) * blocksY * TEXTURE_BC3_BLOCK_BYTES);
+
+		// Each block is the alpha block followed by a BC1 color block
+		unsigned char block[BLOCK_PIXELS][4];
+		unsigned char* destination = output.data() + start;
+		for (int y = 0; y < blocksY; ++y) {
+			for (int x = 0; x < blocksX; ++x) {
+				ReadBlock(rgba, width, height, x, y, block);
+				EncodeAlphaBlock(block, destination);
+				EncodeColorBlock(block, destination + 8);
+				destination += TEXTURE_BC3_BLOCK_BYTES;
+			}
+		}
+	}
+
+	bool TextureCompressor::HasTransparency(const unsigned char* rgba, size_t pixelCount)
+	{
+		for (size_t i = 0; i < pixelCount; ++i) {
+			if (rgba[i * 4 + 3] != 255)
+				return true;
+		}
+		return false;
+	}
+
+	void TextureCompressor::GenerateMipLevel(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output)
+	{
+		int levelWidth = std::max(1, width / 2);
+		int levelHeight = std::max(1, height / 2);
+		output.resize(size_t(levelWidth) * levelHeight * 4);
+
+		for (int y = 0; y < levelHeight; ++y) {
+			int y0 = std::min(y * 2, height - 1);
+			int y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < levelWidth; ++x) {
+				int x0 = std::min(x * 2, width - 1);
+				int x1 = std::min(x * 2 + 1, width - 1);
+
+				const unsigned char* p00 = rgba + (size_t(y0) * width + x0) * 4;
+				const unsigned char* p01 = rgba + (size_t(y0) * width + x1) * 4;
+				const unsigned char* p10 = rgba + (size_t(y1) * width + x0) * 4;
+				const unsigned char* p11 = rgba + (size_t(y1) * width + x1) * 4;
+				unsigned char* destination = output.data() + (size_t(y) * levelWidth + x) * 4;
+				for (int c = 0; c < 4; ++c)
+					destination[c] = uint8_t((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Loopie {
+	constexpr int TEXTURE_BLOCK_SIZE = 4; // BCn blocks are 4x4 pixels
+	constexpr size_t TEXTURE_BC1_BLOCK_BYTES = 8;
+	constexpr size_t TEXTURE_BC3_BLOCK_BYTES = 16;
+
+	// *** Texture compressor ***
+	// CPU BC1 / BC3 encoder used at import time. Endpoints come from the principal axis of the block
+	// colors, refined once with a least squares fit to the chosen indices. Blocks past the right or
+	// bottom edge repeat the last column / row, so any size can be compressed.
+	class TextureCompressor
+	{
+	public:
+		// rgba is width x height RGBA8, the blocks are appended to output row by row
+		static void CompressBC1(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output);
+		static void CompressBC3(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output);
+
+		static bool HasTransparency(const unsigned char* rgba, size_t pixelCount);
+		// Box filtered RGBA8 level of half the size (at least 1x1), written to output
+		static void GenerateMipLevel(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& output);
+	};
+}
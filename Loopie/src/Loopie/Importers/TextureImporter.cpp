@@ -2,66 +2,173 @@
 
 #include "Loopie/Core/Log.h"
 #include "Loopie/Core/Application.h"
+#include "Loopie/Resources/AssetPack.h"
+#include "Loopie/Importers/ImageDecoder.h"
+#include "Loopie/Importers/TextureCompressor.h"
+#include "Loopie/Files/ChunkedLZ4.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
 
-#include <IL/il.h>
-#include <IL/ilu.h>
-#include <lz4.h>
-
 namespace Loopie {
 
-    void TextureImporter::ImportImage(const std::string& filepath, Metadata& metadata)
+    // *** .texture cache layout ***
+    // TextureFileHeader | uint32 chunk size | TextureFileLevel per mip | uint32 compressed size per chunk |
+    // every mip level, largest first, split in LZ4 chunks (see ChunkedLZ4)
+    // Levels are separate so the TextureStreamer can read just the small ones, chunks so the large ones
+    // compress and decompress in parallel. Version 2 caches have one LZ4 block per level and no chunk
+    // table, version 1 caches no level table and a single LZ4 block with every level.
+    // Caches without the magic come from before the header: width, height, channels, LZ4 size, LZ4 RGBA8 level 0
+    constexpr uint32_t TEXTURE_FILE_MAGIC = 0x5845544C; // "LTEX"
+    constexpr uint32_t TEXTURE_FILE_VERSION = 3;
+
+    struct TextureFileHeader {
+        uint32_t Magic = TEXTURE_FILE_MAGIC;
+        uint32_t Version = TEXTURE_FILE_VERSION;
+        int32_t Width = 0;
+        int32_t Height = 0;
+        int32_t Channels = 0;
+        uint32_t Compression = 0; // TextureCompression
+        uint32_t MipCount = 0;
+        uint32_t DataSize = 0; // Of all the levels once decompressed
+        uint32_t CompressedSize = 0;
+    };
+
+    struct TextureFileLevel {
+        uint32_t Offset = 0; // From the start of the file
+        uint32_t CompressedSize = 0;
+        uint32_t Size = 0;
+    };
+
+    // One LZ4 compressed run of level data to read, split in chunks of ChunkSize bytes
+    struct TextureFileBlock {
+        uint32_t Offset = 0;
+        uint32_t CompressedSize = 0;
+        uint32_t Size = 0;
+        uint32_t ChunkSize = 0;
+        size_t FirstChunk = 0; // In the chunk size table
+    };
+
+    // Fills everything in data but the pixels, leaving file right after the header
+    static bool ReadTextureHeader(std::istream& file, TextureData& data, uint32_t& version, int& compressedSize, unsigned int& dataSize)
+    {
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.seekg(0, std::ios::beg);
+
+        if (magic == TEXTURE_FILE_MAGIC) {
+            TextureFileHeader header;
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (header.Version == 0 || header.Version > TEXTURE_FILE_VERSION || header.Compression > static_cast<uint32_t>(TextureCompression::BC3))
+                return false;
+
+            version = header.Version;
+            data.Width = header.Width;
+            data.Height = header.Height;
+            data.Channels = header.Channels;
+            data.Compression = static_cast<TextureCompression>(header.Compression);
+            data.MipCount = header.MipCount;
+            compressedSize = static_cast<int>(header.CompressedSize);
+            dataSize = header.DataSize;
+        }
+        else {
+            version = 0;
+            data.Compression = TextureCompression::NONE;
+            data.MipCount = 1;
+            file.read(reinterpret_cast<char*>(&data.Width), sizeof(data.Width));
+            file.read(reinterpret_cast<char*>(&data.Height), sizeof(data.Height));
+            file.read(reinterpret_cast<char*>(&data.Channels), sizeof(data.Channels));
+            file.read(reinterpret_cast<char*>(&compressedSize), sizeof(compressedSize));
+            dataSize = static_cast<unsigned int>(data.Width) * data.Height * data.Channels;
+        }
+
+        if (!file || data.Width <= 0 || data.Height <= 0 || data.Channels <= 0 || compressedSize <= 0 ||
+            data.MipCount == 0 || data.MipCount > GetTextureMipCount(data.Width, data.Height))
+            return false;
+
+        // The levels must add up to exactly what the header says, UploadImage walks them blindly
+        size_t levelsSize = 0;
+        for (unsigned int i = 0; i < data.MipCount; ++i)
+            levelsSize += GetTextureLevelSize(data.Compression, std::max(1, data.Width >> i), std::max(1, data.Height >> i), data.Channels);
+        return levelsSize == dataSize;
+    }
+
+    TextureImportSettings TextureImporter::s_settings;
+
+    void TextureImporter::ImportImage(const std::string& filepath, Metadata& metadata, bool saveMetadata)
+    {
+        TextureImportSettings settings = s_settings;
+        ImportImage(filepath, metadata, settings, saveMetadata);
+    }
+
+    void TextureImporter::ImportImage(const std::string& filepath, Metadata& metadata, const TextureImportSettings& settings, bool saveMetadata)
     {
         if (metadata.HasCache && !metadata.IsOutdated)
             return;
 
-        ILuint imageID;
-        ilGenImages(1, &imageID);
-        ilBindImage(imageID);
-
-        if (!ilLoadImage(filepath.c_str())) {
+        int width = 0;
+        int height = 0;
+        int sourceChannels = 0;
+        std::vector<unsigned char> pixels;
+        if (!ImageDecoder::Decode(filepath, pixels, width, height, sourceChannels)) {
             Log::Error("Failed to load image {0}", filepath);
-            ilDeleteImages(1, &imageID);
             return;
         }
+        const int channels = 4;
+
+        // Mip chain built and block compressed here, the GPU gets it as it is
+        TextureCompression compression = TextureCompression::NONE;
+        if (settings.CompressBlocks)
+            compression = (sourceChannels == 2 || sourceChannels == 4) && TextureCompressor::HasTransparency(pixels.data(), size_t(width) * height) ? TextureCompression::BC3 : TextureCompression::BC1;
+        unsigned int mipCount = settings.GenerateMipmaps ? GetTextureMipCount(width, height) : 1;
 
-        ILint format = ilGetInteger(IL_IMAGE_FORMAT);
-        ILint type = ilGetInteger(IL_IMAGE_TYPE);
-        if (format != IL_RGBA || type != IL_UNSIGNED_BYTE) {
-            if (!ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE)) {
-                Log::Error("Failed to convert image {0}", filepath);
-                ilDeleteImages(1, &imageID);
+        std::vector<TextureFileLevel> levels(mipCount);
+        std::vector<uint32_t> chunkSizes;
+        std::vector<char> compressedBuffer;
+        std::vector<unsigned char> level;
+        std::vector<unsigned char> nextLevel;
+        size_t uncompressedChainSize = 0;
+        unsigned int imageSize = 0;
+        int levelWidth = width;
+        int levelHeight = height;
+        for (unsigned int i = 0; i < mipCount; ++i) {
+            uncompressedChainSize += pixels.size();
+            level.clear();
+            if (compression == TextureCompression::BC1)
+                TextureCompressor::CompressBC1(pixels.data(), levelWidth, levelHeight, level);
+            else if (compression == TextureCompression::BC3)
+                TextureCompressor::CompressBC3(pixels.data(), levelWidth, levelHeight, level);
+            else
+                level = pixels;
+
+            size_t start = compressedBuffer.size();
+            if (!ChunkedLZ4::Compress(level.data(), level.size(), LZ4_CHUNK_SIZE, compressedBuffer, chunkSizes)) {
+                Log::Error("Failed to compress image {0}", filepath);
                 return;
             }
-        }
 
-        int width = ilGetInteger(IL_IMAGE_WIDTH);
-        int height = ilGetInteger(IL_IMAGE_HEIGHT);
-        int channels = ilGetInteger(IL_IMAGE_CHANNELS);
-        unsigned int imageSize = static_cast<unsigned int>(width) * height * channels;
+            levels[i].Offset = static_cast<uint32_t>(start); // Made absolute once the tables are sized
+            levels[i].CompressedSize = static_cast<uint32_t>(compressedBuffer.size() - start);
+            levels[i].Size = static_cast<uint32_t>(level.size());
+            imageSize += static_cast<unsigned int>(level.size());
 
-        ILubyte* data = ilGetData();
-        if (!data) {
-            Log::Error("Invalid image data for {0}", filepath);
-            ilDeleteImages(1, &imageID);
-            return;
+            if (i + 1 < mipCount) {
+                TextureCompressor::GenerateMipLevel(pixels.data(), levelWidth, levelHeight, nextLevel);
+                pixels.swap(nextLevel);
+                levelWidth = std::max(1, levelWidth / 2);
+                levelHeight = std::max(1, levelHeight / 2);
+            }
         }
+        pixels.clear();
+        pixels.shrink_to_fit();
+        int compressedSize = static_cast<int>(compressedBuffer.size());
 
-        int maxCompressedSize = LZ4_compressBound(static_cast<int>(imageSize));
-        std::vector<char> compressedBuffer;
-        compressedBuffer.resize(maxCompressedSize);
-
-        int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(data), compressedBuffer.data(), static_cast<int>(imageSize), maxCompressedSize);
-
-        if (compressedSize <= 0) {
-            Log::Error("Failed to compress image {0}", filepath);
-            ilDeleteImages(1, &imageID);
-            return;
-        }
-        ilDeleteImages(1, &imageID);
+        uint32_t chunkSize = static_cast<uint32_t>(LZ4_CHUNK_SIZE);
+        size_t dataOffset = sizeof(TextureFileHeader) + sizeof(chunkSize) + levels.size() * sizeof(TextureFileLevel) + chunkSizes.size() * sizeof(uint32_t);
+        for (TextureFileLevel& fileLevel : levels)
+            fileLevel.Offset += static_cast<uint32_t>(dataOffset);
 
         Project project = Application::GetInstance().m_activeProject;
         UUID id;
@@ -75,10 +182,19 @@ namespace Loopie {
             return;
         }
 
-        fs.write(reinterpret_cast<const char*>(&width), sizeof(width));
-        fs.write(reinterpret_cast<const char*>(&height), sizeof(height));
-        fs.write(reinterpret_cast<const char*>(&channels), sizeof(channels));
-        fs.write(reinterpret_cast<const char*>(&compressedSize), sizeof(compressedSize));
+        TextureFileHeader header;
+        header.Width = width;
+        header.Height = height;
+        header.Channels = channels;
+        header.Compression = static_cast<uint32_t>(compression);
+        header.MipCount = mipCount;
+        header.DataSize = imageSize;
+        header.CompressedSize = static_cast<uint32_t>(compressedSize);
+
+        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fs.write(reinterpret_cast<const char*>(&chunkSize), sizeof(chunkSize));
+        fs.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(TextureFileLevel));
+        fs.write(reinterpret_cast<const char*>(chunkSizes.data()), chunkSizes.size() * sizeof(uint32_t));
         fs.write(compressedBuffer.data(), compressedSize);
         fs.close();
 
@@ -91,67 +207,148 @@ namespace Loopie {
         metadata.CachesPath.push_back(locationPath.string());
         metadata.Type = ResourceType::TEXTURE;
 
-        MetadataRegistry::SaveMetadata(filepath, metadata);
+        if (saveMetadata)
+            MetadataRegistry::SaveMetadata(filepath, metadata);
 
-        Log::Trace("Texture Imported -> {0} (Compressed: {1:.2f}MB -> {2:.2f}MB, Ratio: {3:.1f}%)", filepath, imageSize / (1024.0 * 1024.0), compressedSize / (1024.0 * 1024.0), (compressedSize * 100.0) / imageSize);
+        static const char* const COMPRESSION_NAMES[] = { "RGBA8", "BC1", "BC3" };
+        Log::Trace("Texture Imported -> {0} ({1}, {2} mips, GPU: {3:.2f}MB -> {4:.2f}MB, Disk: {5:.2f}MB)", filepath, COMPRESSION_NAMES[static_cast<int>(compression)], mipCount,
+            uncompressedChainSize / (1024.0 * 1024.0), imageSize / (1024.0 * 1024.0), compressedSize / (1024.0 * 1024.0));
     }
 
 
     void TextureImporter::LoadImage(const std::string& path, Texture& texture)
     {
         Project project = Application::GetInstance().m_activeProject;
-        std::filesystem::path filepath = project.GetChachePath() / path;
+        TextureData data;
+        if (ReadImage(project.GetChachePath() / path, data))
+            UploadImage(data, texture);
+    }
 
-        if (!std::filesystem::exists(filepath)) {
+    bool TextureImporter::ReadImage(const std::filesystem::path& filepath, TextureData& data, unsigned int firstMip)
+    {
+        // From the mounted asset pack when it has the file
+        CacheFileStream file(filepath);
+        if (!file.IsOpen()) {
             Log::Warn("Texture cache file not found: {0}", filepath.string());
-            return;
-        }
-
-        std::ifstream file(filepath, std::ios::binary);
-        if (!file) {
-            Log::Warn("Error opening .texture file -> {0}", filepath.string());
-            return;
+            return false;
         }
 
-        file.read(reinterpret_cast<char*>(&texture.m_width), sizeof(texture.m_width));
-        file.read(reinterpret_cast<char*>(&texture.m_height), sizeof(texture.m_height));
-        file.read(reinterpret_cast<char*>(&texture.m_channels), sizeof(texture.m_channels));
-
+        uint32_t version = 0;
         int compressedSize = 0;
-        file.read(reinterpret_cast<char*>(&compressedSize), sizeof(compressedSize));
-
-        if (texture.m_width <= 0 || texture.m_height <= 0 || texture.m_channels <= 0 || compressedSize <= 0) {
+        unsigned int imageSize = 0;
+        if (!ReadTextureHeader(file, data, version, compressedSize, imageSize)) {
             Log::Warn("Invalid texture data in file -> {0}", filepath.string());
-            return;
+            return false;
         }
 
-        std::vector<char> compressedData(compressedSize);
-        file.read(compressedData.data(), compressedSize);
-        file.close();
+        std::vector<TextureFileBlock> blocks;
+        std::vector<uint32_t> chunkSizes;
+        if (version < 2) {
+            // Every level in one block, always read whole
+            data.FirstMip = 0;
+            blocks.push_back({ static_cast<uint32_t>(file.tellg()), static_cast<uint32_t>(compressedSize), imageSize, imageSize, 0 });
+            chunkSizes.push_back(static_cast<uint32_t>(compressedSize));
+        }
+        else {
+            uint32_t chunkSize = 0;
+            if (version >= 3)
+                file.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize));
+
+            std::vector<TextureFileLevel> levels(data.MipCount);
+            file.read(reinterpret_cast<char*>(levels.data()), levels.size() * sizeof(TextureFileLevel));
+
+            // Before version 3 each level is a single chunk
+            std::vector<uint32_t> levelChunkSizes(data.MipCount);
+            size_t chunkCount = 0;
+            for (unsigned int i = 0; i < data.MipCount; ++i) {
+                size_t expectedSize = GetTextureLevelSize(data.Compression, std::max(1, data.Width >> i), std::max(1, data.Height >> i), data.Channels);
+                if (!file || levels[i].Size != expectedSize || (version >= 3 && chunkSize == 0)) {
+                    Log::Warn("Invalid texture data in file -> {0}", filepath.string());
+                    return false;
+                }
+                levelChunkSizes[i] = version >= 3 ? chunkSize : levels[i].Size;
+                chunkCount += ChunkedLZ4::GetChunkCount(levels[i].Size, levelChunkSizes[i]);
+            }
 
-        unsigned int imageSize = static_cast<unsigned int>(texture.m_width) * texture.m_height * texture.m_channels;
-        std::vector<unsigned char> decompressedData(imageSize);
+            if (version >= 3) {
+                chunkSizes.resize(chunkCount);
+                file.read(reinterpret_cast<char*>(chunkSizes.data()), chunkSizes.size() * sizeof(uint32_t));
+            }
 
-        int decompressedSize = LZ4_decompress_safe(compressedData.data(), reinterpret_cast<char*>(decompressedData.data()), compressedSize, static_cast<int>(imageSize));
+            data.FirstMip = std::min(firstMip, data.MipCount - 1);
+            size_t firstChunk = 0;
+            for (unsigned int i = 0; i < data.MipCount; ++i) {
+                if (version < 3)
+                    chunkSizes.push_back(levels[i].CompressedSize);
+                if (i >= data.FirstMip)
+                    blocks.push_back({ levels[i].Offset, levels[i].CompressedSize, levels[i].Size, levelChunkSizes[i], firstChunk });
+                firstChunk += ChunkedLZ4::GetChunkCount(levels[i].Size, levelChunkSizes[i]);
+            }
+        }
 
-        if (decompressedSize < 0) {
-            Log::Error("Failed to decompress texture: {0}", path);
-            return;
+        size_t levelsSize = 0;
+        for (const TextureFileBlock& block : blocks)
+            levelsSize += block.Size;
+        data.Pixels.resize(levelsSize);
+
+        std::vector<char> compressedData;
+        size_t pixelsOffset = 0;
+        for (const TextureFileBlock& block : blocks) {
+            // The chunks must cover exactly the block, ChunkedLZ4 trusts their sizes
+            size_t blockChunks = ChunkedLZ4::GetChunkCount(block.Size, block.ChunkSize);
+            size_t chunksSize = 0;
+            for (size_t i = 0; i < blockChunks; ++i)
+                chunksSize += chunkSizes[block.FirstChunk + i];
+
+            compressedData.resize(block.CompressedSize);
+            file.seekg(block.Offset, std::ios::beg);
+            file.read(compressedData.data(), block.CompressedSize);
+
+            if (!file || chunksSize != block.CompressedSize ||
+                !ChunkedLZ4::Decompress(compressedData.data(), chunkSizes.data() + block.FirstChunk, data.Pixels.data() + pixelsOffset, block.Size, block.ChunkSize)) {
+                Log::Error("Failed to decompress texture: {0}", filepath.string());
+                data.Pixels.clear();
+                return false;
+            }
+            pixelsOffset += block.Size;
         }
+        return true;
+    }
 
-        texture.m_tb = std::make_shared<TextureBuffer>(decompressedData.data(), texture.m_width, texture.m_height, texture.m_channels);
+    bool TextureImporter::ReadImageInfo(const std::filesystem::path& filepath, TextureData& data)
+    {
+        CacheFileStream file(filepath);
+        if (!file.IsOpen()) {
+            Log::Warn("Texture cache file not found: {0}", filepath.string());
+            return false;
+        }
 
-        decompressedData.clear();
-        decompressedData.shrink_to_fit();
-        compressedData.clear();
-        compressedData.shrink_to_fit();
+        uint32_t version = 0;
+        int compressedSize = 0;
+        unsigned int imageSize = 0;
+        if (!ReadTextureHeader(file, data, version, compressedSize, imageSize)) {
+            Log::Warn("Invalid texture data in file -> {0}", filepath.string());
+            return false;
+        }
+        // Only version 2 caches can be read level by level
+        data.FirstMip = version < 2 ? 0 : data.MipCount - 1;
+        return true;
+    }
 
-        Log::Trace("Texture uploaded to GPU -> {0} ({1}x{2}), RAM freed", path, texture.m_width, texture.m_height);
+    void TextureImporter::UploadImage(const TextureData& data, Texture& texture)
+    {
+        texture.m_width = data.Width;
+        texture.m_height = data.Height;
+        texture.m_channels = data.Channels;
+        texture.m_firstMip = data.FirstMip;
+        texture.m_tb = std::make_shared<TextureBuffer>(data.Pixels.data(), std::max(1, data.Width >> data.FirstMip), std::max(1, data.Height >> data.FirstMip),
+                                                       texture.m_channels, data.Compression, data.MipCount - data.FirstMip);
+
+        Log::Trace("Texture uploaded to GPU -> {0} ({1}x{2})", texture.GetUUID().Get(), texture.m_width, texture.m_height);
     }
 
     bool TextureImporter::CheckIfIsImage(const char* path)
     {
-        ILenum type = ilDetermineType(path);
-        return type != IL_TYPE_UNKNOWN;
+        return ImageDecoder::CanDecode(path);
     }
 }
\ No newline at end of file
@@ -9,7 +9,7 @@
 
 namespace Loopie {
 
-	struct TextureImportSettigns : public ImportSettings {
+	struct TextureImportSettings : public ImportSettings {
 
 		enum class Format {
 			RGB,
@@ -33,14 +33,33 @@ namespace Loopie {
 		Format TextureFormat;
 		WrapMode TextureWrapMode;
 		FilterMode TextureFilterMode;
-		bool GenerateMipmaps;
+		bool GenerateMipmaps = true; // Built at import time, stored in the cache
 		bool ReadAndWrite;
+		bool CompressBlocks = true; // BC1, or BC3 when the image has transparency
 	};
 
 	class TextureImporter {
 	public:
-		static void ImportImage(const std::string& filepath, Metadata& metadata);
+		// Imports with a copy of the current settings, call it from the main thread
+		static void ImportImage(const std::string& filepath, Metadata& metadata, bool saveMetadata = true);
+		// Safe to call from several threads at once for different assets, as long as every job owns its
+		// settings copy. saveMetadata = false leaves writing the .meta file to the caller
+		static void ImportImage(const std::string& filepath, Metadata& metadata, const TextureImportSettings& settings, bool saveMetadata = true);
 		static void LoadImage(const std::string& filepath, Texture& texture);
+		// LoadImage in two steps. ReadImage reads and decompresses a .texture cache without touching
+		// GL so it can run on any thread, UploadImage creates the GL texture on the main thread.
+		// Only the levels from firstMip down are read, caches older than the level table read all of them.
+		static bool ReadImage(const std::filesystem::path& filepath, TextureData& data, unsigned int firstMip = 0);
+		// Size, format and mip count of a cache, no pixels. FirstMip is the smallest level ReadImage can start at
+		static bool ReadImageInfo(const std::filesystem::path& filepath, TextureData& data);
+		static void UploadImage(const TextureData& data, Texture& texture);
 		static bool CheckIfIsImage(const char* path);
+
+		// Used by every import from then on, existing caches keep their format until reimported
+		static void SetImportSettings(const TextureImportSettings& settings) { s_settings = settings; }
+		static const TextureImportSettings& GetImportSettings() { return s_settings; }
+
+	private:
+		static TextureImportSettings s_settings;
 	};
 }
\ No newline at end of file
@@ -51,6 +51,10 @@ namespace Loopie {
         return insideX && insideY && insideZ;
     }
 
+    bool AABB::Contains(const AABB& other) const {
+        return Contains(other.MinPoint) && Contains(other.MaxPoint);
+    }
+
     bool AABB::ContainsRay(const vec3& rayStart, const vec3& rayEnd) const
     {
         return Contains(rayStart) && Contains(rayEnd);
@@ -129,6 +133,20 @@ namespace Loopie {
         return false;
     }
 
+    bool AABB::IntersectsRay(const vec3& rayOrigin, const vec3& inverseDirection, float maxDistance, float& entryDistance) const
+    {
+        vec3 t1 = (MinPoint - rayOrigin) * inverseDirection;
+        vec3 t2 = (MaxPoint - rayOrigin) * inverseDirection;
+
+        vec3 tMin = glm::min(t1, t2);
+        vec3 tMax = glm::max(t1, t2);
+
+        float enterPoint = glm::max(glm::max(glm::max(tMin.x, tMin.y), tMin.z), 0.0f);
+        float exitPoint = glm::min(glm::min(glm::min(tMax.x, tMax.y), tMax.z), maxDistance);
+
+        entryDistance = enterPoint;
+        return enterPoint <= exitPoint;
+    }
 
     vec3 AABB::GetCenter() const {
         return (MinPoint + MaxPoint) * 0.5f;
@@ -146,6 +164,12 @@ namespace Loopie {
         vec3 size = GetSize();
         return size.x * size.y * size.z;
     }
+
+    float AABB::GetSurfaceArea() const {
+        vec3 size = GetSize();
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
     OBB AABB::ToOBB() const
     {
         OBB obb;
@@ -18,18 +18,22 @@ namespace Loopie{
         void Enclose(const vec3& point);
 
         bool Contains(const vec3& point) const;
+        bool Contains(const AABB& other) const;
         bool ContainsRay(const vec3& rayStart, const vec3& rayEnd) const;
 
         bool Intersects(const AABB& other) const;
         bool IntersectsSphere(const vec3& center, float radius) const;
         bool IntersectsRay(const vec3& rayStart, const vec3& rayEnd) const;
         bool IntersectsRay(const vec3& rayOrigin, const vec3& rayDirection, vec3& hitPoint) const;
+        // Slab test with a precomputed 1 / direction. entryDistance is 0 when the origin is inside
+        bool IntersectsRay(const vec3& rayOrigin, const vec3& inverseDirection, float maxDistance, float& entryDistance) const;
 
 
         vec3 GetCenter() const;
         vec3 GetExtents() const;
         vec3 GetSize() const;
         float GetVolume() const;
+        float GetSurfaceArea() const;
 
         OBB ToOBB() const;
         AABB Transform(const matrix4& localToWorld) const;
@@ -0,0 +1,62 @@
+#include "AABBArray.h"
+
+namespace Loopie {
+
+    void AABBArray::Resize(size_t size) {
+        MinX.resize(size);
+        MinY.resize(size);
+        MinZ.resize(size);
+        MaxX.resize(size);
+        MaxY.resize(size);
+        MaxZ.resize(size);
+    }
+
+    void AABBArray::Reserve(size_t size) {
+        MinX.reserve(size);
+        MinY.reserve(size);
+        MinZ.reserve(size);
+        MaxX.reserve(size);
+        MaxY.reserve(size);
+        MaxZ.reserve(size);
+    }
+
+    void AABBArray::Clear() {
+        MinX.clear();
+        MinY.clear();
+        MinZ.clear();
+        MaxX.clear();
+        MaxY.clear();
+        MaxZ.clear();
+    }
+
+    void AABBArray::Set(size_t index, const AABB& aabb) {
+        MinX[index] = aabb.MinPoint.x;
+        MinY[index] = aabb.MinPoint.y;
+        MinZ[index] = aabb.MinPoint.z;
+        MaxX[index] = aabb.MaxPoint.x;
+        MaxY[index] = aabb.MaxPoint.y;
+        MaxZ[index] = aabb.MaxPoint.z;
+    }
+
+    AABB AABBArray::Get(size_t index) const {
+        return AABB(vec3(MinX[index], MinY[index], MinZ[index]), vec3(MaxX[index], MaxY[index], MaxZ[index]));
+    }
+
+    void AABBArray::PushBack(const AABB& aabb) {
+        MinX.push_back(aabb.MinPoint.x);
+        MinY.push_back(aabb.MinPoint.y);
+        MinZ.push_back(aabb.MinPoint.z);
+        MaxX.push_back(aabb.MaxPoint.x);
+        MaxY.push_back(aabb.MaxPoint.y);
+        MaxZ.push_back(aabb.MaxPoint.z);
+    }
+
+    void AABBArray::CopyElement(size_t to, size_t from) {
+        MinX[to] = MinX[from];
+        MinY[to] = MinY[from];
+        MinZ[to] = MinZ[from];
+        MaxX[to] = MaxX[from];
+        MaxY[to] = MaxY[from];
+        MaxZ[to] = MaxZ[from];
+    }
+}
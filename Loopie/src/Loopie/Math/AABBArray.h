@@ -0,0 +1,27 @@
+#pragma once
+#include "Loopie/Math/AABB.h"
+
+#include <vector>
+
+namespace Loopie {
+
+    // Structure of arrays storage for AABBs, so batch tests can load several boxes per instruction
+    struct AABBArray {
+        std::vector<float> MinX;
+        std::vector<float> MinY;
+        std::vector<float> MinZ;
+        std::vector<float> MaxX;
+        std::vector<float> MaxY;
+        std::vector<float> MaxZ;
+
+        size_t Size() const { return MinX.size(); }
+        void Resize(size_t size);
+        void Reserve(size_t size);
+        void Clear();
+
+        void Set(size_t index, const AABB& aabb);
+        AABB Get(size_t index) const;
+        void PushBack(const AABB& aabb);
+        void CopyElement(size_t to, size_t from);
+    };
+}
@@ -0,0 +1,309 @@
+#include "BVH.h"
+#include "Loopie/Math/Ray.h"
+
+#include <algorithm>
+#include <utility>
+#include <istream>
+#include <ostream>
+
+namespace Loopie {
+
+    namespace {
+        vec3 GetPosition(const float* vertices, unsigned int vertexStride, unsigned int positionOffset, unsigned int vertexIndex) {
+            const float* position = vertices + vertexIndex * vertexStride + positionOffset;
+            return vec3(position[0], position[1], position[2]);
+        }
+
+        struct BVHBin {
+            AABB Bounds;
+            uint32_t Count = 0;
+        };
+    }
+
+    // *** Binned SAH build ***
+    // Every node tries BVH_SAH_BINS planes per axis over its centroid bounds and keeps the one
+    // with the lowest surface area cost. When no split beats keeping the triangles together
+    // (or all centroids are the same point) the node becomes a leaf, unless it is too big,
+    // in which case it is halved by triangle count.
+    void BVH::Build(const float* vertices, unsigned int vertexStride, unsigned int positionOffset,
+                    const unsigned int* indices, unsigned int indexCount) {
+        Clear();
+
+        uint32_t triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+            return;
+
+        std::vector<AABB> triangleBounds(triangleCount);
+        std::vector<vec3> centroids(triangleCount);
+        m_triangles.resize(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; i++) {
+            AABB bounds(GetPosition(vertices, vertexStride, positionOffset, indices[i * 3 + 0]));
+            bounds.Enclose(GetPosition(vertices, vertexStride, positionOffset, indices[i * 3 + 1]));
+            bounds.Enclose(GetPosition(vertices, vertexStride, positionOffset, indices[i * 3 + 2]));
+            triangleBounds[i] = bounds;
+            centroids[i] = bounds.GetCenter();
+            m_triangles[i] = i;
+        }
+
+        m_nodes.reserve(triangleCount * 2);
+        BVHNode root;
+        root.FirstIndex = 0;
+        root.Count = triangleCount;
+        m_nodes.push_back(root);
+
+        std::vector<std::pair<uint32_t, int>> pending; // Node index and depth
+        pending.push_back({ 0, 0 });
+
+        while (!pending.empty()) {
+            uint32_t nodeIndex = pending.back().first;
+            int depth = pending.back().second;
+            pending.pop_back();
+
+            uint32_t first = m_nodes[nodeIndex].FirstIndex;
+            uint32_t count = m_nodes[nodeIndex].Count;
+
+            AABB bounds;
+            AABB centroidBounds;
+            bounds.SetNegativeInfinity();
+            centroidBounds.SetNegativeInfinity();
+            for (uint32_t i = first; i < first + count; i++) {
+                bounds.Enclose(triangleBounds[m_triangles[i]]);
+                centroidBounds.Enclose(centroids[m_triangles[i]]);
+            }
+            m_nodes[nodeIndex].Bounds = bounds;
+
+            if (count <= 2 || depth >= BVH_MAXIMUM_DEPTH)
+                continue;
+
+            int bestAxis = -1;
+            int bestSplit = 0;
+            float bestCost = count * bounds.GetSurfaceArea();
+            vec3 centroidExtent = centroidBounds.GetSize();
+
+            for (int axis = 0; axis < 3; axis++) {
+                if (centroidExtent[axis] <= 0.0f)
+                    continue;
+
+                BVHBin bins[BVH_SAH_BINS];
+                for (BVHBin& bin : bins)
+                    bin.Bounds.SetNegativeInfinity();
+
+                float scale = BVH_SAH_BINS / centroidExtent[axis];
+                for (uint32_t i = first; i < first + count; i++) {
+                    uint32_t triangle = m_triangles[i];
+                    int bin = std::min(BVH_SAH_BINS - 1, (int)((centroids[triangle][axis] - centroidBounds.MinPoint[axis]) * scale));
+                    bins[bin].Count++;
+                    bins[bin].Bounds.Enclose(triangleBounds[triangle]);
+                }
+
+                // Sweep from both sides to get the cost of every plane between bins
+                float leftArea[BVH_SAH_BINS - 1];
+                uint32_t leftCount[BVH_SAH_BINS - 1];
+                AABB accumulated;
+                accumulated.SetNegativeInfinity();
+                uint32_t accumulatedCount = 0;
+                for (int i = 0; i < BVH_SAH_BINS - 1; i++) {
+                    accumulatedCount += bins[i].Count;
+                    if (bins[i].Count > 0)
+                        accumulated.Enclose(bins[i].Bounds);
+                    leftCount[i] = accumulatedCount;
+                    leftArea[i] = accumulatedCount > 0 ? accumulated.GetSurfaceArea() : 0.0f;
+                }
+
+                accumulated.SetNegativeInfinity();
+                accumulatedCount = 0;
+                for (int i = BVH_SAH_BINS - 1; i > 0; i--) {
+                    accumulatedCount += bins[i].Count;
+                    if (bins[i].Count > 0)
+                        accumulated.Enclose(bins[i].Bounds);
+                    if (leftCount[i - 1] == 0 || accumulatedCount == 0)
+                        continue;
+
+                    float cost = leftCount[i - 1] * leftArea[i - 1] + accumulatedCount * accumulated.GetSurfaceArea();
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            uint32_t middle;
+            if (bestAxis >= 0) {
+                float scale = BVH_SAH_BINS / centroidExtent[bestAxis];
+                float axisMin = centroidBounds.MinPoint[bestAxis];
+                uint32_t* splitPoint = std::partition(m_triangles.data() + first, m_triangles.data() + first + count,
+                    [&](uint32_t triangle) {
+                        int bin = std::min(BVH_SAH_BINS - 1, (int)((centroids[triangle][bestAxis] - axisMin) * scale));
+                        return bin < bestSplit;
+                    });
+                middle = static_cast<uint32_t>(splitPoint - m_triangles.data());
+            }
+            else if (count > BVH_MAX_LEAF_TRIANGLES) {
+                middle = first + count / 2;
+            }
+            else {
+                continue;
+            }
+
+            uint32_t leftIndex = static_cast<uint32_t>(m_nodes.size());
+            BVHNode left;
+            left.FirstIndex = first;
+            left.Count = middle - first;
+            BVHNode right;
+            right.FirstIndex = middle;
+            right.Count = first + count - middle;
+            m_nodes.push_back(left);
+            m_nodes.push_back(right);
+
+            m_nodes[nodeIndex].FirstIndex = leftIndex;
+            m_nodes[nodeIndex].Count = 0;
+
+            pending.push_back({ leftIndex, depth + 1 });
+            pending.push_back({ leftIndex + 1, depth + 1 });
+        }
+
+        m_nodes.shrink_to_fit();
+    }
+
+    void BVH::Clear() {
+        m_nodes.clear();
+        m_triangles.clear();
+    }
+
+    bool BVH::Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance,
+                      const float* vertices, unsigned int vertexStride, unsigned int positionOffset, const unsigned int* indices,
+                      float& distance, unsigned int& triangleIndex, vec2& barycentric) const {
+        if (m_nodes.empty())
+            return false;
+
+        vec3 inverseDirection = 1.0f / rayDirection;
+        float closest = maxDistance;
+        bool hit = false;
+
+        float entry;
+        if (!m_nodes[0].Bounds.IntersectsRay(rayOrigin, inverseDirection, closest, entry))
+            return false;
+
+        uint32_t stack[BVH_TRAVERSAL_STACK_SIZE];
+        float entryDistances[BVH_TRAVERSAL_STACK_SIZE];
+        int stackSize = 0;
+        stack[stackSize] = 0;
+        entryDistances[stackSize++] = entry;
+
+        while (stackSize > 0) {
+            --stackSize;
+            if (entryDistances[stackSize] > closest)
+                continue;
+
+            const BVHNode& node = m_nodes[stack[stackSize]];
+            if (node.IsLeaf()) {
+                for (uint32_t i = node.FirstIndex; i < node.FirstIndex + node.Count; i++) {
+                    uint32_t triangle = m_triangles[i];
+                    float t, u, v;
+                    if (!Ray::IntersectsTriangle(rayOrigin, rayDirection,
+                                                 GetPosition(vertices, vertexStride, positionOffset, indices[triangle * 3 + 0]),
+                                                 GetPosition(vertices, vertexStride, positionOffset, indices[triangle * 3 + 1]),
+                                                 GetPosition(vertices, vertexStride, positionOffset, indices[triangle * 3 + 2]), t, u, v))
+                        continue;
+
+                    if (t < closest) {
+                        closest = t;
+                        triangleIndex = triangle;
+                        barycentric = vec2(u, v);
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // Push the farther child first so the nearer one is visited next
+            float leftEntry, rightEntry;
+            bool hitLeft = m_nodes[node.FirstIndex].Bounds.IntersectsRay(rayOrigin, inverseDirection, closest, leftEntry);
+            bool hitRight = m_nodes[node.FirstIndex + 1].Bounds.IntersectsRay(rayOrigin, inverseDirection, closest, rightEntry);
+
+            if (hitLeft && hitRight) {
+                bool leftFirst = leftEntry <= rightEntry;
+                stack[stackSize] = leftFirst ? node.FirstIndex + 1 : node.FirstIndex;
+                entryDistances[stackSize++] = leftFirst ? rightEntry : leftEntry;
+                stack[stackSize] = leftFirst ? node.FirstIndex : node.FirstIndex + 1;
+                entryDistances[stackSize++] = leftFirst ? leftEntry : rightEntry;
+            }
+            else if (hitLeft) {
+                stack[stackSize] = node.FirstIndex;
+                entryDistances[stackSize++] = leftEntry;
+            }
+            else if (hitRight) {
+                stack[stackSize] = node.FirstIndex + 1;
+                entryDistances[stackSize++] = rightEntry;
+            }
+        }
+
+        if (hit)
+            distance = closest;
+        return hit;
+    }
+
+    // *** .mesh block ***
+    // nodeCount, then per node min, max, FirstIndex and Count, then the triangle ids.
+    // Fields are written one by one so the layout doesn't depend on struct padding.
+    void BVH::Write(std::ostream& stream) const {
+        uint32_t nodeCount = static_cast<uint32_t>(m_nodes.size());
+        stream.write(reinterpret_cast<const char*>(&nodeCount), sizeof(nodeCount));
+        for (const BVHNode& node : m_nodes) {
+            stream.write(reinterpret_cast<const char*>(&node.Bounds.MinPoint), sizeof(node.Bounds.MinPoint));
+            stream.write(reinterpret_cast<const char*>(&node.Bounds.MaxPoint), sizeof(node.Bounds.MaxPoint));
+            stream.write(reinterpret_cast<const char*>(&node.FirstIndex), sizeof(node.FirstIndex));
+            stream.write(reinterpret_cast<const char*>(&node.Count), sizeof(node.Count));
+        }
+
+        uint32_t triangleCount = static_cast<uint32_t>(m_triangles.size());
+        stream.write(reinterpret_cast<const char*>(&triangleCount), sizeof(triangleCount));
+        stream.write(reinterpret_cast<const char*>(m_triangles.data()), triangleCount * sizeof(uint32_t));
+    }
+
+    bool BVH::Read(std::istream& stream, unsigned int triangleCount) {
+        Clear();
+
+        uint32_t nodeCount = 0;
+        if (!stream.read(reinterpret_cast<char*>(&nodeCount), sizeof(nodeCount)) || nodeCount == 0 || nodeCount > triangleCount * 2)
+            return false;
+
+        m_nodes.resize(nodeCount);
+        for (BVHNode& node : m_nodes) {
+            stream.read(reinterpret_cast<char*>(&node.Bounds.MinPoint), sizeof(node.Bounds.MinPoint));
+            stream.read(reinterpret_cast<char*>(&node.Bounds.MaxPoint), sizeof(node.Bounds.MaxPoint));
+            stream.read(reinterpret_cast<char*>(&node.FirstIndex), sizeof(node.FirstIndex));
+            stream.read(reinterpret_cast<char*>(&node.Count), sizeof(node.Count));
+        }
+
+        uint32_t storedTriangles = 0;
+        stream.read(reinterpret_cast<char*>(&storedTriangles), sizeof(storedTriangles));
+        if (!stream || storedTriangles != triangleCount) {
+            Clear();
+            return false;
+        }
+
+        m_triangles.resize(storedTriangles);
+        if (!stream.read(reinterpret_cast<char*>(m_triangles.data()), storedTriangles * sizeof(uint32_t))) {
+            Clear();
+            return false;
+        }
+
+        // A stale or truncated cache must not send the traversal out of bounds
+        for (const BVHNode& node : m_nodes) {
+            bool valid = node.IsLeaf() ? node.FirstIndex + node.Count <= storedTriangles : node.FirstIndex + 1 < nodeCount;
+            if (!valid) {
+                Clear();
+                return false;
+            }
+        }
+        for (uint32_t triangle : m_triangles) {
+            if (triangle >= storedTriangles) {
+                Clear();
+                return false;
+            }
+        }
+        return true;
+    }
+}
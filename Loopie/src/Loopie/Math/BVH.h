@@ -0,0 +1,49 @@
+#pragma once
+#include "Loopie/Math/AABB.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace Loopie {
+
+    constexpr uint32_t BVH_MAX_LEAF_TRIANGLES = 4;
+    constexpr int BVH_SAH_BINS = 12;
+    constexpr int BVH_MAXIMUM_DEPTH = 48; // Deeper nodes become leaves, so traversal can use a fixed stack
+    constexpr int BVH_TRAVERSAL_STACK_SIZE = BVH_MAXIMUM_DEPTH + 2;
+
+    // Leaves hold Count triangles starting at FirstIndex of BVH::m_triangles.
+    // Inner nodes have Count == 0 and their two children at FirstIndex and FirstIndex + 1.
+    struct BVHNode {
+        AABB Bounds;
+        uint32_t FirstIndex = 0;
+        uint32_t Count = 0;
+
+        bool IsLeaf() const { return Count > 0; }
+    };
+
+    // Triangle bounding volume hierarchy built in mesh space with a binned SAH builder.
+    // It only stores triangle ids, the vertex and index data stay in the mesh.
+    class BVH {
+    public:
+        // positionOffset and vertexStride are counted in floats
+        void Build(const float* vertices, unsigned int vertexStride, unsigned int positionOffset,
+                   const unsigned int* indices, unsigned int indexCount);
+        void Clear();
+        bool IsEmpty() const { return m_nodes.empty(); }
+
+        // Closest triangle along the ray, distance is measured in lengths of rayDirection
+        bool Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance,
+                     const float* vertices, unsigned int vertexStride, unsigned int positionOffset, const unsigned int* indices,
+                     float& distance, unsigned int& triangleIndex, vec2& barycentric) const;
+
+        void Write(std::ostream& stream) const;
+        bool Read(std::istream& stream, unsigned int triangleCount);
+
+        size_t GetNodeCount() const { return m_nodes.size(); }
+
+    private:
+        std::vector<BVHNode> m_nodes; // m_nodes[0] is the root
+        std::vector<uint32_t> m_triangles;
+    };
+}
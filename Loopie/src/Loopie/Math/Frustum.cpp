@@ -1,4 +1,7 @@
 #include "Frustum.h"
+#include "Loopie/Math/SIMD.h"
+
+#include <cstring>
 
 namespace Loopie {
 
@@ -40,6 +43,138 @@ namespace Loopie {
         return true;
 	}
 
+    FrustumContainment Frustum::Classify(const AABB& box, uint8_t& planeMask, uint8_t& lastRejectingPlane) const {
+        const vec3& min = box.MinPoint;
+        const vec3& max = box.MaxPoint;
+
+        for (int i = 0; i < 6; i++) {
+            // Start with the plane that rejected this box last time, it most likely still does
+            int p = (lastRejectingPlane + i) % 6;
+            if (!(planeMask & (1 << p)))
+                continue;
+
+            const Plane& plane = Planes[p];
+
+            vec3 positive;
+            positive.x = (plane.Normal.x >= 0) ? max.x : min.x;
+            positive.y = (plane.Normal.y >= 0) ? max.y : min.y;
+            positive.z = (plane.Normal.z >= 0) ? max.z : min.z;
+
+            if (plane.DistanceToPoint(positive) < 0.0f) {
+                lastRejectingPlane = static_cast<uint8_t>(p);
+                return FrustumContainment::Outside;
+            }
+
+            vec3 negative;
+            negative.x = (plane.Normal.x >= 0) ? min.x : max.x;
+            negative.y = (plane.Normal.y >= 0) ? min.y : max.y;
+            negative.z = (plane.Normal.z >= 0) ? min.z : max.z;
+
+            // Fully on the inner side, children don't need to test this plane again
+            if (plane.DistanceToPoint(negative) >= 0.0f)
+                planeMask &= ~(1 << p);
+        }
+        return planeMask == 0 ? FrustumContainment::Inside : FrustumContainment::Intersecting;
+    }
+
+    // *** Batch culling ***
+    // Same p-vertex test as Intersects(const AABB&), but the boxes come as separate
+    // min/max arrays. The normal of a plane is the same for every box, so the p-vertex
+    // is just picking the min or max array per axis and the loop body is a plain
+    // multiply-add over several boxes at once.
+    void Frustum::Intersects(const AABBArray& boxes, size_t first, size_t count, uint32_t* visibilityMask, uint8_t planeMask) const {
+        std::memset(visibilityMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+
+        int activePlanes[6];
+        int activeCount = 0;
+        for (int p = 0; p < 6; p++) {
+            if (planeMask & (1 << p))
+                activePlanes[activeCount++] = p;
+        }
+
+        const float* px[6];
+        const float* py[6];
+        const float* pz[6];
+        for (int p = 0; p < 6; p++) {
+            const vec3& normal = Planes[p].Normal;
+            px[p] = (normal.x >= 0 ? boxes.MaxX.data() : boxes.MinX.data()) + first;
+            py[p] = (normal.y >= 0 ? boxes.MaxY.data() : boxes.MinY.data()) + first;
+            pz[p] = (normal.z >= 0 ? boxes.MaxZ.data() : boxes.MinZ.data()) + first;
+        }
+
+        size_t i = 0;
+
+#if defined(LOOPIE_SIMD_AVX2)
+        __m256 nx8[6], ny8[6], nz8[6], d8[6];
+        for (int p = 0; p < 6; p++) {
+            nx8[p] = _mm256_set1_ps(Planes[p].Normal.x);
+            ny8[p] = _mm256_set1_ps(Planes[p].Normal.y);
+            nz8[p] = _mm256_set1_ps(Planes[p].Normal.z);
+            d8[p] = _mm256_set1_ps(Planes[p].Distance);
+        }
+        const __m256 zero8 = _mm256_setzero_ps();
+
+        for (; i + 8 <= count; i += 8) {
+            __m256 outside = zero8;
+            for (int a = 0; a < activeCount; a++) {
+                int p = activePlanes[a];
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx8[p], _mm256_loadu_ps(px[p] + i)), _mm256_mul_ps(ny8[p], _mm256_loadu_ps(py[p] + i)));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(nz8[p], _mm256_loadu_ps(pz[p] + i)));
+                distance = _mm256_add_ps(distance, d8[p]);
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, zero8, _CMP_LT_OQ));
+            }
+            uint32_t visible = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+            visibilityMask[i >> 5] |= visible << (i & 31);
+        }
+#endif
+
+#if defined(LOOPIE_SIMD_SSE2)
+        __m128 nx4[6], ny4[6], nz4[6], d4[6];
+        for (int p = 0; p < 6; p++) {
+            nx4[p] = _mm_set1_ps(Planes[p].Normal.x);
+            ny4[p] = _mm_set1_ps(Planes[p].Normal.y);
+            nz4[p] = _mm_set1_ps(Planes[p].Normal.z);
+            d4[p] = _mm_set1_ps(Planes[p].Distance);
+        }
+        const __m128 zero4 = _mm_setzero_ps();
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 outside = zero4;
+            for (int a = 0; a < activeCount; a++) {
+                int p = activePlanes[a];
+                __m128 distance = _mm_add_ps(_mm_mul_ps(nx4[p], _mm_loadu_ps(px[p] + i)), _mm_mul_ps(ny4[p], _mm_loadu_ps(py[p] + i)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(nz4[p], _mm_loadu_ps(pz[p] + i)));
+                distance = _mm_add_ps(distance, d4[p]);
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero4));
+            }
+            uint32_t visible = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+            visibilityMask[i >> 5] |= visible << (i & 31);
+        }
+#endif
+
+        // Remaining boxes (or everything when there is no SIMD support)
+        for (; i < count; i++) {
+            bool visible = true;
+            for (int a = 0; a < activeCount && visible; a++) {
+                int p = activePlanes[a];
+                const Plane& plane = Planes[p];
+                float distance = plane.Normal.x * px[p][i] + plane.Normal.y * py[p][i] + plane.Normal.z * pz[p][i] + plane.Distance;
+                visible = distance >= 0.0f;
+            }
+            if (visible)
+                visibilityMask[i >> 5] |= 1u << (i & 31);
+        }
+    }
+
+    void Frustum::IntersectsScalar(const AABBArray& boxes, size_t first, size_t count, uint32_t* visibilityMask) const {
+        std::memset(visibilityMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+
+        for (size_t i = 0; i < count; i++) {
+            if (Intersects(boxes.Get(first + i)))
+                visibilityMask[i >> 5] |= 1u << (i & 31);
+        }
+    }
+
 	bool Frustum::Intersects(const OBB& box) const{
         const auto& corners = box.GetCorners();
 
@@ -2,6 +2,9 @@
 #include "Loopie/Math/MathTypes.h"
 #include "Loopie/Math/AABB.h"
 #include "Loopie/Math/OBB.h"
+#include "Loopie/Math/AABBArray.h"
+
+#include <cstdint>
 
 namespace Loopie {
 
@@ -13,6 +16,14 @@ namespace Loopie {
         void Normalize();
     };
 
+    constexpr uint8_t FRUSTUM_ALL_PLANES = 0x3F; // One bit per plane, used as plane mask
+
+    enum class FrustumContainment {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
     struct Frustum {
         Plane Planes[6];
 
@@ -32,6 +43,17 @@ namespace Loopie {
         bool Intersects(const AABB& box) const;
         bool Intersects(const OBB& box) const;
 
+        // Tests the box only against the planes set in planeMask, starting with lastRejectingPlane.
+        // On return planeMask only keeps the planes the box straddles (0 means fully inside),
+        // and lastRejectingPlane holds the plane that culled the box when it is Outside.
+        FrustumContainment Classify(const AABB& box, uint8_t& planeMask, uint8_t& lastRejectingPlane) const;
+
+        // Batch version of Intersects(const AABB&) for boxes [first, first + count).
+        // Bit i of visibilityMask is set when box first + i is visible, it needs (count + 31) / 32 words.
+        // Only the planes in planeMask are tested. Uses AVX2 or SSE2 when available.
+        void Intersects(const AABBArray& boxes, size_t first, size_t count, uint32_t* visibilityMask, uint8_t planeMask = FRUSTUM_ALL_PLANES) const;
+        void IntersectsScalar(const AABBArray& boxes, size_t first, size_t count, uint32_t* visibilityMask) const;
+
         void FromMatrix(const matrix4& viewProjectionMatrix);
 
         vec3 IntersectPlanes(const Plane& p1, const Plane& p2, const Plane& p3) const;
@@ -8,55 +8,150 @@
 #include "Loopie/Render/Colors.h"
 #include "Loopie/Render/Gizmo.h"
 
+#include <algorithm>
+
 
 namespace Loopie
 {
+	namespace
+	{
+		// Compaction only pays off once a good part of the packed array is holes
+		constexpr uint32_t MIN_WASTED_SLOTS_TO_COMPACT = 256;
+		constexpr uint32_t MIN_NODE_CAPACITY = 4;
+	}
+
 	// *** World Bounds as a constructor *** - PSS 14/12/2025
 	// Scene holds DEFAULT_WORLD_BOUNDS which holds the bounds for the world
 	// Keep in mind - it should be best to avoid the exact center, otherwise
 	// if we place things at height 0, it will collide with all quadrants.
 	Octree::Octree(const AABB& rootBounds)
 	{
-		m_rootNode = std::make_unique<OctreeNode>(rootBounds);
+		ResetNodes(rootBounds);
+	}
+
+	Octree::~Octree()
+	{
+		UntrackAllEntities();
+	}
+
+	void OctreeEntityRecord::OnNotify(const TransformNotification& type)
+	{
+		bool boundsChanged = type == TransformNotification::OnDirty || type == TransformNotification::OnBoundsChanged;
+		if (boundsChanged && Owner && TrackedEntity)
+		{
+			Owner->MarkDirty(TrackedEntity->shared_from_this());
+		}
 	}
 
 	// *** Steps of Insert *** - PSS 14/12/2025
-	// 1. From the root node it goes downwards and inspects the node's children's AABB
-	//    and does a test with the Entity's AABB.
-	//    If there's a collision, it does this recursively with that child.
-	//    If multiple children collide with that entity's AABB, the parent keeps the entity and 
-	//    we stop recursion.
-	// 2. If you run out of Bucket Space and you are a leaf, subdivide node
-	//	  into 8 child nodes and add them in the parent node's list.
-	// 3. Redistribute all GameObjects to proper childs based on their
-	//    position in space.
+	// 1. The entity's AABB is turned into the location code of the deepest cell
+	//    that fully contains it. If it would straddle several children of a node,
+	//    that node keeps the entity.
+	// 2. From the root we follow the octants of that code until we reach the cell
+	//    or a leaf.
+	// 3. If you run out of Bucket Space and you are a leaf, subdivide node
+	//	  into 8 child nodes and redistribute all GameObjects to proper childs
+	//    based on their location code.
 	// 4. If it reaches maximum depth, stop subdividing and add the object in
 	//    the list of entities of the node even we are over max entities (8) capacity.
 	void Octree::Insert(std::shared_ptr<Entity> entity)
 	{
+		OctreeEntityRecord& record = TrackEntity(entity);
+		if (record.Node != OCTREE_INVALID_INDEX)
+		{
+			Relocate(entity, record);
+			return;
+		}
+
 		AABB entityAABB = GetEntityAABB(entity);
-		InsertRecursively(m_rootNode.get(), entity, entityAABB, 0);
+		record.LocationCode = ComputeLocationCode(entityAABB);
+		InsertFromNode(0, entity, record, entityAABB);
 	}
 
 	void Octree::Remove(std::shared_ptr<Entity> entity)
 	{
-		AABB entityAABB = GetEntityAABB(entity);
-		RemoveRecursively(m_rootNode.get(), entity, entityAABB);
+		RemoveFromDirtyQueue(entity);
+
+		auto it = m_entityRecords.find(entity.get());
+		if (it == m_entityRecords.end())
+		{
+			return;
+		}
+
+		OctreeEntityRecord& record = it->second;
+		if (record.Node != OCTREE_INVALID_INDEX)
+		{
+			RemoveEntityFromNode(record);
+		}
+		if (record.ObservedTransform)
+		{
+			record.ObservedTransform->m_transformNotifier.RemoveObserver(&record);
+		}
+		m_entityRecords.erase(it);
 	}
 
-	// This can be optimized if it's too slow
 	void Octree::Update(std::shared_ptr<Entity> entity)
 	{
-		Remove(entity);
-		Insert(entity);
+		auto it = m_entityRecords.find(entity.get());
+		if (it == m_entityRecords.end() || it->second.Node == OCTREE_INVALID_INDEX)
+		{
+			Insert(entity);
+			return;
+		}
+		Relocate(entity, it->second);
 	}
 
-	void Octree::Clear()
+	// *** Incremental maintenance ***
+	// Instead of rebuilding the whole tree each time an entity is created or moves,
+	// entities are queued here and reconciled once per frame (Scene::Update) or when
+	// a batch ends (Scene::EndBatch). Tracked entities queue themselves when their
+	// transform notifies OnDirty. Queuing the same entity twice is a no-op.
+	void Octree::MarkDirty(std::shared_ptr<Entity> entity)
 	{
-		if (m_rootNode)
+		if (!entity)
 		{
-			m_rootNode.reset();
+			return;
 		}
+
+		if (m_dirtyLookup.insert(entity.get()).second)
+		{
+			m_dirtyEntities.push_back(entity);
+		}
+	}
+
+	void Octree::ProcessDirtyEntities()
+	{
+		if (m_dirtyEntities.empty())
+		{
+			return;
+		}
+
+		std::vector<std::shared_ptr<Entity>> dirtyEntities = std::move(m_dirtyEntities);
+		m_dirtyEntities.clear();
+		m_dirtyLookup.clear();
+
+		for (auto& entity : dirtyEntities)
+		{
+			Update(entity);
+		}
+
+		if (m_wastedSlots >= MIN_WASTED_SLOTS_TO_COMPACT && m_wastedSlots * 2 >= m_entityHandles.size())
+		{
+			CompactEntities();
+		}
+	}
+
+	bool Octree::HasDirtyEntities() const
+	{
+		return !m_dirtyEntities.empty();
+	}
+
+	void Octree::Clear()
+	{
+		UntrackAllEntities();
+		m_dirtyEntities.clear();
+		m_dirtyLookup.clear();
+		ResetNodes(m_nodes[0].Bounds);
 	}
 
 	// *** How Rebuild works *** - PSS 14/12/2025
@@ -67,30 +162,41 @@ namespace Loopie
 	// for example after X frames, or if an internal node holds too many entities.
 	void Octree::Rebuild()
 	{
-		AABB rootBounds = m_rootNode->m_aabb;
-		//std::vector<std::shared_ptr<Entity>> allEntities;
-		std::unordered_set<std::shared_ptr<Entity>> allEntities;
-		CollectAllEntitiesFromNode(m_rootNode.get(), allEntities);
+		ProcessDirtyEntities();
 
-		Clear();
+		std::vector<std::shared_ptr<Entity>> allEntities = std::move(m_entityHandles);
+		allEntities.erase(std::remove(allEntities.begin(), allEntities.end(), nullptr), allEntities.end());
 
-		m_rootNode = std::make_unique<OctreeNode>(rootBounds);
-		m_rootNode->m_isLeaf = true;
+		// Entities stay tracked, only the nodes they live in are recreated
+		ResetNodes(m_nodes[0].Bounds);
 
 		for (auto& entity : allEntities)
 		{
-			Insert(entity);
+			OctreeEntityRecord& record = m_entityRecords[entity.get()];
+			record.Node = OCTREE_INVALID_INDEX;
+			record.Slot = OCTREE_INVALID_INDEX;
+			AABB entityAABB = GetEntityAABB(entity);
+			record.LocationCode = ComputeLocationCode(entityAABB);
+			InsertFromNode(0, entity, record, entityAABB);
 		}
 	}
 
 	// *** Debug Draw *** - PSS 14/12/2025
-	// This debug draws the whole Octree. We might consider doing optimizations, 
+	// This debug draws the whole Octree. We might consider doing optimizations,
 	// like frustrum, and expand it to debug from a certain Octree downwards
 	void Octree::DebugDraw(const vec4& color)
 	{
-		if (m_shouldDraw)
+		if (!m_shouldDraw)
 		{
-			DebugDrawRecursively(m_rootNode.get(), color, 0);
+			return;
+		}
+
+		for (const OctreeNode& node : m_nodes)
+		{
+			// If is Leaf and depth is greater than 3, then color is YELLOW
+			// The rest's is WHATEVER color contained within var color (normally GREEN)
+			const vec4& nodeColor = (node.IsLeaf() && node.Depth > 3) ? Color::YELLOW : color;
+			Gizmo::DrawCube(node.Bounds.MinPoint, node.Bounds.MaxPoint, nodeColor);
 		}
 	}
 
@@ -105,28 +211,59 @@ namespace Loopie
 		Log::Info("Internal Nodes = {0}", statistics.internalNodes);
 		Log::Info("Total Entities = {0}", statistics.totalEntities);
 		// The line below could be implemented with a few changes.
-		//Log::Info("Total Visible Entities = {0}", statistics.totalEntities); 
+		//Log::Info("Total Visible Entities = {0}", statistics.totalEntities);
 		Log::Info("Max Depth = {0}", statistics.maxDepth);
 		Log::Info("Min Entities Per Node = {0}", statistics.minEntitiesPerNode);
 		Log::Info("Max Entities Per Node = {0}", statistics.maxEntitiesPerNode);
 		Log::Info("Average Entities Per Node = {0}", statistics.averageEntitiesPerNode);
 		Log::Info("Empty Leaves = {0}", statistics.emptyNodes);
 		Log::Info("Overfilled Leaves = {0}", statistics.overfilledNodes);
+		Log::Info("Packed Entity Slots = {0} ({1} wasted)", m_entityHandles.size(), m_wastedSlots);
 	}
-	
+
 	void Octree::DebugPrintOctreeHierarchy()
 	{
 		Log::Info("==========================");
 		Log::Info("Printing Octree Hierarchy");
 		Log::Info("==========================");
-		
-		DebugPrintOctreeHierarchyRecursively(m_rootNode.get(), 0);
+
+		DebugPrintOctreeHierarchyRecursively(0);
 	}
 
 	OctreeStatistics Octree::GetStatistics() const
 	{
 		OctreeStatistics stats;
-		GatherStatisticsRecursively(m_rootNode.get(), stats, 0);
+
+		for (const OctreeNode& node : m_nodes)
+		{
+			stats.totalNodes++;
+			stats.maxDepth = std::max(stats.maxDepth, static_cast<int>(node.Depth));
+
+			int entityCount = static_cast<int>(node.EntityCount);
+			stats.totalEntities += entityCount;
+
+			stats.minEntitiesPerNode = std::min(stats.minEntitiesPerNode, entityCount);
+			stats.maxEntitiesPerNode = std::max(stats.maxEntitiesPerNode, entityCount);
+
+			if (entityCount == 0)
+			{
+				stats.emptyNodes++;
+			}
+
+			if (entityCount > MAX_ENTITIES_PER_NODE && node.Depth >= MAXIMUM_DEPTH)
+			{
+				stats.overfilledNodes++;
+			}
+
+			if (node.IsLeaf())
+			{
+				stats.leafNodes++;
+			}
+			else
+			{
+				stats.internalNodes++;
+			}
+		}
 
 		if (stats.leafNodes > 0)
 		{
@@ -139,514 +276,811 @@ namespace Loopie
 	// *** Variable rayHit does nothing at the moment *** - PSS 14/12/25
 	// I haven't programmed the rayhit to return any meaningful value at the moment or to do anything with it
 	// I will have to check on it at some point
-	void Octree::CollectIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection,
-												   std::unordered_set<std::shared_ptr<Entity>>& entities)
+	void Octree::VisitIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection, OctreeVisitor visitor, void* userData)
 	{
+		ProcessDirtyEntities();
+
 		vec3 rayHit;
-		CollectIntersectingObjectsWithRayRecursively(m_rootNode.get(), rayOrigin, rayDirection, rayHit, entities);
-	}
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
 
-	void Octree::CollectIntersectingObjectsWithAABB(const AABB& queryBox,
-													std::unordered_set<std::shared_ptr<Entity>>& entities)
-	{
-		CollectIntersectingObjectsWithAABBRecursively(m_rootNode.get(), queryBox, entities);
-	}
+		while (stackSize > 0)
+		{
+			const OctreeNode& node = m_nodes[stack[--stackSize]];
 
-	void Octree::CollectIntersectingObjectsWithSphere(const vec3& center, const float& radius,
-													  std::unordered_set<std::shared_ptr<Entity>>& entities)
-	{
-		CollectIntersectingObjectsWithSphereRecursively(m_rootNode.get(), center, radius, entities);
-	}
+			// Early exit - if the ray doesn't intersect with this node's AABB, skip it and its children.
+			if (node.SubtreeEntityCount == 0 || !node.Bounds.IntersectsRay(rayOrigin, rayDirection, rayHit))
+			{
+				continue;
+			}
 
-	void Octree::CollectVisibleEntitiesFrustum(const Frustum& frustum, 
-											   std::unordered_set<std::shared_ptr<Entity>>& visibleEntities)
-	{
-		CollectVisibleEntitiesFrustumRecursively(m_rootNode.get(), frustum, visibleEntities);
-	}
+			for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
+			{
+				if (m_entityBounds.Get(i).IntersectsRay(rayOrigin, rayDirection, rayHit))
+				{
+					visitor(m_entityHandles[i].get(), userData);
+				}
+			}
 
-	void Octree::CollectAllEntities(std::unordered_set<std::shared_ptr<Entity>>& entities)
-	{
-		CollectAllEntitiesFromNode(m_rootNode.get(), entities);
+			for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
+			{
+				if (node.ChildMask & (1 << i))
+				{
+					stack[stackSize++] = node.FirstChild + i;
+				}
+			}
+		}
 	}
 
-	void Octree::SetShouldDraw(bool value)
+	// *** Front to back raycast ***
+	// Children are pushed sorted by the distance at which the ray enters them, so the closest
+	// one is popped first. Once a hit is found, any node or entity the ray enters farther away
+	// than that hit can't hold a closer one and is skipped without testing its triangles.
+	bool Octree::Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance, RaycastHit& hit)
 	{
-		m_shouldDraw = value;
-	}
+		ProcessDirtyEntities();
 
-	void Octree::ToggleShouldDraw()
-	{
-		m_shouldDraw = !m_shouldDraw;
-	}
+		vec3 inverseDirection = 1.0f / rayDirection;
+		float closest = maxDistance;
+		bool found = false;
 
-	bool Octree::GetShouldDraw() const
-	{
-		return m_shouldDraw;
-	}
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		float entryDistances[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
 
-	AABB Octree::GetEntityAABB(const std::shared_ptr<Entity>& entity) const
-	{
-		auto meshRenderer = entity->GetComponent<MeshRenderer>();
-		if (meshRenderer)
+		float entry;
+		if (!m_nodes[0].Bounds.IntersectsRay(rayOrigin, inverseDirection, closest, entry))
 		{
-			return meshRenderer->GetWorldAABB();
-		}
-		else
-		{
-			vec3 entityPosition = entity->GetTransform()->GetPosition();
-			AABB aabb(entityPosition);
-			
-			return aabb;
-		}
-	}
-	
-	void Octree::InsertRecursively(OctreeNode* node, std::shared_ptr<Entity> entity, const AABB& entityAABB, int depth)
-	{
-		if (!node)
-		{
-			return;
+			return false;
 		}
+		stack[stackSize] = 0;
+		entryDistances[stackSize++] = entry;
 
-		// If the node is a leaf, add entity and check for entities and depth.
-		// If max capacity has reached and hasn't reached max depth, 
-		// it will subdivide the node and redistribute all entities.
-		if (node->m_isLeaf)
+		while (stackSize > 0)
 		{
-			node->m_entities.insert(entity);
+			--stackSize;
+			const OctreeNode& node = m_nodes[stack[stackSize]];
+			if (node.SubtreeEntityCount == 0 || entryDistances[stackSize] > closest)
+			{
+				continue;
+			}
 
-			if (node->m_entities.size() > MAX_ENTITIES_PER_NODE && depth < MAXIMUM_DEPTH)
+			for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
 			{
-				Subdivide(node);
-				RedistributeEntities(node, depth);
+				if (!m_entityBounds.Get(i).IntersectsRay(rayOrigin, inverseDirection, closest, entry))
+				{
+					continue;
+				}
+
+				const std::shared_ptr<Entity>& entity = m_entityHandles[i];
+				if (!entity->GetIsActive())
+				{
+					continue;
+				}
+
+				MeshRenderer* renderer = entity->GetComponent<MeshRenderer>();
+				if (!renderer || !renderer->GetIsActive())
+				{
+					continue;
+				}
+
+				float distance;
+				unsigned int triangleIndex;
+				vec2 barycentric;
+				if (renderer->Raycast(rayOrigin, rayDirection, closest, distance, triangleIndex, barycentric))
+				{
+					closest = distance;
+					found = true;
+					hit.HitEntity = entity;
+					hit.TriangleIndex = triangleIndex;
+					hit.Barycentric = barycentric;
+				}
 			}
-			return;
-		}
 
-		// If it entity intersects with multiple children, put entity on their parent node
-		int totalNodesIntersecting = 0;
-		int nodeNumberFound = -1;
+			if (node.IsLeaf())
+			{
+				continue;
+			}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
-		{
-			if (node->m_children[i] && node->m_children[i]->m_aabb.Intersects(entityAABB))
+			// Sort the children the ray enters by entry distance, farthest first so the nearest ends on top of the stack
+			uint32_t children[OCTREE_CHILD_COUNT];
+			float childEntries[OCTREE_CHILD_COUNT];
+			int childCount = 0;
+			for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 			{
-				totalNodesIntersecting++;
-				if (totalNodesIntersecting > 1)
+				if (!(node.ChildMask & (1 << i)) ||
+					!m_nodes[node.FirstChild + i].Bounds.IntersectsRay(rayOrigin, inverseDirection, closest, entry))
+				{
+					continue;
+				}
+
+				int j = childCount++;
+				for (; j > 0 && childEntries[j - 1] < entry; --j)
 				{
-					node->m_entities.insert(entity);
-					return;
+					children[j] = children[j - 1];
+					childEntries[j] = childEntries[j - 1];
 				}
-				nodeNumberFound = i;
+				children[j] = node.FirstChild + i;
+				childEntries[j] = entry;
 			}
-		}
 
-		// If found a node intersecting with entity and hasn't been inserted yet, 
-		// try to insert below that node
-		if (totalNodesIntersecting == 1)
-		{
-			InsertRecursively(node->m_children[nodeNumberFound].get(), entity, entityAABB, depth + 1);
+			for (int i = 0; i < childCount; ++i)
+			{
+				stack[stackSize] = children[i];
+				entryDistances[stackSize++] = childEntries[i];
+			}
 		}
-		else
+
+		if (found)
 		{
-			// No children intersect - store at this node (edge case)
-			node->m_entities.insert(entity);
+			hit.Distance = closest;
+			hit.Point = rayOrigin + rayDirection * closest;
 		}
+		return found;
 	}
 
-	void Octree::RemoveRecursively(OctreeNode* node, std::shared_ptr<Entity> entity, const AABB& entityAABB)
+	void Octree::VisitIntersectingObjectsWithAABB(const AABB& queryBox, OctreeVisitor visitor, void* userData)
 	{
-		if (!node)
-		{
-			return;
-		}
-		
-		// Early exit - if the entities' AABB doesn't intersect with this node's AABB, skip it and its children.
-		if (!entityAABB.Intersects(node->m_aabb))
-		{
-			return;
-		}
+		ProcessDirtyEntities();
 
-		auto it = node->m_entities.find(entity);
-		bool foundEntity = (it != node->m_entities.end());
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
 
-		if (foundEntity)
+		while (stackSize > 0)
 		{
-			node->m_entities.erase(entity);
-			return;
-		}
+			const OctreeNode& node = m_nodes[stack[--stackSize]];
 
-		int totalNodesIntersecting = 0;
-		int nodeNumberFound = -1;
+			// Early exit - if the queryBox' AABB doesn't intersect with this node's AABB, skip it and its children.
+			if (node.SubtreeEntityCount == 0 || !queryBox.Intersects(node.Bounds))
+			{
+				continue;
+			}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
-		{
-			if (node->m_children[i] && node->m_children[i]->m_aabb.Intersects(entityAABB))
+			for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
 			{
-				totalNodesIntersecting++;
-				nodeNumberFound = i;
+				if (m_entityBounds.Get(i).Intersects(queryBox))
+				{
+					visitor(m_entityHandles[i].get(), userData);
+				}
 			}
-		}
 
-		if (totalNodesIntersecting == 1)
-		{
-			RemoveRecursively(node->m_children[nodeNumberFound].get(), entity, entityAABB);
+			for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
+			{
+				if (node.ChildMask & (1 << i))
+				{
+					stack[stackSize++] = node.FirstChild + i;
+				}
+			}
 		}
 	}
 
-	void Octree::Subdivide(OctreeNode* node)
+	void Octree::VisitIntersectingObjectsWithSphere(const vec3& center, const float& radius, OctreeVisitor visitor, void* userData)
 	{
-		// Subdivide node into 8 different nodes
-		std::array<AABB, MAX_ENTITIES_PER_NODE> childAABBs = ComputeChildAABBs(node->m_aabb);
+		ProcessDirtyEntities();
+
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+		while (stackSize > 0)
 		{
-			node->m_children[i] = std::make_unique<OctreeNode>(childAABBs[i]);
-			node->m_children[i]->m_parent = node;
-			node->m_children[i]->m_isLeaf = true;
-		}
+			const OctreeNode& node = m_nodes[stack[--stackSize]];
 
-		node->m_isLeaf = false;
+			// Early exit - if the sphere doesn't intersect with this node's AABB, skip it and its children.
+			if (node.SubtreeEntityCount == 0 || !node.Bounds.IntersectsSphere(center, radius))
+			{
+				continue;
+			}
+
+			for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
+			{
+				if (m_entityBounds.Get(i).IntersectsSphere(center, radius))
+				{
+					visitor(m_entityHandles[i].get(), userData);
+				}
+			}
+
+			for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
+			{
+				if (node.ChildMask & (1 << i))
+				{
+					stack[stackSize++] = node.FirstChild + i;
+				}
+			}
+		}
 	}
 
-	void Octree::RedistributeEntities(OctreeNode* node, int depth)
+	// *** Hierarchical frustum culling ***
+	// Every stack entry carries the planes its node still straddles. A plane the parent is fully
+	// inside of can't cut any child, so children only test what is left of the mask, and once the
+	// mask is empty the whole subtree is accepted without any plane test.
+	void Octree::VisitVisibleEntitiesFrustum(const Frustum& frustum, OctreeVisitor visitor, void* userData, uint32_t cullingContext)
 	{
-		// Redistribute entities into those 8 different nodes
-		if (node->m_isLeaf)
-		{
-			return;
-		}
+		ProcessDirtyEntities();
+
+		const uint32_t context = cullingContext % OCTREE_CULLING_CONTEXT_COUNT;
 
-		std::unordered_set<std::shared_ptr<Entity>> entitiesToRedistribute = std::move(node->m_entities);
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		uint8_t planeMasks[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize] = 0;
+		planeMasks[stackSize++] = FRUSTUM_ALL_PLANES;
 
-		for (auto& entity : entitiesToRedistribute)
+		while (stackSize > 0)
 		{
-			AABB entityAABB = GetEntityAABB(entity);
+			--stackSize;
+			OctreeNode& node = m_nodes[stack[stackSize]];
+			uint8_t planeMask = planeMasks[stackSize];
 
+			if (node.SubtreeEntityCount == 0)
+			{
+				continue;
+			}
 
-			// If it entity intersects with multiple children, put entity on their parent node
-			int totalNodesIntersecting = 0;
-			int nodeNumberFound = -1;
+			// Early exit - if the node's AABB is outside one of the remaining planes, skip it and its children.
+			if (planeMask != 0 && frustum.Classify(node.Bounds, planeMask, node.LastRejectingPlane[context]) == FrustumContainment::Outside)
+			{
+				continue;
+			}
 
-			for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+			if (node.EntityCount > 0)
 			{
-				if (node->m_children[i] && node->m_children[i]->m_aabb.Intersects(entityAABB))
+				if (planeMask == 0)
 				{
-					totalNodesIntersecting++;
-					if (totalNodesIntersecting > 1)
+					for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
 					{
-						break;
+						visitor(m_entityHandles[i].get(), userData);
 					}
-					nodeNumberFound = i;
 				}
-			}
+				else
+				{
+					// Test the whole range at once, the boxes of a node are contiguous
+					m_visibilityMask.resize((node.EntityCount + 31) / 32);
+					frustum.Intersects(m_entityBounds, node.FirstEntity, node.EntityCount, m_visibilityMask.data(), planeMask);
 
-			if (totalNodesIntersecting > 1)
-			{
-				node->m_entities.insert(entity);
-			}
-			else if (totalNodesIntersecting == 1)
-			{
-				node->m_children[nodeNumberFound]->m_entities.insert(entity);
+					for (uint32_t i = 0; i < node.EntityCount; ++i)
+					{
+						if (m_visibilityMask[i >> 5] & (1u << (i & 31)))
+						{
+							visitor(m_entityHandles[node.FirstEntity + i].get(), userData);
+						}
+					}
+				}
 			}
-			else
+
+			for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 			{
-				// Intersects with no children (edge case) -> Parent keeps entity
-				node->m_entities.insert(entity);
+				if (node.ChildMask & (1 << i))
+				{
+					stack[stackSize] = node.FirstChild + i;
+					planeMasks[stackSize++] = planeMask;
+				}
 			}
 		}
+	}
 
-		// After redistribution, check each child if it needs further subdivision
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+	void Octree::VisitAllEntities(OctreeVisitor visitor, void* userData)
+	{
+		ProcessDirtyEntities();
+
+		for (const OctreeNode& node : m_nodes)
 		{
-			if (node->m_children[i] && node->m_children[i]->m_entities.size() > MAX_ENTITIES_PER_NODE
-				&& depth + 1 < MAXIMUM_DEPTH)
+			for (uint32_t i = node.FirstEntity; i < node.FirstEntity + node.EntityCount; ++i)
 			{
-				Subdivide(node->m_children[i].get());
-				RedistributeEntities(node->m_children[i].get(), depth + 1);
+				visitor(m_entityHandles[i].get(), userData);
 			}
 		}
 	}
 
-	std::array<AABB, MAX_ENTITIES_PER_NODE> Octree::ComputeChildAABBs(const AABB& parentAABB) const
+	// *** Collect wrappers ***
+	// Every query is written once as a Visit function, these only choose where results go.
+	// The vector versions append raw pointers and don't allocate once the vector has grown.
+	namespace
 	{
-		std::array<AABB, MAX_ENTITIES_PER_NODE> children;
-		vec3 center = parentAABB.GetCenter();
-		vec3 min = parentAABB.MinPoint;
-		vec3 max = parentAABB.MaxPoint;
-
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+		void AppendToVector(Entity* entity, void* userData)
 		{
-			// This generates all octants by using bit-wise operations
-			vec3 childMin, childMax;
-			childMin.x = (i & 1) ? center.x : min.x;
-			childMin.y = (i & 2) ? center.y : min.y;
-			childMin.z = (i & 4) ? center.z : min.z;
-			childMax.x = (i & 1) ? max.x : center.x;
-			childMax.y = (i & 2) ? max.y : center.y;
-			childMax.z = (i & 4) ? max.z : center.z;
+			static_cast<std::vector<Entity*>*>(userData)->push_back(entity);
+		}
 
-			AABB aabb(childMin, childMax);
-			children[i] = aabb;
+		void InsertIntoSet(Entity* entity, void* userData)
+		{
+			static_cast<std::unordered_set<std::shared_ptr<Entity>>*>(userData)->insert(entity->shared_from_this());
 		}
+	}
 
-		return children;
+	void Octree::CollectIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection, std::unordered_set<std::shared_ptr<Entity>>& entities)
+	{
+		VisitIntersectingObjectsWithRay(rayOrigin, rayDirection, InsertIntoSet, &entities);
 	}
 
-	void Octree::DebugDrawRecursively(OctreeNode* node, const vec4& color, int depth)
+	void Octree::CollectIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection, std::vector<Entity*>& entities)
 	{
-		if (!node)
-		{
-			return;
-		}
+		VisitIntersectingObjectsWithRay(rayOrigin, rayDirection, AppendToVector, &entities);
+	}
+
+	void Octree::CollectIntersectingObjectsWithAABB(const AABB& queryBox, std::unordered_set<std::shared_ptr<Entity>>& entities)
+	{
+		VisitIntersectingObjectsWithAABB(queryBox, InsertIntoSet, &entities);
+	}
+
+	void Octree::CollectIntersectingObjectsWithAABB(const AABB& queryBox, std::vector<Entity*>& entities)
+	{
+		VisitIntersectingObjectsWithAABB(queryBox, AppendToVector, &entities);
+	}
+
+	void Octree::CollectIntersectingObjectsWithSphere(const vec3& center, const float& radius, std::unordered_set<std::shared_ptr<Entity>>& entities)
+	{
+		VisitIntersectingObjectsWithSphere(center, radius, InsertIntoSet, &entities);
+	}
+
+	void Octree::CollectIntersectingObjectsWithSphere(const vec3& center, const float& radius, std::vector<Entity*>& entities)
+	{
+		VisitIntersectingObjectsWithSphere(center, radius, AppendToVector, &entities);
+	}
+
+	void Octree::CollectVisibleEntitiesFrustum(const Frustum& frustum, std::unordered_set<std::shared_ptr<Entity>>& visibleEntities, uint32_t cullingContext)
+	{
+		VisitVisibleEntitiesFrustum(frustum, InsertIntoSet, &visibleEntities, cullingContext);
+	}
+
+	void Octree::CollectVisibleEntitiesFrustum(const Frustum& frustum, std::vector<Entity*>& visibleEntities, uint32_t cullingContext)
+	{
+		VisitVisibleEntitiesFrustum(frustum, AppendToVector, &visibleEntities, cullingContext);
+	}
+
+	void Octree::CollectAllEntities(std::unordered_set<std::shared_ptr<Entity>>& entities)
+	{
+		VisitAllEntities(InsertIntoSet, &entities);
+	}
+
+	void Octree::CollectAllEntities(std::vector<Entity*>& entities)
+	{
+		VisitAllEntities(AppendToVector, &entities);
+	}
+
+	void Octree::SetShouldDraw(bool value)
+	{
+		m_shouldDraw = value;
+	}
+
+	void Octree::ToggleShouldDraw()
+	{
+		m_shouldDraw = !m_shouldDraw;
+	}
+
+	bool Octree::GetShouldDraw() const
+	{
+		return m_shouldDraw;
+	}
 
-		// If is Leaf and depth is greater than 3, then color is YELLOW
-		if (node->m_isLeaf && depth > 3)
+	// Only called when an entity is inserted or marked dirty, queries read m_entityBounds
+	AABB Octree::GetEntityAABB(const std::shared_ptr<Entity>& entity) const
+	{
+		auto meshRenderer = entity->GetComponent<MeshRenderer>();
+		if (meshRenderer)
 		{
-			Gizmo::DrawCube(node->m_aabb.MinPoint, node->m_aabb.MaxPoint, Color::YELLOW);
+			return meshRenderer->GetWorldAABB();
 		}
-		// The rest's is WHATEVER color contained within var color (normally GREEN)
 		else
 		{
-			Gizmo::DrawCube(node->m_aabb.MinPoint, node->m_aabb.MaxPoint, color);
-		}
+			vec3 entityPosition = entity->GetTransform()->GetPosition();
+			AABB aabb(entityPosition);
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
-		{			
-			if (node->m_children[i])
-			{
-				DebugDrawRecursively(node->m_children[i].get(), color, depth + 1);
-			}
+			return aabb;
 		}
 	}
 
-	void Octree::DebugPrintOctreeHierarchyRecursively(OctreeNode* node, int depth) const
+	// *** Location codes ***
+	// The root is split in a grid of 2^MAXIMUM_DEPTH cells per axis. The cells holding
+	// the min and max corners of the AABB are interleaved octant by octant and the
+	// common prefix is the deepest node that fully contains the AABB (a Morton code).
+	// Entities that are not fully inside the root stay in the root.
+	uint32_t Octree::ComputeLocationCode(const AABB& entityAABB) const
 	{
-		if (!node)
+		const AABB& rootBounds = m_nodes[0].Bounds;
+		if (!rootBounds.Contains(entityAABB))
 		{
-			return;
+			return 1;
 		}
-		Log::Info("Node depth = {0}. Entities in node = {1}", depth, node->m_entities.size());
 
-		if (node->m_isLeaf)
+		const int cellsPerAxis = 1 << MAXIMUM_DEPTH;
+		vec3 cellScale = vec3(static_cast<float>(cellsPerAxis)) / rootBounds.GetSize();
+		ivec3 minCell = glm::clamp(ivec3((entityAABB.MinPoint - rootBounds.MinPoint) * cellScale), ivec3(0), ivec3(cellsPerAxis - 1));
+		ivec3 maxCell = glm::clamp(ivec3((entityAABB.MaxPoint - rootBounds.MinPoint) * cellScale), ivec3(0), ivec3(cellsPerAxis - 1));
+
+		uint32_t locationCode = 1;
+		for (int depth = 0; depth < MAXIMUM_DEPTH; ++depth)
 		{
-			return;
+			int shift = MAXIMUM_DEPTH - 1 - depth;
+			uint32_t minOctant = ((minCell.x >> shift) & 1) | (((minCell.y >> shift) & 1) << 1) | (((minCell.z >> shift) & 1) << 2);
+			uint32_t maxOctant = ((maxCell.x >> shift) & 1) | (((maxCell.y >> shift) & 1) << 1) | (((maxCell.z >> shift) & 1) << 2);
+			if (minOctant != maxOctant)
+			{
+				break;
+			}
+			locationCode = (locationCode << 3) | minOctant;
 		}
+		return locationCode;
+	}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+	int Octree::GetLocationCodeDepth(uint32_t locationCode)
+	{
+		int depth = 0;
+		while (locationCode > 1)
 		{
-			DebugPrintOctreeHierarchyRecursively(node->m_children[i].get(), depth + 1);
+			locationCode >>= 3;
+			depth++;
 		}
+		return depth;
+	}
+
+	bool Octree::IsLocationCodePrefix(uint32_t prefix, uint32_t locationCode)
+	{
+		int prefixDepth = GetLocationCodeDepth(prefix);
+		int codeDepth = GetLocationCodeDepth(locationCode);
+		return codeDepth >= prefixDepth && (locationCode >> (3 * (codeDepth - prefixDepth))) == prefix;
 	}
 
-	void Octree::GatherStatisticsRecursively(OctreeNode* node, OctreeStatistics& stats, int depth) const
+	void Octree::InsertFromNode(uint32_t nodeIndex, const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record, const AABB& entityAABB)
 	{
-		if (!node)
+		int codeDepth = GetLocationCodeDepth(record.LocationCode);
+
+		// Follow the octants of the location code while the tree is deep enough
+		while (!m_nodes[nodeIndex].IsLeaf() && m_nodes[nodeIndex].Depth < codeDepth)
 		{
-			return;
+			const OctreeNode& node = m_nodes[nodeIndex];
+			uint32_t octant = (record.LocationCode >> (3 * (codeDepth - node.Depth - 1))) & 7;
+			nodeIndex = node.FirstChild + octant;
 		}
 
-		stats.totalNodes++;
-		stats.maxDepth = std::max(stats.maxDepth, depth);
+		AddEntityToNode(nodeIndex, entity, record, entityAABB);
 
-		int entityCount = static_cast<int>(node->m_entities.size());
-		stats.totalEntities += entityCount;
+		// If max capacity has reached and hasn't reached max depth,
+		// it will subdivide the node and redistribute all entities.
+		const OctreeNode& node = m_nodes[nodeIndex];
+		if (node.IsLeaf() && node.EntityCount > MAX_ENTITIES_PER_NODE && node.Depth < MAXIMUM_DEPTH)
+		{
+			Subdivide(nodeIndex);
+			RedistributeEntities(nodeIndex);
+		}
+	}
 
-		stats.minEntitiesPerNode = std::min(stats.minEntitiesPerNode, entityCount);
-		stats.maxEntitiesPerNode = std::max(stats.maxEntitiesPerNode, entityCount);
+	// *** Local relocation ***
+	// Moving entities usually stay close to where they were, so instead of
+	// removing and inserting from the root we walk up from the current node until
+	// its cell contains the new AABB and push the entity back down from there.
+	void Octree::Relocate(const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record)
+	{
+		AABB entityAABB = GetEntityAABB(entity);
+		uint32_t locationCode = ComputeLocationCode(entityAABB);
+		uint32_t nodeIndex = record.Node;
 
-		if (entityCount == 0)
+		// Still the same cell, only the cached bounds need refreshing
+		if (locationCode == record.LocationCode)
 		{
-			stats.emptyNodes++;
+			m_entityBounds.Set(record.Slot, entityAABB);
+			return;
 		}
 
-		if (entityCount > MAX_ENTITIES_PER_NODE && depth >= MAXIMUM_DEPTH)
+		RemoveEntityFromNode(record);
+		record.LocationCode = locationCode;
+
+		while (m_nodes[nodeIndex].Parent != OCTREE_INVALID_INDEX && !IsLocationCodePrefix(m_nodes[nodeIndex].LocationCode, locationCode))
 		{
-			stats.overfilledNodes++;
+			nodeIndex = m_nodes[nodeIndex].Parent;
 		}
 
-		if (node->m_isLeaf)
+		InsertFromNode(nodeIndex, entity, record, entityAABB);
+	}
+
+	void Octree::AddEntityToNode(uint32_t nodeIndex, const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record, const AABB& entityAABB)
+	{
+		if (m_nodes[nodeIndex].EntityCount == m_nodes[nodeIndex].EntityCapacity)
 		{
-			stats.leafNodes++;
+			GrowNodeRange(nodeIndex);
 		}
-		else
-		{
-			stats.internalNodes++;
 
-			for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
-			{
-				if (node->m_children[i])
-				{
-					GatherStatisticsRecursively(node->m_children[i].get(), stats, depth + 1);
-				}
-			}
-		}
+		OctreeNode& node = m_nodes[nodeIndex];
+		uint32_t slot = node.FirstEntity + node.EntityCount;
+		m_entityHandles[slot] = entity;
+		m_entityBounds.Set(slot, entityAABB);
+		m_slotRecords[slot] = &record;
+		node.EntityCount++;
+
+		record.Node = nodeIndex;
+		record.Slot = slot;
+
+		UpdateSubtreeCounts(nodeIndex, 1);
 	}
 
-	void Octree::CollectAllEntitiesFromNode(OctreeNode* node, std::unordered_set<std::shared_ptr<Entity>>& entities)
+	void Octree::RemoveEntityFromNode(OctreeEntityRecord& record)
 	{
-		if (!node)
+		uint32_t nodeIndex = record.Node;
+		OctreeNode& node = m_nodes[nodeIndex];
+		uint32_t lastSlot = node.FirstEntity + node.EntityCount - 1;
+
+		// Swap with the last entity of the range to keep it packed
+		if (record.Slot != lastSlot)
 		{
-			return;
+			m_entityHandles[record.Slot] = std::move(m_entityHandles[lastSlot]);
+			m_entityBounds.CopyElement(record.Slot, lastSlot);
+			m_slotRecords[record.Slot] = m_slotRecords[lastSlot];
+			m_slotRecords[record.Slot]->Slot = record.Slot;
 		}
+		m_entityHandles[lastSlot].reset();
+		m_slotRecords[lastSlot] = nullptr;
+		node.EntityCount--;
+
+		record.Node = OCTREE_INVALID_INDEX;
+		record.Slot = OCTREE_INVALID_INDEX;
+
+		UpdateSubtreeCounts(nodeIndex, -1);
+	}
+
+	// A full range is moved to the end of the packed array with twice the capacity.
+	// The slots it leaves behind are reclaimed by CompactEntities.
+	void Octree::GrowNodeRange(uint32_t nodeIndex)
+	{
+		OctreeNode& node = m_nodes[nodeIndex];
+		uint32_t newCapacity = std::max(MIN_NODE_CAPACITY, node.EntityCapacity * 2);
+		uint32_t newFirst = static_cast<uint32_t>(m_entityHandles.size());
+
+		m_entityHandles.resize(newFirst + newCapacity);
+		m_entityBounds.Resize(newFirst + newCapacity);
+		m_slotRecords.resize(newFirst + newCapacity, nullptr);
 
-		for (const auto& entity : node->m_entities)
+		for (uint32_t i = 0; i < node.EntityCount; ++i)
 		{
-			entities.insert(entity);
+			uint32_t oldSlot = node.FirstEntity + i;
+			m_entityHandles[newFirst + i] = std::move(m_entityHandles[oldSlot]);
+			m_entityBounds.CopyElement(newFirst + i, oldSlot);
+			m_slotRecords[newFirst + i] = m_slotRecords[oldSlot];
+			m_slotRecords[newFirst + i]->Slot = newFirst + i;
+			m_slotRecords[oldSlot] = nullptr;
 		}
 
-		if (!node->m_isLeaf)
+		m_wastedSlots += node.EntityCapacity;
+		node.FirstEntity = newFirst;
+		node.EntityCapacity = newCapacity;
+	}
+
+	void Octree::UpdateSubtreeCounts(uint32_t nodeIndex, int delta)
+	{
+		while (nodeIndex != OCTREE_INVALID_INDEX)
 		{
-			for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+			OctreeNode& node = m_nodes[nodeIndex];
+			node.SubtreeEntityCount += delta;
+
+			if (node.Parent != OCTREE_INVALID_INDEX)
 			{
-				if (node->m_children[i])
+				uint8_t octantBit = static_cast<uint8_t>(1 << (node.LocationCode & 7));
+				OctreeNode& parent = m_nodes[node.Parent];
+				if (node.SubtreeEntityCount > 0)
 				{
-					CollectAllEntitiesFromNode(node->m_children[i].get(), entities);
+					parent.ChildMask |= octantBit;
+				}
+				else
+				{
+					parent.ChildMask &= ~octantBit;
 				}
 			}
+			nodeIndex = node.Parent;
 		}
 	}
 
-	void Octree::CollectIntersectingObjectsWithRayRecursively(OctreeNode* node, vec3 rayOrigin, vec3 rayDirection, vec3& rayHit,
-															  std::unordered_set<std::shared_ptr<Entity>>& entities)
+	// Repacks every node range depth first, so the entities of a subtree end up
+	// next to each other in memory and the holes left by GrowNodeRange disappear.
+	void Octree::CompactEntities()
 	{
-		if (!node)
+		std::vector<std::shared_ptr<Entity>> handles;
+		AABBArray bounds;
+		std::vector<OctreeEntityRecord*> records;
+		handles.reserve(m_entityRecords.size() + m_nodes.size());
+		bounds.Reserve(m_entityRecords.size() + m_nodes.size());
+		records.reserve(m_entityRecords.size() + m_nodes.size());
+
+		uint32_t stack[OCTREE_QUERY_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
 		{
-			return;
-		}
-
-		// Early exit - if the ray doesn't intersect with this node's AABB, skip it and its children.
-		if (!node->m_aabb.IntersectsRay(rayOrigin, rayDirection, rayHit))
-		{
-			return;
-		}
+			OctreeNode& node = m_nodes[stack[--stackSize]];
+			uint32_t newFirst = static_cast<uint32_t>(handles.size());
+			uint32_t newCapacity = node.EntityCount > 0 ? std::max(MIN_NODE_CAPACITY, node.EntityCount) : 0;
 
-		for (const auto& entity : node->m_entities)
-		{
-			if (GetEntityAABB(entity).IntersectsRay(rayOrigin, rayDirection, rayHit))
+			for (uint32_t i = 0; i < node.EntityCount; ++i)
 			{
-				entities.insert(entity);
+				OctreeEntityRecord* record = m_slotRecords[node.FirstEntity + i];
+				record->Slot = newFirst + i;
+				handles.push_back(std::move(m_entityHandles[node.FirstEntity + i]));
+				bounds.PushBack(m_entityBounds.Get(node.FirstEntity + i));
+				records.push_back(record);
 			}
-		}
+			handles.resize(newFirst + newCapacity);
+			bounds.Resize(newFirst + newCapacity);
+			records.resize(newFirst + newCapacity, nullptr);
 
-		if (node->m_isLeaf)
-		{
-			return;
-		}
+			node.FirstEntity = newFirst;
+			node.EntityCapacity = newCapacity;
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
-		{
-			if (node->m_children[i])
+			if (node.IsLeaf())
+			{
+				continue;
+			}
+
+			// Pushed in reverse so children are packed in octant order
+			for (int i = OCTREE_CHILD_COUNT - 1; i >= 0; --i)
 			{
-				CollectIntersectingObjectsWithRayRecursively(node->m_children[i].get(), rayOrigin, rayDirection, rayHit, entities);
+				stack[stackSize++] = node.FirstChild + i;
 			}
 		}
+
+		m_entityHandles = std::move(handles);
+		m_entityBounds = std::move(bounds);
+		m_slotRecords = std::move(records);
+		m_wastedSlots = 0;
 	}
 
-	void Octree::CollectIntersectingObjectsWithAABBRecursively(OctreeNode* node, const AABB& queryBox,
-																std::unordered_set<std::shared_ptr<Entity>>& entities)
+	OctreeEntityRecord& Octree::TrackEntity(const std::shared_ptr<Entity>& entity)
 	{
-		if (!node)
+		auto [it, inserted] = m_entityRecords.try_emplace(entity.get());
+		OctreeEntityRecord& record = it->second;
+		if (inserted)
 		{
-			return;
-		}
-
-		// Early exit - if the queryBox' AABB doesn't intersect with this node's AABB, skip it and its children.
-		if (!queryBox.Intersects(node->m_aabb))
-		{
-			return;
+			record.Owner = this;
+			record.TrackedEntity = entity.get();
+			record.ObservedTransform = entity->GetTransform();
+			if (record.ObservedTransform)
+			{
+				record.ObservedTransform->m_transformNotifier.AddObserver(&record);
+			}
 		}
+		return record;
+	}
 
-		for (const auto& entity : node->m_entities)
+	void Octree::UntrackAllEntities()
+	{
+		for (auto& [entity, record] : m_entityRecords)
 		{
-			if (GetEntityAABB(entity).Intersects(queryBox))
+			if (record.ObservedTransform)
 			{
-				entities.insert(entity);
+				record.ObservedTransform->m_transformNotifier.RemoveObserver(&record);
 			}
 		}
+		m_entityRecords.clear();
+	}
 
-		if (node->m_isLeaf)
+	void Octree::RemoveFromDirtyQueue(const std::shared_ptr<Entity>& entity)
+	{
+		if (m_dirtyLookup.erase(entity.get()) == 0)
 		{
 			return;
 		}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+		auto it = std::find(m_dirtyEntities.begin(), m_dirtyEntities.end(), entity);
+		if (it != m_dirtyEntities.end())
 		{
-			if (node->m_children[i])
-			{
-				CollectIntersectingObjectsWithAABBRecursively(node->m_children[i].get(), queryBox, entities);
-			}
+			*it = std::move(m_dirtyEntities.back());
+			m_dirtyEntities.pop_back();
 		}
 	}
 
-	void Octree::CollectIntersectingObjectsWithSphereRecursively(OctreeNode* node, const vec3& center, const float& radius,
-																 std::unordered_set<std::shared_ptr<Entity>>& entities)
+	void Octree::ResetNodes(const AABB& rootBounds)
+	{
+		m_nodes.clear();
+		m_entityHandles.clear();
+		m_entityBounds.Clear();
+		m_slotRecords.clear();
+		m_wastedSlots = 0;
+
+		OctreeNode root;
+		root.Bounds = rootBounds;
+		m_nodes.push_back(root);
+	}
+
+	void Octree::Subdivide(uint32_t nodeIndex)
 	{
-		if (!node)
+		// Subdivide node into 8 different nodes, stored next to each other
+		std::array<AABB, OCTREE_CHILD_COUNT> childAABBs = ComputeChildAABBs(m_nodes[nodeIndex].Bounds);
+		uint32_t firstChild = static_cast<uint32_t>(m_nodes.size());
+
+		for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 		{
-			return;
+			OctreeNode child;
+			child.Bounds = childAABBs[i];
+			child.LocationCode = (m_nodes[nodeIndex].LocationCode << 3) | static_cast<uint32_t>(i);
+			child.Parent = nodeIndex;
+			child.Depth = m_nodes[nodeIndex].Depth + 1;
+			m_nodes.push_back(child);
 		}
 
-		// Early exit - if the sphere doesn't intersect with this node's AABB, skip it and its children.
-		if (!node->m_aabb.IntersectsSphere(center, radius))
+		m_nodes[nodeIndex].FirstChild = firstChild;
+	}
+
+	void Octree::RedistributeEntities(uint32_t nodeIndex)
+	{
+		// Redistribute entities into those 8 different nodes
+		if (m_nodes[nodeIndex].IsLeaf())
 		{
 			return;
 		}
 
-		for (const auto& entity : node->m_entities)
+		// Entities straddling several children stay here, the rest go one level down
+		int nodeDepth = m_nodes[nodeIndex].Depth;
+		std::vector<OctreeEntityRecord*> entitiesToRedistribute;
+		for (uint32_t i = 0; i < m_nodes[nodeIndex].EntityCount; ++i)
 		{
-			if (GetEntityAABB(entity).IntersectsSphere(center, radius))
+			OctreeEntityRecord* record = m_slotRecords[m_nodes[nodeIndex].FirstEntity + i];
+			if (GetLocationCodeDepth(record->LocationCode) > nodeDepth)
 			{
-				entities.insert(entity);
+				entitiesToRedistribute.push_back(record);
 			}
 		}
 
-		if (node->m_isLeaf)
+		for (OctreeEntityRecord* record : entitiesToRedistribute)
 		{
-			return;
+			std::shared_ptr<Entity> entity = m_entityHandles[record->Slot];
+			AABB entityAABB = m_entityBounds.Get(record->Slot);
+			int codeDepth = GetLocationCodeDepth(record->LocationCode);
+			uint32_t octant = (record->LocationCode >> (3 * (codeDepth - nodeDepth - 1))) & 7;
+
+			RemoveEntityFromNode(*record);
+			AddEntityToNode(m_nodes[nodeIndex].FirstChild + octant, entity, *record, entityAABB);
 		}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+		// After redistribution, check each child if it needs further subdivision
+		for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 		{
-			if (node->m_children[i])
+			uint32_t childIndex = m_nodes[nodeIndex].FirstChild + i;
+			if (m_nodes[childIndex].EntityCount > MAX_ENTITIES_PER_NODE && m_nodes[childIndex].Depth < MAXIMUM_DEPTH)
 			{
-				CollectIntersectingObjectsWithSphereRecursively(node->m_children[i].get(), center, radius, entities);
+				Subdivide(childIndex);
+				RedistributeEntities(childIndex);
 			}
 		}
 	}
 
-	void Octree::CollectVisibleEntitiesFrustumRecursively(OctreeNode* node, const Frustum& frustum,
-														  std::unordered_set<std::shared_ptr<Entity>>& visibleEntities)
+	std::array<AABB, OCTREE_CHILD_COUNT> Octree::ComputeChildAABBs(const AABB& parentAABB) const
 	{
-		if (!node)
-		{
-			return;
-		}
+		std::array<AABB, OCTREE_CHILD_COUNT> children;
+		vec3 center = parentAABB.GetCenter();
+		vec3 min = parentAABB.MinPoint;
+		vec3 max = parentAABB.MaxPoint;
 
-		// Early exit - if the frustum' AABB doesn't intersect with this node's AABB, skip it and its children.
-		if (!frustum.Intersects(node->m_aabb))
+		for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 		{
-			return;
-		}
+			// This generates all octants by using bit-wise operations
+			vec3 childMin, childMax;
+			childMin.x = (i & 1) ? center.x : min.x;
+			childMin.y = (i & 2) ? center.y : min.y;
+			childMin.z = (i & 4) ? center.z : min.z;
+			childMax.x = (i & 1) ? max.x : center.x;
+			childMax.y = (i & 2) ? max.y : center.y;
+			childMax.z = (i & 4) ? max.z : center.z;
 
-		for (const auto& entity : node->m_entities)
-		{
-			if (frustum.Intersects(GetEntityAABB(entity)))
-			{
-				visibleEntities.insert(entity);
-			}
+			AABB aabb(childMin, childMax);
+			children[i] = aabb;
 		}
 
-		if (node->m_isLeaf)
+		return children;
+	}
+
+	void Octree::DebugPrintOctreeHierarchyRecursively(uint32_t nodeIndex) const
+	{
+		const OctreeNode& node = m_nodes[nodeIndex];
+		Log::Info("Node depth = {0}. Entities in node = {1}", node.Depth, node.EntityCount);
+
+		if (node.IsLeaf())
 		{
 			return;
 		}
 
-		for (int i = 0; i < MAX_ENTITIES_PER_NODE; ++i)
+		for (int i = 0; i < OCTREE_CHILD_COUNT; ++i)
 		{
-			if (node->m_children[i])
-			{
-				CollectVisibleEntitiesFrustumRecursively(node->m_children[i].get(), frustum, visibleEntities);
-			}
+			DebugPrintOctreeHierarchyRecursively(node.FirstChild + i);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,16 +1,42 @@
 #pragma once
 #include "Loopie/Math/OctreeNode.h"
+#include "Loopie/Math/AABBArray.h"
+#include "Loopie/Events/IObserver.h"
+#include "Loopie/Events/EventTypes.h"
 
 #include <memory>
 #include <array>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <climits>
 
 
 namespace Loopie {
-	constexpr int MAXIMUM_DEPTH = 5; // Can be modified as necessary
+	constexpr int MAXIMUM_DEPTH = 5; // Can be modified as necessary (LocationCode needs 3 bits per level)
+	// Worst case of pending nodes in a depth first traversal: 7 siblings per level plus the children of the last one
+	constexpr int OCTREE_QUERY_STACK_SIZE = MAXIMUM_DEPTH * (OCTREE_CHILD_COUNT - 1) + OCTREE_CHILD_COUNT;
 
 	class Entity;
+	class Transform;
+	class Octree;
 	struct Frustum;
 
+	// Back-pointer from an entity to the node and slot holding it. It also listens to the
+	// entity's transform so the octree knows when the entity has to be relocated.
+	struct OctreeEntityRecord : public IObserver<TransformNotification>
+	{
+		Octree* Owner = nullptr;
+		Entity* TrackedEntity = nullptr;
+		Transform* ObservedTransform = nullptr;
+		uint32_t Node = OCTREE_INVALID_INDEX;
+		uint32_t Slot = OCTREE_INVALID_INDEX;
+		uint32_t LocationCode = 1; // Deepest cell that fully contains the entity's AABB
+
+		// Queues the entity when it moves or its bounds change
+		void OnNotify(const TransformNotification& type) override;
+	};
+
 	struct OctreeStatistics
 	{
 		int totalNodes = 0;
@@ -26,6 +52,19 @@ namespace Loopie {
 		int overfilledNodes = 0; // Leaves exceeding MAX_ENTITIES_PER_NODE at max depth
 	};
 
+	// Called by the Octree::Visit* queries for every entity found, userData is passed through untouched
+	using OctreeVisitor = void(*)(Entity* entity, void* userData);
+
+	// Closest surface hit returned by Octree::Raycast
+	struct RaycastHit
+	{
+		std::shared_ptr<Entity> HitEntity;
+		unsigned int TriangleIndex = 0;
+		float Distance = 0.0f;
+		vec3 Point = vec3(0);
+		vec2 Barycentric = vec2(0); // Weights of the triangle's second and third vertex
+	};
+
 	//template<typename T>
 	class Octree
 	{
@@ -36,30 +75,53 @@ namespace Loopie {
 
 	public:
 		Octree(const AABB& rootBounds);
-		~Octree() = default;
+		~Octree();
 
 		void Insert(std::shared_ptr<Entity> entity);
 		void Remove(std::shared_ptr<Entity> entity);
 		void Update(std::shared_ptr<Entity> entity);
+		void MarkDirty(std::shared_ptr<Entity> entity);
+		void ProcessDirtyEntities();
+		bool HasDirtyEntities() const;
 		void Clear();
 		void Rebuild();
 		void DebugDraw(const vec4& color);
 		void DebugPrintOctreeStatistics();
 		void DebugPrintOctreeHierarchy();
 		OctreeStatistics GetStatistics() const;
+		// *** Queries ***
+		// Visit* call the visitor once per entity found, nothing is allocated. Each entity lives in
+		// a single node so it is reported at most once. The vector overloads append raw pointers and
+		// can reuse the same vector every frame, the set overloads are kept for existing callers.
+		void VisitIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection, OctreeVisitor visitor, void* userData);
 		void CollectIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection,
 											   std::unordered_set<std::shared_ptr<Entity>>& entities);
+		void CollectIntersectingObjectsWithRay(vec3 rayOrigin, vec3 rayDirection, std::vector<Entity*>& entities);
 
+		// Nearest triangle hit along the ray, rayDirection must be normalized
+		bool Raycast(const vec3& rayOrigin, const vec3& rayDirection, float maxDistance, RaycastHit& hit);
+
+		void VisitIntersectingObjectsWithAABB(const AABB& queryBox, OctreeVisitor visitor, void* userData);
 		void CollectIntersectingObjectsWithAABB(const AABB& queryBox,
 												std::unordered_set<std::shared_ptr<Entity>>& entities);
+		void CollectIntersectingObjectsWithAABB(const AABB& queryBox, std::vector<Entity*>& entities);
 
+		void VisitIntersectingObjectsWithSphere(const vec3& center, const float& radius, OctreeVisitor visitor, void* userData);
 		void CollectIntersectingObjectsWithSphere(const vec3& center, const float& radius,
 												  std::unordered_set<std::shared_ptr<Entity>>& entities);
+		void CollectIntersectingObjectsWithSphere(const vec3& center, const float& radius, std::vector<Entity*>& entities);
 
-		void CollectVisibleEntitiesFrustum(const Frustum& frustum, 
-										   std::unordered_set<std::shared_ptr<Entity>>& visibleEntities);
+		// cullingContext picks the per node plane coherence slot, wrapped to OCTREE_CULLING_CONTEXT_COUNT.
+		// Pass Camera::GetCullingContext() so every camera keeps its own, sharing a slot only costs speed.
+		void VisitVisibleEntitiesFrustum(const Frustum& frustum, OctreeVisitor visitor, void* userData, uint32_t cullingContext = 0);
+		void CollectVisibleEntitiesFrustum(const Frustum& frustum,
+										   std::unordered_set<std::shared_ptr<Entity>>& visibleEntities, uint32_t cullingContext = 0);
+		void CollectVisibleEntitiesFrustum(const Frustum& frustum, std::vector<Entity*>& visibleEntities, uint32_t cullingContext = 0);
 
+		void VisitAllEntities(OctreeVisitor visitor, void* userData);
 		void CollectAllEntities(std::unordered_set<std::shared_ptr<Entity>>& entities);
+		void CollectAllEntities(std::vector<Entity*>& entities);
+
 		void SetShouldDraw(bool value);
 		void ToggleShouldDraw();
 		bool GetShouldDraw() const;
@@ -67,31 +129,37 @@ namespace Loopie {
 
 	private:
 		AABB GetEntityAABB(const std::shared_ptr<Entity>& entity) const;
-		void InsertRecursively(OctreeNode* node, std::shared_ptr<Entity> entity, const AABB& entityAABB, int depth);
-		void RemoveRecursively(OctreeNode* node, std::shared_ptr<Entity> entity, const AABB& entityAABB);
-		void Subdivide(OctreeNode* node);
-		void RedistributeEntities(OctreeNode* node, int depth);
-		std::array<AABB, MAX_ENTITIES_PER_NODE> ComputeChildAABBs(const AABB& parentAABB) const;
-		void DebugDrawRecursively(OctreeNode* node, const vec4& color, int depth);
-		void DebugPrintOctreeHierarchyRecursively(OctreeNode* node, int depth) const;
-		void GatherStatisticsRecursively(OctreeNode* node, OctreeStatistics& stats, int depth) const;
-
-		void CollectAllEntitiesFromNode(OctreeNode* node, std::unordered_set<std::shared_ptr<Entity>>& entities);
-
-		void CollectIntersectingObjectsWithRayRecursively(OctreeNode* node, vec3 rayOrigin, vec3 rayDirection, vec3& rayHit,
-														  std::unordered_set<std::shared_ptr<Entity>>& entities);
-
-		void CollectIntersectingObjectsWithAABBRecursively(OctreeNode* node, const AABB& queryBox,
-														   std::unordered_set<std::shared_ptr<Entity>>& entities);
-
-		void CollectIntersectingObjectsWithSphereRecursively(OctreeNode* node, const vec3& center, const float& radius,
-															 std::unordered_set<std::shared_ptr<Entity>>& entities);
-
-		void CollectVisibleEntitiesFrustumRecursively(OctreeNode* node, const Frustum& frustum,
-													  std::unordered_set<std::shared_ptr<Entity>>& visibleEntities);
+		uint32_t ComputeLocationCode(const AABB& entityAABB) const;
+		static int GetLocationCodeDepth(uint32_t locationCode);
+		static bool IsLocationCodePrefix(uint32_t prefix, uint32_t locationCode);
+
+		void InsertFromNode(uint32_t nodeIndex, const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record, const AABB& entityAABB);
+		void Relocate(const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record);
+		void AddEntityToNode(uint32_t nodeIndex, const std::shared_ptr<Entity>& entity, OctreeEntityRecord& record, const AABB& entityAABB);
+		void RemoveEntityFromNode(OctreeEntityRecord& record);
+		void GrowNodeRange(uint32_t nodeIndex);
+		void UpdateSubtreeCounts(uint32_t nodeIndex, int delta);
+		void CompactEntities();
+		OctreeEntityRecord& TrackEntity(const std::shared_ptr<Entity>& entity);
+		void UntrackAllEntities();
+		void RemoveFromDirtyQueue(const std::shared_ptr<Entity>& entity);
+		void ResetNodes(const AABB& rootBounds);
+		void Subdivide(uint32_t nodeIndex);
+		void RedistributeEntities(uint32_t nodeIndex);
+		std::array<AABB, OCTREE_CHILD_COUNT> ComputeChildAABBs(const AABB& parentAABB) const;
+		void DebugPrintOctreeHierarchyRecursively(uint32_t nodeIndex) const;
 
 	private:
-		std::unique_ptr<OctreeNode> m_rootNode;
+		std::vector<OctreeNode> m_nodes; // m_nodes[0] is the root
+		std::vector<std::shared_ptr<Entity>> m_entityHandles; // Packed entity ranges of every node
+		AABBArray m_entityBounds; // Cached world AABB of each slot of m_entityHandles, split per axis for batch culling
+		std::vector<OctreeEntityRecord*> m_slotRecords; // Record owning each slot of m_entityHandles
+		uint32_t m_wastedSlots = 0;
+		std::vector<uint32_t> m_visibilityMask; // Scratch bitmask for frustum batch tests
+
+		std::vector<std::shared_ptr<Entity>> m_dirtyEntities;
+		std::unordered_set<Entity*> m_dirtyLookup;
+		std::unordered_map<Entity*, OctreeEntityRecord> m_entityRecords;
 		bool m_shouldDraw = true;
 	};
-}
\ No newline at end of file
+}
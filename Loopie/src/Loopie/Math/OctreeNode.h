@@ -1,32 +1,40 @@
 #pragma once
 #include "Loopie/Math/AABB.h"
 
-#include <memory>
-#include <array>
-#include <unordered_set>
+#include <cstdint>
 
 namespace Loopie
 {
 	constexpr int MAX_ENTITIES_PER_NODE = 8;
+	constexpr int OCTREE_CHILD_COUNT = 8;
+	constexpr uint32_t OCTREE_INVALID_INDEX = UINT32_MAX;
+	constexpr uint32_t OCTREE_CULLING_CONTEXT_COUNT = 4; // Cameras culling the same tree without sharing plane coherence
 
-	class Entity;
-
-	class OctreeNode
+	// *** Linear octree node ***
+	// Nodes live contiguously in Octree::m_nodes and reference each other by index.
+	// The 8 children of a node are always allocated together, so a child is found at
+	// FirstChild + octant. LocationCode is the Morton code of the path from the root
+	// (3 bits per level) with a leading 1 as sentinel, so the root is 1.
+	// The entities of a node are the range [FirstEntity, FirstEntity + EntityCount)
+	// of the octree's packed entity array.
+	struct OctreeNode
 	{
-	friend class Octree;
-	public:
-		// explicit added to prevent accidental conversions
-		explicit OctreeNode(std::shared_ptr<Entity> entity);
-		explicit OctreeNode(const AABB& aabb);
-		~OctreeNode() = default;
+		AABB Bounds;
+		uint32_t LocationCode = 1;
+		uint32_t Parent = OCTREE_INVALID_INDEX;
+		uint32_t FirstChild = OCTREE_INVALID_INDEX;
+
+		uint32_t FirstEntity = 0;
+		uint32_t EntityCount = 0;
+		uint32_t EntityCapacity = 0;
+		uint32_t SubtreeEntityCount = 0; // Entities in this node and all its descendants
 
-	private:
-		AABB m_aabb;
-		//std::vector<std::shared_ptr<Entity>> m_entities = {};
-		std::unordered_set<std::shared_ptr<Entity>> m_entities;
+		uint8_t ChildMask = 0; // Bit i is set when child i holds entities in its subtree
+		uint8_t Depth = 0;
+		// Frustum plane that culled this node last time, tested first next frame. One per culling context,
+		// so cameras looking different ways don't keep overwriting each other's plane.
+		uint8_t LastRejectingPlane[OCTREE_CULLING_CONTEXT_COUNT] = {};
 
-		OctreeNode* m_parent = nullptr;
-		std::array<std::unique_ptr<OctreeNode>, MAX_ENTITIES_PER_NODE> m_children = {};
-		bool m_isLeaf = true;
+		bool IsLeaf() const { return FirstChild == OCTREE_INVALID_INDEX; }
 	};
-}
\ No newline at end of file
+}
@@ -34,6 +34,31 @@ namespace Loopie
         }
     }
 
+    bool Ray::IntersectsTriangle(const vec3& origin, const vec3& direction, const vec3& v0, const vec3& v1, const vec3& v2,
+                                 float& distance, float& u, float& v)
+    {
+        vec3 edge1 = v1 - v0;
+        vec3 edge2 = v2 - v0;
+        vec3 p = cross(direction, edge2);
+        float det = dot(edge1, p);
+        if (fabs(det) < Math::EPSILON * Math::EPSILON)
+            return false;
+
+        float invDet = 1.0f / det;
+        vec3 s = origin - v0;
+        u = dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        vec3 q = cross(s, edge1);
+        v = dot(direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        distance = dot(edge2, q) * invDet;
+        return distance >= 0.0f;
+    }
+
     bool Ray::IntersectsLine(const vec3 lineStart, const vec3 lineEnd, vec3& intersectionPoint, bool only_hits_segment)
     {
         vec3 ldir = lineEnd - lineStart;
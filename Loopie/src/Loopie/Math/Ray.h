@@ -13,6 +13,11 @@ namespace Loopie
 		vec3 EndPoint() { return endPoint; }
 		vec3 Direction() { return direction; }
         bool Intersects(const std::vector<vec3>& vertex, bool bounded_by_vertex, vec3& intersection_point);
+
+		// Moller-Trumbore ray vs triangle, both faces. distance is measured in lengths of direction,
+		// u and v are the barycentric weights of v1 and v2 at the hit point
+		static bool IntersectsTriangle(const vec3& origin, const vec3& direction, const vec3& v0, const vec3& v1, const vec3& v2,
+									   float& distance, float& u, float& v);
 	private:
 		bool IntersectsLine(const vec3 lineStart, const vec3 lineEnd, vec3& intersectionPoint, bool only_hits_segment = false);
 		bool IntersectsPlane(const std::vector<vec3>& vertex_array, vec3& intersectionPoint, bool only_hits_polygon = false);
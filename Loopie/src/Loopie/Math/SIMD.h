@@ -0,0 +1,18 @@
+#pragma once
+
+// Vector instruction sets available at compile time.
+// AVX2 paths are only built when the compiler targets it (LOOPIE_ENABLE_AVX2 in CMake),
+// SSE2 is always available on x64.
+#if defined(__AVX2__)
+	#define LOOPIE_SIMD_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define LOOPIE_SIMD_SSE2
+#endif
+
+#if defined(LOOPIE_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(LOOPIE_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
@@ -12,7 +12,11 @@ namespace Loopie {
 		BOOL,
 		MATRIX2,
 		MATRIX3,
-		MATRIX4
+		MATRIX4,
+		HALF_FLOAT,
+		SHORT,
+		UNSIGNED_BYTE,
+		INT_2_10_10_10_REV // x, y, z and w packed in 32 bits, always used with a count of 4
 	};
 
 	static unsigned int GetGLVariableSize(GLVariableType type) {
@@ -20,7 +24,12 @@ namespace Loopie {
 			case GLVariableType::INT:
 			case GLVariableType::FLOAT:
 				return 4;
+			case GLVariableType::HALF_FLOAT:
+			case GLVariableType::SHORT:
+				return 2;
 			case GLVariableType::BOOL:
+			case GLVariableType::UNSIGNED_BYTE:
+			case GLVariableType::INT_2_10_10_10_REV: // Per component
 				return 1;
 			case GLVariableType::MATRIX2:
 				return 16;
@@ -41,9 +50,10 @@ namespace Loopie {
 		GLVariableType Type;
 		unsigned int Count;
 		unsigned int Offset;
+		bool Normalized; // Integer types are read by the shader as [0, 1] (unsigned) or [-1, 1] (signed) floats
 
-		BufferElement(unsigned int Index, unsigned int Offset, const GLVariableType& Type, unsigned int Count)
-			: Index(Index), Offset(Offset), Type(Type), Count(Count)
+		BufferElement(unsigned int Index, unsigned int Offset, const GLVariableType& Type, unsigned int Count, bool Normalized = false)
+			: Index(Index), Offset(Offset), Type(Type), Count(Count), Normalized(Normalized)
 		{
 
 		}
@@ -52,8 +62,8 @@ namespace Loopie {
 	class BufferLayout {
 	public:
 
-		void AddLayoutElement(unsigned int index,GLVariableType type, unsigned int count, const std::string& name) {
-			m_layout.emplace_back(BufferElement{ index, m_stride, type, count });
+		void AddLayoutElement(unsigned int index,GLVariableType type, unsigned int count, const std::string& name, bool normalized = false) {
+			m_layout.emplace_back(BufferElement{ index, m_stride, type, count, normalized });
 			m_stride+=GetGLVariableSize(type)*count;
 		}
 
@@ -11,6 +11,17 @@ namespace Loopie
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
         Unbind();
         m_count = count;
+        m_indexType = GL_UNSIGNED_INT;
+    }
+
+    IndexBuffer::IndexBuffer(const unsigned short* data, unsigned int count)
+    {
+        glGenBuffers(1, &m_rendererID);
+        Bind();
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned short), data, GL_STATIC_DRAW);
+        Unbind();
+        m_count = count;
+        m_indexType = GL_UNSIGNED_SHORT;
     }
 
     IndexBuffer::~IndexBuffer()
@@ -7,9 +7,11 @@ namespace Loopie
     private:
         unsigned int m_rendererID = 0;
         unsigned int m_count = 0;
+        unsigned int m_indexType = 0; // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
 
     public:
         IndexBuffer(const unsigned int* data, unsigned int count);
+        IndexBuffer(const unsigned short* data, unsigned int count);
         ~IndexBuffer();
 
         void Bind() const;
@@ -17,6 +19,8 @@ namespace Loopie
         void Unbind() const;
 
         unsigned int GetCount() const;
+        // Type to pass to glDrawElements
+        unsigned int GetIndexType() const { return m_indexType; }
         unsigned int GetRendererID()const { return m_rendererID; }
     };
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "RenderSort.h"
+
+#include <cstring>
+#include <utility>
+
+namespace Loopie {
+	static constexpr uint64_t FieldMask(uint32_t bits) { return (uint64_t(1) << bits) - 1; }
+
+	// SOLID layout shifts
+	static constexpr uint32_t SOLID_DEPTH_SHIFT = 0;
+	static constexpr uint32_t SOLID_VERTEX_ARRAY_SHIFT = SOLID_DEPTH_SHIFT + RenderSort::DEPTH_BITS;
+	static constexpr uint32_t SOLID_MATERIAL_SHIFT = SOLID_VERTEX_ARRAY_SHIFT + RenderSort::VERTEX_ARRAY_BITS;
+	static constexpr uint32_t SOLID_SHADER_SHIFT = SOLID_MATERIAL_SHIFT + RenderSort::MATERIAL_BITS;
+
+	// BLENDED layout shifts
+	static constexpr uint32_t BLENDED_VERTEX_ARRAY_SHIFT = 0;
+	static constexpr uint32_t BLENDED_MATERIAL_SHIFT = BLENDED_VERTEX_ARRAY_SHIFT + RenderSort::VERTEX_ARRAY_BITS;
+	static constexpr uint32_t BLENDED_SHADER_SHIFT = BLENDED_MATERIAL_SHIFT + RenderSort::MATERIAL_BITS;
+	static constexpr uint32_t BLENDED_DEPTH_SHIFT = BLENDED_SHADER_SHIFT + RenderSort::SHADER_BITS;
+
+	static constexpr uint32_t PASS_SHIFT = 64 - RenderSort::PASS_BITS;
+	static_assert(SOLID_SHADER_SHIFT + RenderSort::SHADER_BITS == PASS_SHIFT, "Sort key fields must fill 64 bits");
+	static_assert(BLENDED_DEPTH_SHIFT + RenderSort::DEPTH_BITS == PASS_SHIFT, "Sort key fields must fill 64 bits");
+
+	uint64_t RenderSort::MakeKey(RenderPass pass, uint32_t shaderId, uint32_t materialId, uint32_t vertexArrayId, float viewDepth)
+	{
+		uint64_t key = uint64_t(pass) << PASS_SHIFT;
+		uint64_t depth = QuantizeDepth(viewDepth);
+		uint64_t shader = shaderId & FieldMask(SHADER_BITS);
+		uint64_t material = materialId & FieldMask(MATERIAL_BITS);
+		uint64_t vertexArray = vertexArrayId & FieldMask(VERTEX_ARRAY_BITS);
+
+		if (pass == RenderPass::BLENDED) {
+			key |= (FieldMask(DEPTH_BITS) - depth) << BLENDED_DEPTH_SHIFT;
+			key |= shader << BLENDED_SHADER_SHIFT;
+			key |= material << BLENDED_MATERIAL_SHIFT;
+			key |= vertexArray << BLENDED_VERTEX_ARRAY_SHIFT;
+		}
+		else {
+			key |= shader << SOLID_SHADER_SHIFT;
+			key |= material << SOLID_MATERIAL_SHIFT;
+			key |= vertexArray << SOLID_VERTEX_ARRAY_SHIFT;
+			key |= depth << SOLID_DEPTH_SHIFT;
+		}
+		return key;
+	}
+
+	uint32_t RenderSort::QuantizeDepth(float viewDepth)
+	{
+		// The bits of a positive float sort like the float itself, the top ones keep the exponent and
+		// the first mantissa bits: precision relative to the distance, like the depth buffer
+		if (!(viewDepth > 0.0f))
+			return 0;
+		uint32_t bits;
+		std::memcpy(&bits, &viewDepth, sizeof(bits));
+		return bits >> (32 - DEPTH_BITS);
+	}
+
+	uint32_t RenderSort::GetShaderId(uint64_t key)
+	{
+		uint32_t shift = GetPass(key) == RenderPass::BLENDED ? BLENDED_SHADER_SHIFT : SOLID_SHADER_SHIFT;
+		return static_cast<uint32_t>((key >> shift) & FieldMask(SHADER_BITS));
+	}
+
+	uint32_t RenderSort::GetMaterialId(uint64_t key)
+	{
+		uint32_t shift = GetPass(key) == RenderPass::BLENDED ? BLENDED_MATERIAL_SHIFT : SOLID_MATERIAL_SHIFT;
+		return static_cast<uint32_t>((key >> shift) & FieldMask(MATERIAL_BITS));
+	}
+
+	uint32_t RenderSort::GetVertexArrayId(uint64_t key)
+	{
+		uint32_t shift = GetPass(key) == RenderPass::BLENDED ? BLENDED_VERTEX_ARRAY_SHIFT : SOLID_VERTEX_ARRAY_SHIFT;
+		return static_cast<uint32_t>((key >> shift) & FieldMask(VERTEX_ARRAY_BITS));
+	}
+
+	void RenderSort::RadixSort(std::vector<RenderSortEntry>& entries, std::vector<RenderSortEntry>& scratch)
+	{
+		constexpr uint32_t DIGIT_COUNT = 8;
+		const size_t count = entries.size();
+		if (count < 2)
+			return;
+
+		// Every digit's histogram in a single read of the keys
+		uint32_t histograms[DIGIT_COUNT][256] = {};
+		for (const RenderSortEntry& entry : entries) {
+			for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+				++histograms[digit][(entry.Key >> (digit * 8)) & 0xFF];
+		}
+
+		scratch.resize(count);
+		RenderSortEntry* source = entries.data();
+		RenderSortEntry* destination = scratch.data();
+
+		for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit) {
+			uint32_t* histogram = histograms[digit];
+			uint32_t shift = digit * 8;
+			if (histogram[(source[0].Key >> shift) & 0xFF] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < 256; ++bucket) {
+				uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+				destination[histogram[(source[i].Key >> shift) & 0xFF]++] = source[i];
+			std::swap(source, destination);
+		}
+
+		if (source != entries.data())
+			entries.swap(scratch);
+	}
+
+	RenderStats RenderSort::CountStateChanges(const RenderSortEntry* entries, size_t count)
+	{
+		RenderStats stats;
+		stats.Items = static_cast<uint32_t>(count);
+		for (size_t i = 0; i < count; ++i) {
+			uint64_t key = entries[i].Key;
+			if (i == 0) {
+				stats.DrawCalls = stats.ShaderChanges = stats.MaterialChanges = stats.VertexArrayChanges = 1;
+				continue;
+			}
+
+			uint64_t previous = entries[i - 1].Key;
+			bool shaderChanged = GetShaderId(key) != GetShaderId(previous);
+			// A new shader has none of the material's uniforms, so the material is applied again
+			bool materialChanged = shaderChanged || GetMaterialId(key) != GetMaterialId(previous);
+			bool vertexArrayChanged = GetVertexArrayId(key) != GetVertexArrayId(previous);
+			if (shaderChanged)
+				++stats.ShaderChanges;
+			if (materialChanged)
+				++stats.MaterialChanges;
+			if (vertexArrayChanged)
+				++stats.VertexArrayChanges;
+			if (materialChanged || vertexArrayChanged)
+				++stats.DrawCalls;
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Loopie {
+	enum class RenderPass : uint8_t {
+		SOLID = 0,   // Grouped by state, front to back inside a group
+		BLENDED = 1  // Back to front, state only breaks ties
+	};
+
+	struct RenderSortEntry {
+		uint64_t Key;
+		uint32_t Index; // Into the render queue
+	};
+
+	// Counted by the renderer while flushing, or from the keys alone with RenderSort::CountStateChanges
+	struct RenderStats {
+		uint32_t Items = 0;
+		uint32_t DrawCalls = 0;
+		uint32_t ShaderChanges = 0;
+		uint32_t MaterialChanges = 0;
+		uint32_t VertexArrayChanges = 0;
+
+		uint32_t GetStateChanges() const { return ShaderChanges + MaterialChanges + VertexArrayChanges; }
+	};
+
+	// *** Render sort keys ***
+	// One 64 bit key per queued item, sorting them ascending gives the draw order:
+	//   SOLID:   | pass 2 | shader 12 | material 16 | vertex array 16 | depth 18 |
+	//   BLENDED: | pass 2 | inverted depth 18 | shader 12 | material 16 | vertex array 16 |
+	// Ids wider than their field wrap around, which only costs some grouping, never correctness.
+	class RenderSort {
+	public:
+		static constexpr uint32_t PASS_BITS = 2;
+		static constexpr uint32_t SHADER_BITS = 12;
+		static constexpr uint32_t MATERIAL_BITS = 16;
+		static constexpr uint32_t VERTEX_ARRAY_BITS = 16;
+		static constexpr uint32_t DEPTH_BITS = 18;
+
+		static uint64_t MakeKey(RenderPass pass, uint32_t shaderId, uint32_t materialId, uint32_t vertexArrayId, float viewDepth);
+		// View space distance in front of the camera to DEPTH_BITS, keeping the order of the values
+		static uint32_t QuantizeDepth(float viewDepth);
+
+		static RenderPass GetPass(uint64_t key) { return static_cast<RenderPass>(key >> (64 - PASS_BITS)); }
+		static uint32_t GetShaderId(uint64_t key);
+		static uint32_t GetMaterialId(uint64_t key);
+		static uint32_t GetVertexArrayId(uint64_t key);
+
+		// LSD radix sort by Key, 8 bits per pass. Passes where every key has the same byte are skipped,
+		// so the usual handful of shaders and materials costs far less than 8 passes. Stable.
+		// scratch is resized as needed, keeping it around between frames avoids the allocations.
+		static void RadixSort(std::vector<RenderSortEntry>& entries, std::vector<RenderSortEntry>& scratch);
+
+		// Shader, material and vertex array changes drawing the entries in this order, from the key fields.
+		// Consecutive entries with the same ids count as one instanced draw call.
+		static RenderStats CountStateChanges(const RenderSortEntry* entries, size_t count);
+	};
+}
@@ -1,6 +1,7 @@
 #include "Renderer.h"
 
 #include "Loopie/Core/Assert.h"
+#include "Loopie/Core/Log.h"
 #include "Loopie/Components/Transform.h"
 #include "Loopie/Render/Gizmo.h"
 #include <iostream>
@@ -12,6 +13,18 @@
 namespace Loopie {
 
 	std::vector<Renderer::RenderItem> Renderer::s_RenderQueue = std::vector<Renderer::RenderItem>();
+	std::vector<RenderSortEntry> Renderer::s_SortEntries = std::vector<RenderSortEntry>();
+	std::vector<RenderSortEntry> Renderer::s_SortScratch = std::vector<RenderSortEntry>();
+	std::vector<Renderer::RenderBatch> Renderer::s_RenderBatches = std::vector<Renderer::RenderBatch>();
+	std::vector<matrix4> Renderer::s_InstanceTransforms = std::vector<matrix4>();
+	std::shared_ptr<ShaderStorageBuffer> Renderer::s_InstanceBuffer = nullptr;
+	std::shared_ptr<ShaderStorageBuffer> Renderer::s_SingleInstanceBuffer = nullptr;
+	uint32_t Renderer::s_SingleInstanceSlot = 0;
+	matrix4 Renderer::s_ViewMatrix = matrix4(1.0f);
+	RenderStats Renderer::s_FrameStats;
+	RenderStats Renderer::s_FrameSubmissionStats;
+	RenderStats Renderer::s_LastFrameStats;
+	RenderStats Renderer::s_LastFrameSubmissionStats;
 	std::vector<Camera*> Renderer::s_RenderCameras = std::vector<Camera*>();
 	std::shared_ptr<UniformBuffer> Renderer::s_MatricesUniformBuffer = nullptr;
 	bool Renderer::s_UseGizmos = true;
@@ -38,9 +51,18 @@ namespace Loopie {
 		layout.AddLayoutElement(1, GLVariableType::MATRIX4, 1, "Proj");
 		s_MatricesUniformBuffer = std::make_shared<UniformBuffer>(layout);
 		s_MatricesUniformBuffer->BindToLayout(0);
+
+		s_InstanceBuffer = std::make_shared<ShaderStorageBuffer>();
+		s_InstanceBuffer->BindToLayout(INSTANCE_BUFFER_BINDING);
+
+		s_SingleInstanceBuffer = std::make_shared<ShaderStorageBuffer>();
+		s_SingleInstanceBuffer->Reserve(SINGLE_INSTANCE_RING_SIZE * sizeof(matrix4));
+		s_SingleInstanceSlot = 0;
 	}
 
 	void Renderer::Shutdown() {
+		s_InstanceBuffer = nullptr;
+		s_SingleInstanceBuffer = nullptr;
 		ilShutDown();
 		Gizmo::Shutdown();
 	}
@@ -76,6 +98,7 @@ namespace Loopie {
 	void Renderer::BeginScene(const matrix4& viewMatrix, const matrix4& projectionMatrix, bool gizmo)
 	{
 		s_UseGizmos = gizmo;
+		s_ViewMatrix = viewMatrix;
 		s_MatricesUniformBuffer->SetData(&projectionMatrix[0][0], 0);
 		s_MatricesUniformBuffer->SetData(&viewMatrix[0][0], 1);
 
@@ -89,9 +112,9 @@ namespace Loopie {
 		Gizmo::EndGizmo();
 	}
 
-	void Renderer::AddRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform)
+	void Renderer::AddRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform, RenderPass pass)
 	{
-		s_RenderQueue.emplace_back(RenderItem{ vao, vao->GetIndexBuffer().GetCount(), material, transform});
+		s_RenderQueue.emplace_back(RenderItem{ vao, vao->GetIndexBuffer().GetCount(), material, transform, pass});
 	}
 
 	void Renderer::FlushRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform)
@@ -103,28 +126,160 @@ namespace Loopie {
 	{
 		vao->Bind();
 		material->Bind();
-		SetRenderUniforms(material, modelMatrix);
-		glDrawElements(GL_TRIANGLES, vao->GetIndexBuffer().GetCount(), GL_UNSIGNED_INT, nullptr);
+		const matrix4 transform = vao->HasPositionDecode() ? modelMatrix * vao->GetPositionDecode() : modelMatrix;
+		if (material->GetShader().GetSupportsInstancing()) {
+			// One slot of a small ring of its own, drawn as base instance. The queue's instance buffer is
+			// left alone and the ring is only orphaned when it wraps around
+			if (s_SingleInstanceSlot == SINGLE_INSTANCE_RING_SIZE) {
+				s_SingleInstanceBuffer->Reserve(SINGLE_INSTANCE_RING_SIZE * sizeof(matrix4));
+				s_SingleInstanceSlot = 0;
+			}
+			s_SingleInstanceBuffer->SetSubData(&transform, s_SingleInstanceSlot * sizeof(matrix4), sizeof(matrix4));
+			s_SingleInstanceBuffer->BindToLayout(INSTANCE_BUFFER_BINDING);
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, vao->GetIndexBuffer().GetCount(), vao->GetIndexBuffer().GetIndexType(), nullptr, 1, s_SingleInstanceSlot);
+			s_InstanceBuffer->BindToLayout(INSTANCE_BUFFER_BINDING);
+			++s_SingleInstanceSlot;
+		}
+		else {
+			SetRenderUniforms(material, transform);
+			glDrawElements(GL_TRIANGLES, vao->GetIndexBuffer().GetCount(), vao->GetIndexBuffer().GetIndexType(), nullptr);
+		}
 		vao->Unbind();
 	}
 
+	void Renderer::SortRenderQueue()
+	{
+		s_SortEntries.resize(s_RenderQueue.size());
+		for (size_t i = 0; i < s_RenderQueue.size(); ++i) {
+			const RenderItem& item = s_RenderQueue[i];
+			// Distance in front of the camera of the object's origin, -z in view space
+			const vec3 position = vec3(item.Transform->GetLocalToWorldMatrix()[3]);
+			float viewDepth = -(s_ViewMatrix[0][2] * position.x + s_ViewMatrix[1][2] * position.y + s_ViewMatrix[2][2] * position.z + s_ViewMatrix[3][2]);
+
+			s_SortEntries[i].Key = RenderSort::MakeKey(item.Pass, item.Material->GetShader().GetProgramID(), item.Material->GetSortId(),
+				item.VAO->GetRendererID(), viewDepth);
+			s_SortEntries[i].Index = static_cast<uint32_t>(i);
+		}
+
+		RenderStats submission = RenderSort::CountStateChanges(s_SortEntries.data(), s_SortEntries.size());
+		s_FrameSubmissionStats.DrawCalls += submission.DrawCalls;
+		s_FrameSubmissionStats.Items += submission.Items;
+		s_FrameSubmissionStats.ShaderChanges += submission.ShaderChanges;
+		s_FrameSubmissionStats.MaterialChanges += submission.MaterialChanges;
+		s_FrameSubmissionStats.VertexArrayChanges += submission.VertexArrayChanges;
+
+		RenderSort::RadixSort(s_SortEntries, s_SortScratch);
+	}
+
+	void Renderer::BatchRenderQueue()
+	{
+		s_RenderBatches.clear();
+		s_InstanceTransforms.clear();
+
+		const uint32_t count = static_cast<uint32_t>(s_SortEntries.size());
+		for (uint32_t first = 0; first < count;) {
+			const RenderItem& item = s_RenderQueue[s_SortEntries[first].Index];
+			RenderBatch batch{ first, 1, 0, item.Material->GetShader().GetSupportsInstancing() };
+
+			if (batch.Instanced) {
+				batch.BaseInstance = static_cast<uint32_t>(s_InstanceTransforms.size());
+				while (first + batch.Count < count) {
+					const RenderItem& next = s_RenderQueue[s_SortEntries[first + batch.Count].Index];
+					if (next.VAO != item.VAO || next.Material != item.Material)
+						break;
+					++batch.Count;
+				}
+
+				for (uint32_t i = first; i < first + batch.Count; ++i) {
+					const RenderItem& instance = s_RenderQueue[s_SortEntries[i].Index];
+					if (instance.VAO->HasPositionDecode())
+						s_InstanceTransforms.push_back(instance.Transform->GetLocalToWorldMatrix() * instance.VAO->GetPositionDecode());
+					else
+						s_InstanceTransforms.push_back(instance.Transform->GetLocalToWorldMatrix());
+				}
+			}
+
+			s_RenderBatches.push_back(batch);
+			first += batch.Count;
+		}
+
+		// Every instanced batch of the queue goes up in a single upload
+		s_InstanceBuffer->SetData(s_InstanceTransforms.data(), s_InstanceTransforms.size() * sizeof(matrix4));
+	}
+
 	void Renderer::FlushRenderQueue()
 	{
-		/// SORT By Material
+		SortRenderQueue();
+		BatchRenderQueue();
+
+		// Only what differs from the previous draw is bound again
+		const VertexArray* boundVAO = nullptr;
+		const Material* boundMaterial = nullptr;
+		GLuint boundProgram = 0;
+
+		for (const RenderBatch& batch : s_RenderBatches) {
+			const RenderItem& item = s_RenderQueue[s_SortEntries[batch.First].Index];
 
+			if (item.VAO.get() != boundVAO) {
+				item.VAO->Bind();
+				boundVAO = item.VAO.get();
+				++s_FrameStats.VertexArrayChanges;
+			}
 
-		///
+			GLuint program = item.Material->GetShader().GetProgramID();
+			if (program != boundProgram || boundMaterial == nullptr) {
+				item.Material->Bind();
+				boundProgram = program;
+				boundMaterial = item.Material.get();
+				++s_FrameStats.ShaderChanges;
+				++s_FrameStats.MaterialChanges;
+			}
+			else if (item.Material.get() != boundMaterial) {
+				item.Material->BindResources();
+				boundMaterial = item.Material.get();
+				++s_FrameStats.MaterialChanges;
+			}
 
-		for (const RenderItem& item : s_RenderQueue) {
-			
-			item.VAO->Bind();
-			item.Material->Bind();
-			SetRenderUniforms(item.Material, item.Transform);
-			glDrawElements(GL_TRIANGLES, item.IndexCount, GL_UNSIGNED_INT, nullptr);
-			item.VAO->Unbind();
+			const GLenum indexType = item.VAO->GetIndexBuffer().GetIndexType();
+			if (batch.Instanced) {
+				glDrawElementsInstancedBaseInstance(GL_TRIANGLES, item.IndexCount, indexType, nullptr, batch.Count, batch.BaseInstance);
+			}
+			else {
+				if (item.VAO->HasPositionDecode())
+					SetRenderUniforms(item.Material, item.Transform->GetLocalToWorldMatrix() * item.VAO->GetPositionDecode());
+				else
+					SetRenderUniforms(item.Material, item.Transform);
+				glDrawElements(GL_TRIANGLES, item.IndexCount, indexType, nullptr);
+			}
+			++s_FrameStats.DrawCalls;
+			s_FrameStats.Items += batch.Count;
 		}
 
+		if (boundVAO)
+			boundVAO->Unbind();
+
 		s_RenderQueue.clear();
+		s_SortEntries.clear();
+	}
+
+	void Renderer::BeginFrame()
+	{
+		s_LastFrameStats = s_FrameStats;
+		s_LastFrameSubmissionStats = s_FrameSubmissionStats;
+		s_FrameStats = RenderStats();
+		s_FrameSubmissionStats = RenderStats();
+	}
+
+	void Renderer::LogStatistics()
+	{
+		const RenderStats& sorted = s_LastFrameStats;
+		const RenderStats& submission = s_LastFrameSubmissionStats;
+		Log::Info("--- Render Queue (last frame) ---");
+		Log::Info("Items = {0}", sorted.Items);
+		Log::Info("Sorted:      {0} draw calls, shader {1}, material {2}, vertex array {3} changes ({4} total)",
+			sorted.DrawCalls, sorted.ShaderChanges, sorted.MaterialChanges, sorted.VertexArrayChanges, sorted.GetStateChanges());
+		Log::Info("Submitted:   {0} draw calls, shader {1}, material {2}, vertex array {3} changes ({4} total)",
+			submission.DrawCalls, submission.ShaderChanges, submission.MaterialChanges, submission.VertexArrayChanges, submission.GetStateChanges());
 	}
 
 	void Renderer::SetRenderUniforms(std::shared_ptr<Material> material, const Transform* transform)
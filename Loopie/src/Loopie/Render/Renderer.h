@@ -3,7 +3,9 @@
 #include "Loopie/Resources/Types/Material.h"
 #include "Loopie/Resources/Types/Texture.h"
 #include "Loopie/Render/VertexArray.h"
+#include "Loopie/Render/RenderSort.h"
 #include "Loopie/Render/UniformBuffer.h"
+#include "Loopie/Render/ShaderStorageBuffer.h"
 #include "Loopie/Components/Camera.h"
 
 #include <filesystem>
@@ -53,6 +55,7 @@ namespace Loopie {
 
 			std::shared_ptr<Material> Material;
 			const Transform* Transform;
+			RenderPass Pass;
 		};
 
 		static void Init(void* context);
@@ -70,7 +73,7 @@ namespace Loopie {
 		static void BeginScene(const matrix4& viewMatrix, const matrix4& projectionMatrix, bool gizmo = true);
 		static void EndScene();
 
-		static void AddRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform);
+		static void AddRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform, RenderPass pass = RenderPass::SOLID);
 		static void FlushRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const Transform* transform);
 		static void FlushRenderItem(std::shared_ptr<VertexArray> vao, std::shared_ptr<Material> material, const matrix4& modelMatrix);
 
@@ -83,15 +86,45 @@ namespace Loopie {
 		static void SetStencilOp(StencilOp stencil_fail, StencilOp depth_fail, StencilOp pass);
 		static void SetStencilFunc(StencilFunc cond, int ref, unsigned int mask);
 
+		// Render queue statistics, BeginFrame starts counting a new frame
+		static void BeginFrame();
+		static const RenderStats& GetLastFrameStats() { return s_LastFrameStats; }
+		static void LogStatistics();
+
 	private:
 		static void SetRenderUniforms(std::shared_ptr<Material> material, const Transform* transform);
 		static void SetRenderUniforms(std::shared_ptr<Material> material, const matrix4& modelMatrix);
 		static void FlushRenderQueue();
+		static void SortRenderQueue();
+		static void BatchRenderQueue();
 
 	public:
+		static constexpr unsigned int INSTANCE_BUFFER_BINDING = 1; // "Instances" block of the shaders
+		static constexpr uint32_t SINGLE_INSTANCE_RING_SIZE = 256; // FlushRenderItem matrices between orphanings
+
 	private:
+		// Consecutive sorted items sharing vertex array and material, drawn instanced when the shader allows it
+		struct RenderBatch {
+			uint32_t First; // Into s_SortEntries
+			uint32_t Count;
+			uint32_t BaseInstance; // Into the instance buffer
+			bool Instanced;
+		};
 
 		static std::vector<RenderItem> s_RenderQueue;
+		static std::vector<RenderSortEntry> s_SortEntries;
+		static std::vector<RenderSortEntry> s_SortScratch;
+		static std::vector<RenderBatch> s_RenderBatches;
+		static std::vector<matrix4> s_InstanceTransforms;
+		static std::shared_ptr<ShaderStorageBuffer> s_InstanceBuffer;
+		static std::shared_ptr<ShaderStorageBuffer> s_SingleInstanceBuffer; // Ring of FlushRenderItem transforms
+		static uint32_t s_SingleInstanceSlot;
+		static matrix4 s_ViewMatrix;
+
+		static RenderStats s_FrameStats;
+		static RenderStats s_FrameSubmissionStats; // What the same frame would have cost unsorted
+		static RenderStats s_LastFrameStats;
+		static RenderStats s_LastFrameSubmissionStats;
 		static std::vector<Camera*> s_RenderCameras;
 		static std::shared_ptr<UniformBuffer> s_MatricesUniformBuffer;
 
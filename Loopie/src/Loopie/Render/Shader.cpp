@@ -178,6 +178,11 @@ namespace Loopie {
 		return m_isValidShader;
 	}
 
+	bool Shader::GetSupportsInstancing() const
+	{
+		return m_supportsInstancing;
+	}
+
 	const std::string& Shader::GetVertexSource() const
 	{ 
 		return m_vertexSource; 
@@ -301,6 +306,9 @@ namespace Loopie {
 			glDeleteShader(geometryShader);
 		}
 
+		// Only active blocks are found, a shader declaring it without reading it draws item by item
+		m_supportsInstancing = glGetProgramResourceIndex(newProgram, GL_SHADER_STORAGE_BLOCK, "Instances") != GL_INVALID_INDEX;
+
 		// Return the new program ID via output parameter
 		programID = newProgram;
 		GetUniformsGL();
@@ -72,6 +72,8 @@ namespace Loopie {
 		GLuint GetProgramID() const;
 		GLint GetUniformLocation(const std::string& name);
 		bool GetIsValidShader() const;
+		// The vertex stage reads its model matrices from the renderer's instance buffer (the "Instances" block)
+		bool GetSupportsInstancing() const;
 		bool GetIsBound() const;
 		// Vertex and Fragment shader version be different, although they will generally match.
 		// https://stackoverflow.com/questions/30943346/should-vertex-and-fragment-shader-versions-always-match
@@ -121,5 +123,6 @@ namespace Loopie {
 		std::string m_geometrySource;
 
 		bool m_isValidShader = true;
+		bool m_supportsInstancing = false;
 	};
 }
\ No newline at end of file
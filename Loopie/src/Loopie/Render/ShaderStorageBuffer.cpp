@@ -0,0 +1,62 @@
+#include "ShaderStorageBuffer.h"
+#include <glad/glad.h>
+namespace Loopie
+{
+	ShaderStorageBuffer::ShaderStorageBuffer()
+	{
+		glGenBuffers(1, &m_rendererID);
+	}
+
+	ShaderStorageBuffer::~ShaderStorageBuffer()
+	{
+		glDeleteBuffers(1, &m_rendererID);
+	}
+
+	void ShaderStorageBuffer::Bind() const
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_rendererID);
+	}
+
+	void ShaderStorageBuffer::BindToLayout(unsigned int layoutIndex) const
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, layoutIndex, m_rendererID);
+	}
+
+	void ShaderStorageBuffer::Unbind() const
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	void ShaderStorageBuffer::SetData(const void* data, size_t size)
+	{
+		if (size == 0)
+			return;
+
+		// Grows by doubling, so a queue that keeps growing only reallocates a few times
+		if (size > m_capacity)
+			m_capacity = m_capacity * 2 > size ? m_capacity * 2 : size;
+
+		Bind();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		Unbind();
+	}
+
+	void ShaderStorageBuffer::Reserve(size_t size)
+	{
+		m_capacity = size;
+		Bind();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+		Unbind();
+	}
+
+	void ShaderStorageBuffer::SetSubData(const void* data, size_t offset, size_t size)
+	{
+		if (size == 0 || offset + size > m_capacity)
+			return;
+
+		Bind();
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+		Unbind();
+	}
+}
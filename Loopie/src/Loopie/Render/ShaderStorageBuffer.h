@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+
+namespace Loopie
+{
+	// Buffer of data rewritten as a whole every time it changes, read by shaders through a
+	// "layout (std430, binding = N) buffer" block
+	class ShaderStorageBuffer
+	{
+	public:
+		ShaderStorageBuffer();
+		~ShaderStorageBuffer();
+
+		void Bind() const;
+		void BindToLayout(unsigned int layoutIndex) const;
+		void Unbind() const;
+
+		// The previous storage is orphaned, so draws still reading it don't stall the upload
+		void SetData(const void* data, size_t size);
+		// New storage of exactly size bytes with undefined contents, orphaning the previous one
+		void Reserve(size_t size);
+		// Writes into the current storage without reallocating it, offset + size must fit the capacity
+		void SetSubData(const void* data, size_t offset, size_t size);
+
+		unsigned int GetRendererID()const { return m_rendererID; }
+		size_t GetCapacity() const { return m_capacity; }
+
+	private:
+		unsigned int m_rendererID = 0;
+		size_t m_capacity = 0;
+	};
+}
@@ -7,14 +7,49 @@
 #include <IL/ilu.h>
 #include <glad/glad.h>
 
+// EXT_texture_compression_s3tc, supported by every desktop driver but not always in the glad build
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 namespace Loopie
 {
-	TextureBuffer::TextureBuffer(const unsigned char* data, int width, int height, int channels) : m_rendererId(0)
+	size_t GetTextureLevelSize(TextureCompression compression, int width, int height, int channels)
+	{
+		size_t blocks = size_t((width + 3) / 4) * size_t((height + 3) / 4);
+		switch (compression) {
+			case TextureCompression::BC1:
+				return blocks * 8;
+			case TextureCompression::BC3:
+				return blocks * 16;
+			default:
+				return size_t(width) * height * channels;
+		}
+	}
+
+	unsigned int GetTextureMipCount(int width, int height)
+	{
+		unsigned int levels = 1;
+		for (int size = std::max(width, height); size > 1; size /= 2)
+			++levels;
+		return levels;
+	}
+
+	TextureBuffer::TextureBuffer(const unsigned char* data, int width, int height, int channels, TextureCompression compression, unsigned int mipCount)
 	{
 		GLenum format = GL_RGB;
 		GLenum internalFormat = GL_RGB8;
 
-		if (channels == 1) {
+		if (compression == TextureCompression::BC1) {
+			internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		}
+		else if (compression == TextureCompression::BC3) {
+			internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if (channels == 1) {
 			format = GL_RED;
 			internalFormat = GL_R8;
 		}
@@ -23,17 +58,40 @@ namespace Loopie
 			internalFormat = GL_RGBA8;
 		}
 
+		bool generateMipmaps = compression == TextureCompression::NONE && mipCount == 1;
+		unsigned int levels = generateMipmaps ? GetTextureMipCount(width, height) : mipCount;
+		m_internalFormat = internalFormat;
+		m_width = width;
+		m_height = height;
+		m_levels = levels;
+
 		glGenTextures(1, &m_rendererId);
 		glBindTexture(GL_TEXTURE_2D, m_rendererId);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-		glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+
+		const unsigned char* level = data;
+		unsigned int uploadLevels = generateMipmaps ? 1 : mipCount;
+		for (unsigned int i = 0; i < uploadLevels; ++i) {
+			int levelWidth = std::max(1, width >> i);
+			int levelHeight = std::max(1, height >> i);
+			size_t levelSize = GetTextureLevelSize(compression, levelWidth, levelHeight, channels);
+
+			if (compression == TextureCompression::NONE)
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, levelWidth, levelHeight, format, GL_UNSIGNED_BYTE, level);
+			else
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, levelWidth, levelHeight, internalFormat, (GLsizei)levelSize, level);
+			level += levelSize;
+		}
+
+		// Only caches from before the mip chain was stored get here
+		if (generateMipmaps)
+			glGenerateMipmap(GL_TEXTURE_2D);
 
 		Unbind();
 	}
@@ -43,6 +101,39 @@ namespace Loopie
 		glDeleteTextures(1, &m_rendererId);
 	}
 
+	std::shared_ptr<TextureBuffer> TextureBuffer::CopyLevels(unsigned int firstLevel) const
+	{
+		if (firstLevel >= m_levels)
+			return nullptr;
+
+		std::shared_ptr<TextureBuffer> copy(new TextureBuffer());
+		copy->m_internalFormat = m_internalFormat;
+		copy->m_width = std::max(1, m_width >> firstLevel);
+		copy->m_height = std::max(1, m_height >> firstLevel);
+		copy->m_levels = m_levels - firstLevel;
+
+		glGenTextures(1, &copy->m_rendererId);
+		glBindTexture(GL_TEXTURE_2D, copy->m_rendererId);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, copy->m_levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glTexStorage2D(GL_TEXTURE_2D, copy->m_levels, m_internalFormat, copy->m_width, copy->m_height);
+
+		// Same format on both sides, so compressed levels copy block for block
+		for (unsigned int i = 0; i < copy->m_levels; ++i) {
+			int levelWidth = std::max(1, copy->m_width >> i);
+			int levelHeight = std::max(1, copy->m_height >> i);
+			glCopyImageSubData(m_rendererId, GL_TEXTURE_2D, firstLevel + i, 0, 0, 0,
+							   copy->m_rendererId, GL_TEXTURE_2D, i, 0, 0, 0, levelWidth, levelHeight, 1);
+		}
+
+		Unbind();
+		return copy;
+	}
+
 	void TextureBuffer::Bind(unsigned int unit) const
 	{
 		if (unit > 31)
@@ -1,18 +1,47 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <string>
 namespace Loopie
 {
+	enum class TextureCompression {
+		NONE,
+		BC1, // Opaque RGB, 8 bytes per 4x4 block
+		BC3 // RGBA, 16 bytes per 4x4 block
+	};
+
+	// Bytes of one mip level
+	size_t GetTextureLevelSize(TextureCompression compression, int width, int height, int channels);
+	// Levels of a full chain down to 1x1
+	unsigned int GetTextureMipCount(int width, int height);
+
 	class TextureBuffer
 	{
 	public:
-		TextureBuffer(const unsigned char* data, int width, int height, int channels);
+		// data holds mipCount levels back to back, largest first. A single uncompressed level
+		// gets the rest of the chain generated on the GPU
+		TextureBuffer(const unsigned char* data, int width, int height, int channels,
+					  TextureCompression compression = TextureCompression::NONE, unsigned int mipCount = 1);
 		~TextureBuffer();
 
 		void Bind(unsigned int unit = 0)const;
 		void Unbind()const;
 
+		// New texture with the levels from firstLevel down, copied on the GPU. nullptr when nothing would be left
+		std::shared_ptr<TextureBuffer> CopyLevels(unsigned int firstLevel)const;
+
 		unsigned int GetRendererID()const { return m_rendererId; }
+		int GetWidth()const { return m_width; }
+		int GetHeight()const { return m_height; }
+		unsigned int GetLevelCount()const { return m_levels; }
 	private:
-		unsigned int m_rendererId;
+		TextureBuffer() = default;
+
+		unsigned int m_rendererId = 0;
+		unsigned int m_internalFormat = 0;
+		int m_width = 0;
+		int m_height = 0;
+		unsigned int m_levels = 0;
 	};
 }
\ No newline at end of file
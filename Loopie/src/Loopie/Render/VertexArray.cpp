@@ -17,6 +17,18 @@ namespace Loopie
         case Loopie::GLVariableType::BOOL:
             return GL_BOOL;
             break;
+        case Loopie::GLVariableType::HALF_FLOAT:
+            return GL_HALF_FLOAT;
+            break;
+        case Loopie::GLVariableType::SHORT:
+            return GL_SHORT;
+            break;
+        case Loopie::GLVariableType::UNSIGNED_BYTE:
+            return GL_UNSIGNED_BYTE;
+            break;
+        case Loopie::GLVariableType::INT_2_10_10_10_REV:
+            return GL_INT_2_10_10_10_REV;
+            break;
         default:
             return GL_NONE;
             break;
@@ -56,7 +68,7 @@ namespace Loopie
         for (const auto& element : layout.GetElements())
         {
             glEnableVertexAttribArray(element.Index);
-            glVertexAttribPointer(element.Index, element.Count, ConvertGLVariableTypeToGlType(element.Type), GL_FALSE, layout.GetStride(), (const void*)(uintptr_t)element.Offset);
+            glVertexAttribPointer(element.Index, element.Count, ConvertGLVariableTypeToGlType(element.Type), element.Normalized ? GL_TRUE : GL_FALSE, layout.GetStride(), (const void*)(uintptr_t)element.Offset);
         }
         
         m_vbo->Unbind();
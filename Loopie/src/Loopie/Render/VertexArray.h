@@ -2,6 +2,7 @@
 #include "VertexBuffer.h"
 #include "Loopie/Render/IndexBuffer.h"
 #include "Loopie/Render/BufferLayout.h"
+#include "Loopie/Math/MathTypes.h"
 
 namespace Loopie
 {
@@ -12,6 +13,9 @@ namespace Loopie
         VertexBuffer* m_vbo = nullptr;
         IndexBuffer* m_ebo = nullptr;
 
+        matrix4 m_positionDecode = matrix4(1.0f);
+        bool m_hasPositionDecode = false;
+
     public:
         VertexArray();
         ~VertexArray();
@@ -24,5 +28,10 @@ namespace Loopie
         unsigned int GetRendererID()const { return m_rendererID; }
 
         const IndexBuffer& GetIndexBuffer() const;
+
+        // Quantized positions are stored in [-1, 1], the renderer applies this before the model matrix
+        void SetPositionDecode(const matrix4& decode) { m_positionDecode = decode; m_hasPositionDecode = true; }
+        bool HasPositionDecode() const { return m_hasPositionDecode; }
+        const matrix4& GetPositionDecode() const { return m_positionDecode; }
     };
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "AssetPack.h"
+
+#include "Loopie/Core/Log.h"
+#include "Loopie/Core/Application.h"
+#include "Loopie/Resources/AssetRegistry.h"
+#include "Loopie/Resources/ResourceManager.h"
+#include "Loopie/Resources/TextureStreamer.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Loopie {
+	namespace {
+		constexpr uint32_t ASSET_PACK_MAGIC = 0x4B41504C; // "LPAK"
+		constexpr uint32_t ASSET_PACK_VERSION = 1;
+
+		struct AssetPackHeader
+		{
+			uint32_t Magic = ASSET_PACK_MAGIC;
+			uint32_t Version = ASSET_PACK_VERSION;
+			uint32_t EntryCount = 0;
+			uint32_t Padding = 0;
+			uint64_t TableOffset = 0;
+		};
+
+		// Cache files are named "<uuid>.<extension>"
+		bool GetCacheUUID(const std::filesystem::path& cachePath, uint64_t& high, uint64_t& low)
+		{
+			return UUID::Parse(cachePath.stem().string(), high, low);
+		}
+
+		void WritePadding(std::ofstream& fs, uint64_t& offset)
+		{
+			static const char zeros[ASSET_PACK_ALIGNMENT] = {};
+			uint64_t padding = (ASSET_PACK_ALIGNMENT - offset % ASSET_PACK_ALIGNMENT) % ASSET_PACK_ALIGNMENT;
+			fs.write(zeros, padding);
+			offset += padding;
+		}
+	}
+
+	MappedFile AssetPack::s_file;
+	const AssetPackEntry* AssetPack::s_entries = nullptr;
+	uint32_t AssetPack::s_entryCount = 0;
+
+	bool AssetPack::CanRebuild()
+	{
+		// Async mesh loads and streamed texture levels read through CacheFileStream, straight from the mapping
+		return !IsMounted() || (ResourceManager::GetPendingLoadCount() == 0 && TextureStreamer::GetPendingLoadCount() == 0);
+	}
+
+	bool AssetPack::Build(const std::filesystem::path& packPath)
+	{
+		if (!CanRebuild()) {
+			Log::Warn("Asset pack not built, {0} loads are still reading from the mounted one",
+				ResourceManager::GetPendingLoadCount() + TextureStreamer::GetPendingLoadCount());
+			return false;
+		}
+
+		const Project& project = Application::GetInstance().m_activeProject;
+
+		struct PackFile
+		{
+			UUID Id;
+			std::filesystem::path Path;
+		};
+		std::vector<PackFile> files;
+		for (const auto& [uuid, metadata] : AssetRegistry::GetAllMetadata()) {
+			for (const std::string& cachePath : metadata.CachesPath) {
+				uint64_t high = 0;
+				uint64_t low = 0;
+				if (GetCacheUUID(cachePath, high, low))
+					files.push_back({ UUID(high, low), project.GetChachePath() / cachePath });
+			}
+		}
+		std::sort(files.begin(), files.end(), [](const PackFile& a, const PackFile& b) { return a.Id < b.Id; });
+		files.erase(std::unique(files.begin(), files.end(), [](const PackFile& a, const PackFile& b) { return a.Id == b.Id; }), files.end());
+
+		// The pack being rebuilt may be the mounted one, which cannot be overwritten while mapped
+		bool remount = IsMounted();
+		Unmount();
+
+		std::ofstream fs(packPath, std::ios::binary | std::ios::trunc);
+		if (!fs) {
+			Log::Error("Failed to create asset pack {0}", packPath.string());
+			if (remount)
+				Mount(packPath);
+			return false;
+		}
+
+		AssetPackHeader header;
+		fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64_t offset = sizeof(header);
+
+		std::vector<AssetPackEntry> entries;
+		entries.reserve(files.size());
+		std::vector<char> buffer;
+		for (const PackFile& file : files) {
+			std::ifstream input(file.Path, std::ios::binary | std::ios::ate);
+			if (!input) {
+				Log::Warn("Asset pack is missing cache file {0}", file.Path.string());
+				continue;
+			}
+			buffer.resize(static_cast<size_t>(input.tellg()));
+			input.seekg(0, std::ios::beg);
+			input.read(buffer.data(), buffer.size());
+
+			WritePadding(fs, offset);
+			entries.push_back({ file.Id.GetHigh(), file.Id.GetLow(), offset, buffer.size() });
+			fs.write(buffer.data(), buffer.size());
+			offset += buffer.size();
+		}
+
+		WritePadding(fs, offset);
+		header.EntryCount = static_cast<uint32_t>(entries.size());
+		header.TableOffset = offset;
+		fs.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPackEntry));
+		fs.seekp(0, std::ios::beg);
+		fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		fs.close();
+
+		Log::Info("Asset pack built -> {0} ({1} files, {2:.2f}MB)", packPath.string(), entries.size(),
+			(offset + entries.size() * sizeof(AssetPackEntry)) / (1024.0 * 1024.0));
+
+		if (remount)
+			Mount(packPath);
+		return true;
+	}
+
+	bool AssetPack::Mount(const std::filesystem::path& packPath)
+	{
+		Unmount();
+		if (!s_file.Open(packPath))
+			return false;
+
+		AssetPackHeader header;
+		bool valid = s_file.GetSize() >= sizeof(header);
+		if (valid) {
+			std::copy_n(s_file.GetData(), sizeof(header), reinterpret_cast<char*>(&header));
+			valid = header.Magic == ASSET_PACK_MAGIC && header.Version == ASSET_PACK_VERSION &&
+				header.TableOffset % ASSET_PACK_ALIGNMENT == 0 &&
+				header.TableOffset + uint64_t(header.EntryCount) * sizeof(AssetPackEntry) <= s_file.GetSize();
+		}
+		if (!valid) {
+			Log::Warn("Invalid asset pack {0}", packPath.string());
+			s_file.Close();
+			return false;
+		}
+
+		// The mapping is page aligned and so is the table offset, the entries can be read in place
+		s_entries = reinterpret_cast<const AssetPackEntry*>(s_file.GetData() + header.TableOffset);
+		s_entryCount = header.EntryCount;
+
+		Log::Info("Asset pack mounted -> {0} ({1} files)", packPath.string(), s_entryCount);
+		return true;
+	}
+
+	void AssetPack::Unmount()
+	{
+		s_file.Close();
+		s_entries = nullptr;
+		s_entryCount = 0;
+	}
+
+	bool AssetPack::Find(const std::filesystem::path& cachePath, const char*& data, size_t& size)
+	{
+		const AssetPackEntry* entry = FindEntry(cachePath);
+		if (!entry || entry->Offset + entry->Size > s_file.GetSize())
+			return false;
+
+		data = s_file.GetData() + entry->Offset;
+		size = static_cast<size_t>(entry->Size);
+		return true;
+	}
+
+	bool AssetPack::Contains(const std::filesystem::path& cachePath)
+	{
+		return FindEntry(cachePath) != nullptr;
+	}
+
+	const AssetPackEntry* AssetPack::FindEntry(const std::filesystem::path& cachePath)
+	{
+		uint64_t high = 0;
+		uint64_t low = 0;
+		if (s_entryCount == 0 || !GetCacheUUID(cachePath, high, low))
+			return nullptr;
+
+		const AssetPackEntry* end = s_entries + s_entryCount;
+		const AssetPackEntry* entry = std::lower_bound(s_entries, end, high, [low](const AssetPackEntry& item, uint64_t searchHigh) {
+			return item.High < searchHigh || (item.High == searchHigh && item.Low < low);
+		});
+		if (entry == end || entry->High != high || entry->Low != low)
+			return nullptr;
+		return entry;
+	}
+
+	// *** CacheFileStream ***
+	CacheFileStream::CacheFileStream(const std::filesystem::path& cachePath) : std::istream(nullptr)
+	{
+		const char* data = nullptr;
+		size_t size = 0;
+		if (AssetPack::Find(cachePath, data, size)) {
+			m_memoryBuffer.SetData(data, size);
+			rdbuf(&m_memoryBuffer);
+			m_open = true;
+			m_fromPack = true;
+		}
+		else if (m_fileBuffer.open(cachePath, std::ios::in | std::ios::binary)) {
+			rdbuf(&m_fileBuffer);
+			m_open = true;
+		}
+		else {
+			setstate(std::ios::failbit);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Loopie/Core/UUID.h"
+#include "Loopie/Files/MappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+
+namespace Loopie {
+	constexpr const char* ASSET_PACK_FILE_NAME = "Assets.pack"; // Inside the project folder, next to Assets and the cache
+	constexpr uint64_t ASSET_PACK_ALIGNMENT = 64; // Every file in the pack starts at a multiple of this
+
+	struct AssetPackEntry
+	{
+		uint64_t High; // UUID the cache file is named after
+		uint64_t Low;
+		uint64_t Offset; // From the start of the pack
+		uint64_t Size;
+	};
+
+	// *** Asset pack ***
+	// Every cache file referenced by the AssetRegistry bundled into one memory mapped archive:
+	// header | cache files, each aligned to ASSET_PACK_ALIGNMENT | AssetPackEntry table sorted by UUID
+	// Lookups are a binary search over the mapped table and hand out pointers into the mapping,
+	// no file is opened or stat'ed. Cache files are named after a UUID generated on every import,
+	// so a reimported asset gets a cache file the pack does not know and is read from disk instead.
+	// Mount and Unmount on the main thread with no loads running, Find is safe from any thread.
+	class AssetPack
+	{
+	public:
+		// Refused (returns false) while the pack is mounted and any load may still read from it,
+		// rebuilding unmaps it. Check CanRebuild first to keep the option disabled instead
+		static bool Build(const std::filesystem::path& packPath);
+		static bool CanRebuild();
+
+		static bool Mount(const std::filesystem::path& packPath);
+		static void Unmount();
+		static bool IsMounted() { return s_file.IsOpen(); }
+
+		// cachePath only has to end in "<uuid>.<extension>", relative or absolute
+		static bool Find(const std::filesystem::path& cachePath, const char*& data, size_t& size);
+		static bool Contains(const std::filesystem::path& cachePath);
+
+	private:
+		static const AssetPackEntry* FindEntry(const std::filesystem::path& cachePath);
+
+	private:
+		static MappedFile s_file;
+		static const AssetPackEntry* s_entries;
+		static uint32_t s_entryCount;
+	};
+
+	// A cache file opened from the mounted pack when it has it, from disk otherwise
+	class CacheFileStream : public std::istream
+	{
+	public:
+		explicit CacheFileStream(const std::filesystem::path& cachePath);
+
+		bool IsOpen() const { return m_open; }
+		bool IsFromPack() const { return m_fromPack; }
+
+	private:
+		MemoryStreamBuffer m_memoryBuffer;
+		std::filebuf m_fileBuffer;
+		bool m_open = false;
+		bool m_fromPack = false;
+	};
+}
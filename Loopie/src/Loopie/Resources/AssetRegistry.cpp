@@ -2,13 +2,17 @@
 
 #include "Loopie/Core/Log.h"
 #include "Loopie/Core/Application.h"
+#include "Loopie/Core/JobSystem.h"
 #include "Loopie/Files/DirectoryManager.h"
+#include "Loopie/Resources/AssetPack.h"
 
 
 #include "Loopie/Importers/TextureImporter.h"
 #include "Loopie/Importers/MeshImporter.h"
 #include "Loopie/Importers/MaterialImporter.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <unordered_set>
 
@@ -27,8 +31,46 @@ namespace Loopie {
 		return ext == ".wav" || ext == ".mp3" || ext == ".ogg" || ext == ".bank";
 	}
 
+	namespace {
+		enum class ImportKind {
+			TEXTURE,
+			MESH,
+			MATERIAL
+		};
+
+		// One asset to reimport. The job works on its own copy of the metadata and import settings,
+		// the registry entry is only touched back on the calling thread once every job is done.
+		struct PendingImport {
+			Metadata* Target;
+			const std::string* Path;
+			ImportKind Kind;
+			Metadata Result;
+			MeshImportSettings MeshSettings;
+			TextureImportSettings TextureSettings;
+		};
+
+		void RunImport(void* userData) {
+			PendingImport& import = *static_cast<PendingImport*>(userData);
+			switch (import.Kind) {
+			case ImportKind::TEXTURE:
+				TextureImporter::ImportImage(*import.Path, import.Result, import.TextureSettings, false);
+				break;
+			case ImportKind::MESH:
+				MeshImporter::ImportModel(*import.Path, import.Result, import.MeshSettings, false);
+				break;
+			case ImportKind::MATERIAL:
+				MaterialImporter::ImportMaterial(*import.Path, import.Result, false);
+				break;
+			}
+		}
+	}
+
 	void AssetRegistry::Initialize() {
-	
+		// Mounted first so caches that only exist inside the pack still count as imported
+		std::filesystem::path packPath = Application::GetInstance().m_activeProject.GetProjectPath() / ASSET_PACK_FILE_NAME;
+		if (std::filesystem::exists(packPath))
+			AssetPack::Mount(packPath);
+
 		RefreshAssetRegistry();
 
 		Log::Info("AssetRegistry initialized, {} assets found", s_Assets.size());
@@ -36,6 +78,7 @@ namespace Loopie {
 
 	void AssetRegistry::Shutdown() {
 		Clear();
+		AssetPack::Unmount();
 	}
 
 	void AssetRegistry::RefreshAssetRegistry() {
@@ -44,6 +87,11 @@ namespace Loopie {
 		ScanEngineDirectory();
 		ScanAssetDirectory();
 
+		std::vector<PendingImport> imports;
+		std::vector<Metadata*> updatedAssets;
+		// Copied into every job, the settings menu may write the importer's own while the jobs run
+		const MeshImportSettings meshSettings = MeshImporter::GetImportSettings();
+		const TextureImportSettings textureSettings = TextureImporter::GetImportSettings();
 		for (auto& [key, metadata] : s_Assets) {
 			
 			const std::string& pathString = s_UUIDToPath[metadata.UUID];
@@ -52,23 +100,23 @@ namespace Loopie {
 				metadata.LastModified = MetadataRegistry::GetLastModifiedFromPath(pathString);			
 				updated = true;
 			}
-			/// DO REIMPORTS
+			/// DO REIMPORTS (queued here, run in parallel below)
 
 			if (metadata.Type == ResourceType::TEXTURE || TextureImporter::CheckIfIsImage(pathString.c_str())) {
 				if (metadata.IsOutdated || metadata.CachesPath.size() == 0) {
-					TextureImporter::ImportImage(pathString, metadata);
+					imports.push_back({ &metadata, &pathString, ImportKind::TEXTURE, metadata, meshSettings, textureSettings });
 					updated = true;
 				}
 			}
 			else if (metadata.Type == ResourceType::MESH || MeshImporter::CheckIfIsModel(pathString.c_str())) {
 				if (metadata.IsOutdated || metadata.CachesPath.size() == 0) {
-					MeshImporter::ImportModel(pathString, metadata);
+					imports.push_back({ &metadata, &pathString, ImportKind::MESH, metadata, meshSettings, textureSettings });
 					updated = true;
 				}
 			}
 			else if (metadata.Type == ResourceType::MATERIAL || MaterialImporter::CheckIfIsMaterial(pathString.c_str())) {
 				if (metadata.IsOutdated || metadata.CachesPath.size() == 0) {
-					MaterialImporter::ImportMaterial(pathString, metadata);
+					imports.push_back({ &metadata, &pathString, ImportKind::MATERIAL, metadata, meshSettings, textureSettings });
 					updated = true;
 				}
 			}
@@ -85,11 +133,33 @@ namespace Loopie {
 
 
 			///
-			if (updated) {
-				Log::Info("{0}", pathString);
-				metadata.IsOutdated = false;
-				UpdateMetadata(metadata, pathString);
-			}
+			if (updated)
+				updatedAssets.push_back(&metadata);
+		}
+
+		if (!imports.empty()) {
+			// One job per asset, their cost varies too much to batch them evenly
+			auto start = std::chrono::steady_clock::now();
+
+			JobCounter counter;
+			for (PendingImport& import : imports)
+				JobSystem::Run(RunImport, &import, &counter);
+			JobSystem::Wait(counter);
+
+			for (PendingImport& import : imports)
+				*import.Target = std::move(import.Result);
+
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			Log::Info("Imported {0} assets in {1:.2f}s ({2:.1f} assets/s, {3} threads)", imports.size(), seconds,
+				seconds > 0.0 ? imports.size() / seconds : 0.0, std::max(JobSystem::GetThreadCount(), 1u));
+		}
+
+		// Registry and .meta writes stay on this thread
+		for (Metadata* metadata : updatedAssets) {
+			const std::string& pathString = s_UUIDToPath[metadata->UUID];
+			Log::Info("{0}", pathString);
+			metadata->IsOutdated = false;
+			UpdateMetadata(*metadata, pathString);
 		}
 
 		CleanOrphanedLibraryFiles();
@@ -21,6 +21,7 @@ namespace Loopie {
         static Metadata* GetMetadata(const UUID& uuid);
         static Metadata* GetMetadata(const std::string& sourcePath);
         static const std::string GetSourcePath(const UUID& uuid);
+        static const std::unordered_map<UUID, Metadata>& GetAllMetadata() { return s_Assets; }
 
         static bool UpdateMetadata(const Metadata& metadata, const std::filesystem::path& assetPath);
 
@@ -4,6 +4,7 @@
 #include "Loopie/Core/Application.h"
 #include "Loopie/Files/Json.h"
 #include "Loopie/Files/DirectoryManager.h"
+#include "Loopie/Resources/AssetPack.h"
 
 namespace Loopie {
 	Metadata MetadataRegistry::GetMetadataAsset(const std::string& assetPath)
@@ -35,7 +36,7 @@ namespace Loopie {
                 for (unsigned int i = 0; i < entries; i++)
                 {
                     std::string cachePath = cacheNode.GetArrayElement<std::string>(i).Result;
-                    if (!std::filesystem::exists(project.GetChachePath() / cachePath))
+                    if (!AssetPack::Contains(cachePath) && !std::filesystem::exists(project.GetChachePath() / cachePath))
                     {
                         metadata.CachesPath.clear();
                         metadata.HasCache = false;
@@ -2,6 +2,8 @@
 
 #include "Loopie/Core/UUID.h"
 #include "Loopie/Core/IIdentificable.h"
+#include "Loopie/Events/Event.h"
+#include "Loopie/Events/EventTypes.h"
 
 namespace Loopie {
 	enum ResourceType
@@ -28,6 +30,9 @@ namespace Loopie {
 		void DecrementReferenceCount();
 		unsigned int GetReferenceCount() const { return m_referenceCount; }	
 
+	public:
+		Event<ResourceNotification> m_resourceNotifier;
+
 	protected:
 		UUID m_uuid;
 		ResourceType m_type;
@@ -1,9 +1,20 @@
 #include "ResourceManager.h"
 
-
+#include "Loopie/Core/Application.h"
+#include "Loopie/Importers/MeshImporter.h"
+#include "Loopie/Resources/TextureStreamer.h"
 
 namespace Loopie {
+    struct ResourceManager::AsyncLoad {
+        std::shared_ptr<Mesh> TargetMesh;
+        std::filesystem::path CachePath; // Absolute, resolved on the main thread
+
+        MeshData MeshResult;
+        bool Succeeded = false;
+    };
+
 	std::unordered_map<ResourceKey, std::shared_ptr<Resource>, ResourceKeyHash> ResourceManager::m_Resources;
+    AsyncUploadQueue<ResourceManager::AsyncLoad> ResourceManager::s_Loads;
 
     std::shared_ptr<Texture> ResourceManager::GetTexture(const Metadata& metadata) {
         ResourceKey key{ metadata, 0 };
@@ -39,6 +50,58 @@ namespace Loopie {
         return material;
     }
 
+    std::shared_ptr<Texture> ResourceManager::GetTextureAsync(const Metadata& metadata) {
+        ResourceKey key{ metadata, 0 };
+        auto resource = GetResource(key);
+        if (resource) {
+            return std::static_pointer_cast<Texture>(resource);
+        }
+        auto texture = std::make_shared<Texture>(metadata.UUID, false);
+        m_Resources[key] = texture;
+
+        // Textures load their small mip levels first, the streamer brings in the rest as they are drawn
+        if (metadata.HasCache && !metadata.CachesPath.empty())
+            TextureStreamer::Register(texture, Application::GetInstance().m_activeProject.GetChachePath() / metadata.CachesPath[0]);
+        return texture;
+    }
+
+    std::shared_ptr<Mesh> ResourceManager::GetMeshAsync(const Metadata& metadata, int index) {
+        ResourceKey key{ metadata, index };
+        auto resource = GetResource(key);
+        if (resource) {
+            return std::static_pointer_cast<Mesh>(resource);
+        }
+        auto mesh = std::make_shared<Mesh>(metadata.UUID, index, false);
+        m_Resources[key] = mesh;
+
+        if (metadata.HasCache && index >= 0 && index < (int)metadata.CachesPath.size()) {
+            auto load = std::make_unique<AsyncLoad>();
+            load->TargetMesh = mesh;
+            load->CachePath = Application::GetInstance().m_activeProject.GetChachePath() / metadata.CachesPath[index];
+            s_Loads.Start(std::move(load), ReadAsyncLoad);
+        }
+        return mesh;
+    }
+
+    void ResourceManager::ProcessUploads(float budgetMs)
+    {
+        s_Loads.ProcessFinished(budgetMs, [](AsyncLoad& load) {
+            if (load.Succeeded && load.TargetMesh) {
+                MeshImporter::UploadModel(std::move(load.MeshResult), *load.TargetMesh);
+                load.TargetMesh->m_resourceNotifier.Notify(ResourceNotification::OnLoaded);
+            }
+        });
+    }
+
+    void ResourceManager::ReadAsyncLoad(void* userData)
+    {
+        std::unique_ptr<AsyncLoad> load(static_cast<AsyncLoad*>(userData));
+        if (load->TargetMesh)
+            load->Succeeded = MeshImporter::ReadModel(load->CachePath, load->MeshResult);
+
+        s_Loads.Push(std::move(load));
+    }
+
     std::shared_ptr<Resource> ResourceManager::GetResource(const ResourceKey& key) {
         auto it = m_Resources.find(key);
         if (it != m_Resources.end()) {
@@ -5,12 +5,16 @@
 #include "Loopie/Resources/Types/Material.h"
 #include "Loopie/Resources/Resource.h"
 #include "Loopie/Resources/AssetRegistry.h"
+#include "Loopie/Core/AsyncUploadQueue.h"
 
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 namespace Loopie {
 
+    constexpr float RESOURCE_UPLOAD_BUDGET_MS = 2.0f; // GL upload time ProcessUploads may spend per frame
+
     struct ResourceKey {
         Metadata metadata;
         int index = 0;
@@ -33,10 +37,27 @@ namespace Loopie {
         static std::shared_ptr<Material> GetMaterial(const Metadata& metadata);
         static void RemoveResource(Resource& resource);
 
+        // Return right away. The cache is read and decompressed by a job and uploaded to GL by
+        // ProcessUploads (TextureStreamer::Update for textures), meanwhile the resource draws as
+        // Texture::GetDefault / Mesh::GetDefault. OnLoaded is sent through the resource's
+        // m_resourceNotifier once it is ready.
+        static std::shared_ptr<Texture> GetTextureAsync(const Metadata& metadata);
+        static std::shared_ptr<Mesh> GetMeshAsync(const Metadata& metadata, int index);
+
+        // Uploads finished loads until budgetMs is spent (always at least one), call once per frame
+        // from the main thread
+        static void ProcessUploads(float budgetMs = RESOURCE_UPLOAD_BUDGET_MS);
+        static size_t GetPendingLoadCount() { return s_Loads.GetPendingCount(); }
+
     private:
+        struct AsyncLoad;
+
         static std::shared_ptr<Resource> GetResource(const ResourceKey& key);
+        static void ReadAsyncLoad(void* userData);
 
     private:
 		static std::unordered_map<ResourceKey, std::shared_ptr<Resource>, ResourceKeyHash> m_Resources;
+
+        static AsyncUploadQueue<AsyncLoad> s_Loads;
     };
 }
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "TextureStreamer.h"
+
+#include "Loopie/Core/Log.h"
+#include "Loopie/Importers/TextureImporter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Loopie {
+	namespace {
+		constexpr unsigned int NO_MIP = ~0u; // ResidentMip of a texture with nothing uploaded yet
+
+		class GLTextureStreamBackend : public TextureStreamBackend
+		{
+		public:
+			bool ReadInfo(const std::filesystem::path& cachePath, TextureData& data) override
+			{
+				return TextureImporter::ReadImageInfo(cachePath, data);
+			}
+
+			bool ReadLevels(const std::filesystem::path& cachePath, TextureData& data, unsigned int firstMip) override
+			{
+				return TextureImporter::ReadImage(cachePath, data, firstMip);
+			}
+
+			void Upload(const TextureData& data, Texture& texture) override
+			{
+				TextureImporter::UploadImage(data, texture);
+			}
+
+			void Trim(Texture& texture, unsigned int firstMip) override
+			{
+				texture.TrimMips(firstMip);
+			}
+		};
+	}
+
+	struct TextureStreamer::StreamedTexture {
+		std::weak_ptr<Texture> Target;
+		std::filesystem::path CachePath;
+		TextureData Info; // Size and format, Pixels stays empty
+
+		unsigned int BaseMip = 0; // Loaded first and never dropped
+		unsigned int ResidentMip = NO_MIP; // Largest level uploaded
+		unsigned int WantedMip = 0; // For the last frame it was drawn in
+		size_t PendingMemory = 0; // Added by the load in flight
+		bool Loading = false;
+		bool Failed = false;
+
+		float ScreenSize = 0.0f;
+		uint64_t LastUsedFrame = 0;
+	};
+
+	struct TextureStreamer::StreamLoad {
+		std::weak_ptr<Texture> Target;
+		std::filesystem::path CachePath;
+		TextureStreamBackend* Backend = nullptr;
+		unsigned int FirstMip = NO_MIP; // NO_MIP reads the header and starts at the base level
+
+		TextureData Result;
+		bool Succeeded = false;
+	};
+
+	std::unordered_map<const Texture*, TextureStreamer::StreamedTexture> TextureStreamer::s_textures;
+	std::unique_ptr<TextureStreamBackend> TextureStreamer::s_backend = std::make_unique<GLTextureStreamBackend>();
+
+	AsyncUploadQueue<TextureStreamer::StreamLoad> TextureStreamer::s_loads;
+
+	size_t TextureStreamer::s_memoryBudget = TEXTURE_STREAMING_DEFAULT_BUDGET;
+	size_t TextureStreamer::s_residentMemory = 0;
+	size_t TextureStreamer::s_pendingMemory = 0;
+	uint64_t TextureStreamer::s_frame = 1;
+
+	bool TextureStreamer::SetBackend(std::unique_ptr<TextureStreamBackend> backend)
+	{
+		// Every load holds a raw pointer to the backend it started with until FinishLoad
+		if (s_loads.GetPendingCount() > 0) {
+			Log::Warn("Texture stream backend not changed, {0} loads in flight", s_loads.GetPendingCount());
+			return false;
+		}
+		s_backend = backend ? std::move(backend) : std::make_unique<GLTextureStreamBackend>();
+		return true;
+	}
+
+	void TextureStreamer::Register(const std::shared_ptr<Texture>& texture, const std::filesystem::path& cachePath)
+	{
+		if (!texture)
+			return;
+
+		auto it = s_textures.find(texture.get());
+		if (it != s_textures.end()) {
+			if (!it->second.Target.expired())
+				return;
+			// The texture it tracked died before Update could drop it and this one reused the address
+			ReleaseRecord(it->second);
+			s_textures.erase(it);
+		}
+
+		StreamedTexture& record = s_textures[texture.get()];
+		record.Target = texture;
+		record.CachePath = cachePath;
+		StartLoad(record, NO_MIP);
+	}
+
+	void TextureStreamer::RequestTexture(const Texture& texture, float screenSize)
+	{
+		auto it = s_textures.find(&texture);
+		if (it == s_textures.end())
+			return;
+
+		StreamedTexture& record = it->second;
+		if (record.LastUsedFrame != s_frame) {
+			record.LastUsedFrame = s_frame;
+			record.ScreenSize = screenSize;
+		}
+		else {
+			record.ScreenSize = std::max(record.ScreenSize, screenSize);
+		}
+	}
+
+	float TextureStreamer::EstimateScreenSize(const matrix4& viewProjection, const vec4& viewport, const AABB& bounds)
+	{
+		vec2 minPoint(1.0f);
+		vec2 maxPoint(-1.0f);
+		for (int i = 0; i < 8; ++i) {
+			vec3 corner((i & 1) ? bounds.MaxPoint.x : bounds.MinPoint.x,
+						(i & 2) ? bounds.MaxPoint.y : bounds.MinPoint.y,
+						(i & 4) ? bounds.MaxPoint.z : bounds.MinPoint.z);
+			vec4 clip = viewProjection * vec4(corner, 1.0f);
+			if (clip.w <= 0.0f)
+				return std::max(viewport.z, viewport.w);
+
+			vec2 ndc = vec2(clip.x, clip.y) / clip.w;
+			minPoint = glm::min(minPoint, ndc);
+			maxPoint = glm::max(maxPoint, ndc);
+		}
+
+		minPoint = glm::clamp(minPoint, vec2(-1.0f), vec2(1.0f));
+		maxPoint = glm::clamp(maxPoint, vec2(-1.0f), vec2(1.0f));
+		vec2 size = glm::max(maxPoint - minPoint, vec2(0.0f)) * 0.5f * vec2(viewport.z, viewport.w);
+		return std::max(size.x, size.y);
+	}
+
+	unsigned int TextureStreamer::GetWantedMip(int width, int height, float screenSize, unsigned int baseMip)
+	{
+		if (screenSize < 1.0f)
+			return baseMip;
+
+		float ratio = std::max(width, height) / screenSize;
+		if (ratio <= 1.0f)
+			return 0;
+		return std::min(static_cast<unsigned int>(std::log2(ratio)), baseMip);
+	}
+
+	void TextureStreamer::Update(float budgetMs)
+	{
+		// *** Uploads ***
+		s_loads.ProcessFinished(budgetMs, FinishLoad);
+
+		// Textures nobody holds anymore, their GL textures are already gone
+		for (auto it = s_textures.begin(); it != s_textures.end();) {
+			StreamedTexture& record = it->second;
+			if (record.Target.expired()) {
+				ReleaseRecord(record);
+				it = s_textures.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
+		// *** Promotions ***
+		// The largest textures on screen first. When the budget can't fit the wanted level, even after
+		// dropping what wasn't drawn, a smaller one is tried
+		std::vector<StreamedTexture*> promotions;
+		for (auto& [texture, record] : s_textures) {
+			if (record.LastUsedFrame != s_frame || record.ResidentMip == NO_MIP)
+				continue;
+			record.WantedMip = GetWantedMip(record.Info.Width, record.Info.Height, record.ScreenSize, record.BaseMip);
+			if (record.WantedMip < record.ResidentMip && !record.Loading && !record.Failed)
+				promotions.push_back(&record);
+		}
+		std::sort(promotions.begin(), promotions.end(), [](const StreamedTexture* a, const StreamedTexture* b) { return a->ScreenSize > b->ScreenSize; });
+
+		for (StreamedTexture* record : promotions) {
+			if (s_loads.GetPendingCount() >= TEXTURE_STREAMING_MAX_PENDING)
+				break;
+
+			size_t residentSize = GetLevelsSize(record->Info, record->ResidentMip);
+			unsigned int mip = record->WantedMip;
+			size_t extraSize = 0;
+			for (; mip < record->ResidentMip; ++mip) {
+				extraSize = GetLevelsSize(record->Info, mip) - residentSize;
+				size_t required = s_residentMemory + s_pendingMemory + extraSize;
+				if (required <= s_memoryBudget || FreeMemory(required - s_memoryBudget, record))
+					break;
+			}
+			if (mip == record->ResidentMip)
+				continue;
+
+			record->PendingMemory = extraSize;
+			s_pendingMemory += extraSize;
+			StartLoad(*record, mip);
+		}
+
+		// The budget may have been lowered
+		if (s_residentMemory + s_pendingMemory > s_memoryBudget)
+			FreeMemory(s_residentMemory + s_pendingMemory - s_memoryBudget, nullptr);
+
+		++s_frame;
+	}
+
+	void TextureStreamer::LogStatistics()
+	{
+		size_t fullResolution = 0;
+		for (const auto& [texture, record] : s_textures) {
+			if (record.ResidentMip == 0)
+				++fullResolution;
+		}
+		Log::Info("Texture Streaming -> {0} textures ({1} at full resolution), {2:.2f}MB / {3:.2f}MB resident, {4} loads pending",
+			s_textures.size(), fullResolution, s_residentMemory / (1024.0 * 1024.0), s_memoryBudget / (1024.0 * 1024.0), s_loads.GetPendingCount());
+	}
+
+	void TextureStreamer::StartLoad(StreamedTexture& record, unsigned int firstMip)
+	{
+		auto load = std::make_unique<StreamLoad>();
+		load->Target = record.Target;
+		load->CachePath = record.CachePath;
+		load->Backend = s_backend.get();
+		load->FirstMip = firstMip;
+
+		record.Loading = true;
+		s_loads.Start(std::move(load), ReadLoad);
+	}
+
+	void TextureStreamer::ReadLoad(void* userData)
+	{
+		std::unique_ptr<StreamLoad> load(static_cast<StreamLoad*>(userData));
+		if (load->FirstMip == NO_MIP) {
+			TextureData info;
+			if (load->Backend->ReadInfo(load->CachePath, info)) {
+				// First level at most TEXTURE_STREAMING_BASE_SIZE, as long as the cache can start there
+				unsigned int baseMip = 0;
+				while (baseMip + 1 < info.MipCount && std::max(info.Width >> baseMip, info.Height >> baseMip) > TEXTURE_STREAMING_BASE_SIZE)
+					++baseMip;
+				load->FirstMip = std::min(baseMip, info.FirstMip);
+			}
+		}
+		if (load->FirstMip != NO_MIP)
+			load->Succeeded = load->Backend->ReadLevels(load->CachePath, load->Result, load->FirstMip);
+
+		s_loads.Push(std::move(load));
+	}
+
+	void TextureStreamer::FinishLoad(StreamLoad& load)
+	{
+		std::shared_ptr<Texture> texture = load.Target.lock();
+		auto it = texture ? s_textures.find(texture.get()) : s_textures.end();
+		if (it == s_textures.end())
+			return;
+
+		StreamedTexture& record = it->second;
+		record.Loading = false;
+		s_pendingMemory -= record.PendingMemory;
+		record.PendingMemory = 0;
+
+		if (!load.Succeeded) {
+			// Keeps whatever it has, retrying every frame would only repeat the warning
+			record.Failed = true;
+			Log::Warn("Failed to stream texture {0}", load.CachePath.string());
+			return;
+		}
+
+		bool firstLoad = record.ResidentMip == NO_MIP;
+		if (firstLoad) {
+			record.Info.Width = load.Result.Width;
+			record.Info.Height = load.Result.Height;
+			record.Info.Channels = load.Result.Channels;
+			record.Info.Compression = load.Result.Compression;
+			record.Info.MipCount = load.Result.MipCount;
+			record.BaseMip = load.Result.FirstMip;
+		}
+		else {
+			s_residentMemory -= GetLevelsSize(record.Info, record.ResidentMip);
+		}
+
+		load.Backend->Upload(load.Result, *texture);
+		record.ResidentMip = load.Result.FirstMip;
+		s_residentMemory += GetLevelsSize(record.Info, record.ResidentMip);
+
+		if (firstLoad)
+			texture->m_resourceNotifier.Notify(ResourceNotification::OnLoaded);
+	}
+
+	bool TextureStreamer::FreeMemory(size_t bytes, const StreamedTexture* keep)
+	{
+		// Least recently drawn first. Textures drawn last frame only give up levels they no longer need,
+		// unless nothing is being promoted (keep is nullptr) and the budget can't be met otherwise
+		std::vector<StreamedTexture*> candidates;
+		for (auto& [texture, record] : s_textures) {
+			if (&record != keep && !record.Loading && record.ResidentMip < record.BaseMip)
+				candidates.push_back(&record);
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const StreamedTexture* a, const StreamedTexture* b) {
+			return a->LastUsedFrame != b->LastUsedFrame ? a->LastUsedFrame < b->LastUsedFrame : a->ScreenSize < b->ScreenSize;
+		});
+
+		size_t freed = 0;
+		for (int pass = 0; pass < (keep ? 1 : 2); ++pass) {
+			for (StreamedTexture* record : candidates) {
+				std::shared_ptr<Texture> texture = record->Target.lock();
+				if (!texture)
+					continue;
+
+				unsigned int lowestMip = record->LastUsedFrame == s_frame && pass == 0 ? record->WantedMip : record->BaseMip;
+				while (record->ResidentMip < lowestMip && freed < bytes) {
+					size_t levelSize = GetLevelsSize(record->Info, record->ResidentMip) - GetLevelsSize(record->Info, record->ResidentMip + 1);
+					s_backend->Trim(*texture, record->ResidentMip + 1);
+					++record->ResidentMip;
+					s_residentMemory -= levelSize;
+					freed += levelSize;
+				}
+				if (freed >= bytes)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void TextureStreamer::ReleaseRecord(const StreamedTexture& record)
+	{
+		// A load still in flight finds its target expired in FinishLoad and is only counted out of the pending loads
+		if (record.ResidentMip != NO_MIP)
+			s_residentMemory -= GetLevelsSize(record.Info, record.ResidentMip);
+		s_pendingMemory -= record.PendingMemory;
+	}
+
+	size_t TextureStreamer::GetLevelsSize(const TextureData& info, unsigned int firstMip)
+	{
+		size_t size = 0;
+		for (unsigned int i = firstMip; i < info.MipCount; ++i)
+			size += GetTextureLevelSize(info.Compression, std::max(1, info.Width >> i), std::max(1, info.Height >> i), info.Channels);
+		return size;
+	}
+}
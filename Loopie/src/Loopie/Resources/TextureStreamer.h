@@ -0,0 +1,96 @@
+#pragma once
+#include "Loopie/Core/AsyncUploadQueue.h"
+#include "Loopie/Math/AABB.h"
+#include "Loopie/Math/MathTypes.h"
+#include "Loopie/Resources/Types/Texture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Loopie {
+	constexpr size_t TEXTURE_STREAMING_DEFAULT_BUDGET = size_t(256) * 1024 * 1024; // Bytes of mip levels on the GPU
+	constexpr int TEXTURE_STREAMING_BASE_SIZE = 64; // The first load stops at the first level this size or smaller
+	constexpr unsigned int TEXTURE_STREAMING_MAX_PENDING = 8; // Level loads in flight at once
+	constexpr float TEXTURE_STREAMING_UPLOAD_BUDGET_MS = 2.0f; // GL upload time Update may spend per frame
+
+	// Where the TextureStreamer reads and uploads levels. The default one goes through TextureImporter
+	// and GL, replacing it lets the streaming decisions run without a GL context.
+	class TextureStreamBackend
+	{
+	public:
+		virtual ~TextureStreamBackend() = default;
+
+		// Header only. data.FirstMip is the smallest level ReadLevels can start at. Runs on a job thread
+		virtual bool ReadInfo(const std::filesystem::path& cachePath, TextureData& data) = 0;
+		// Levels from firstMip down. Runs on a job thread
+		virtual bool ReadLevels(const std::filesystem::path& cachePath, TextureData& data, unsigned int firstMip) = 0;
+		// Replaces whatever the texture had with data. Main thread
+		virtual void Upload(const TextureData& data, Texture& texture) = 0;
+		// Drops the levels above firstMip. Main thread
+		virtual void Trim(Texture& texture, unsigned int firstMip) = 0;
+	};
+
+	// *** Texture streamer ***
+	// Keeps the mip levels textures need on screen and no more. A texture starts with only its small
+	// levels (from TEXTURE_STREAMING_BASE_SIZE down), the renderer reports how many pixels each texture
+	// covers every frame and Update reads the larger levels in jobs. Once the resident levels pass the
+	// memory budget the least recently drawn textures go back down one level at a time, never below
+	// their base level.
+	class TextureStreamer
+	{
+	public:
+		// Refused (returns false) while loads are in flight, they keep using the current backend.
+		// nullptr goes back to the default backend
+		static bool SetBackend(std::unique_ptr<TextureStreamBackend> backend);
+
+		static void SetMemoryBudget(size_t bytes) { s_memoryBudget = bytes; }
+		static size_t GetMemoryBudget() { return s_memoryBudget; }
+		static size_t GetResidentMemory() { return s_residentMemory; }
+		static size_t GetTextureCount() { return s_textures.size(); }
+		static size_t GetPendingLoadCount() { return s_loads.GetPendingCount(); }
+
+		// Starts loading the base levels, OnLoaded is sent once they are uploaded. The texture draws as
+		// Texture::GetDefault meanwhile
+		static void Register(const std::shared_ptr<Texture>& texture, const std::filesystem::path& cachePath);
+		// The texture is drawn this frame covering screenSize pixels along its longest side
+		static void RequestTexture(const Texture& texture, float screenSize);
+
+		// Pixels the bounds cover along the longest side of the viewport (x, y, width, height).
+		// Bounds crossing the camera plane count as the whole viewport
+		static float EstimateScreenSize(const matrix4& viewProjection, const vec4& viewport, const AABB& bounds);
+		// Largest level worth having for a texture covering screenSize pixels, clamped to [0, baseMip]
+		static unsigned int GetWantedMip(int width, int height, float screenSize, unsigned int baseMip);
+
+		// Once per frame from the main thread: uploads finished loads and acts on the previous frame's requests
+		static void Update(float budgetMs = TEXTURE_STREAMING_UPLOAD_BUDGET_MS);
+
+		static void LogStatistics();
+
+	private:
+		struct StreamedTexture;
+		struct StreamLoad;
+
+		static void StartLoad(StreamedTexture& record, unsigned int firstMip);
+		static void ReadLoad(void* userData);
+		static void FinishLoad(StreamLoad& load);
+		static bool FreeMemory(size_t bytes, const StreamedTexture* keep);
+		// Takes the record's resident and pending levels off the totals, before erasing it
+		static void ReleaseRecord(const StreamedTexture& record);
+		static size_t GetLevelsSize(const TextureData& info, unsigned int firstMip);
+
+	private:
+		static std::unordered_map<const Texture*, StreamedTexture> s_textures;
+		static std::unique_ptr<TextureStreamBackend> s_backend;
+
+		static AsyncUploadQueue<StreamLoad> s_loads;
+
+		static size_t s_memoryBudget;
+		static size_t s_residentMemory; // Uploaded levels of every streamed texture
+		static size_t s_pendingMemory; // Levels being read that will add to it
+		static uint64_t s_frame;
+	};
+}
@@ -10,9 +10,11 @@ namespace Loopie
 {
 
 	std::shared_ptr<Material> Material::s_Material = nullptr;
+	uint32_t Material::s_NextSortId = 0;
 
 	Material::Material(const UUID& id) : Resource(id, ResourceType::MATERIAL)
 	{
+		m_sortId = s_NextSortId++;
 		ResetMaterial();
 		Load();
 	}
@@ -46,8 +48,12 @@ namespace Loopie
 		}
 
 		m_shader.Bind();
+		BindResources();
+	}
 
-		if (m_texture)
+	void Material::BindResources()
+	{
+		if (m_texture && m_texture->IsLoaded())
 		{
 			m_texture->m_tb->Bind();
 		}
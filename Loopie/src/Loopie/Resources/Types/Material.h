@@ -24,6 +24,8 @@ namespace Loopie
 		static std::shared_ptr<Material> GetDefault();
 
 		void Bind();
+		// Texture and uniforms only, for when this material's shader is already bound
+		void BindResources();
 		void Unbind() const;
 
 		bool Load() override;
@@ -36,6 +38,7 @@ namespace Loopie
 		std::shared_ptr<Texture> GetTexture() const { return m_texture; } /// Remove
 		UniformValue* GetShaderVariable(const std::string& name);
 		const std::unordered_map<std::string, UniformValue>& GetUniforms() const { return m_uniformValues; }
+		uint32_t GetSortId() const { return m_sortId; } // Small per material id for render sort keys
 
 		// Setters
 		void SetShader(const Shader& shader);
@@ -58,8 +61,10 @@ namespace Loopie
 		// to be different for all different kinds of textures, which can be changed like this)
 		std::unordered_map<std::string, UniformValue> m_uniformValues;
 		bool m_editable = true;
+		uint32_t m_sortId = 0;
 
 
 		static std::shared_ptr<Material> s_Material;
+		static uint32_t s_NextSortId;
 	};
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Loopie/Core/Log.h"
 #include "Loopie/Resources/AssetRegistry.h"
+#include "Loopie/Resources/ResourceManager.h"
 #include "Loopie/Importers/MeshImporter.h"
 
 #include <fstream>
@@ -9,10 +10,14 @@
 #include <filesystem>
 
 namespace Loopie {
-	Mesh::Mesh(const UUID& id, unsigned int index) : Resource(id,ResourceType::MESH)
+
+	std::shared_ptr<Mesh> Mesh::s_Mesh = nullptr;
+
+	Mesh::Mesh(const UUID& id, unsigned int index, bool loadNow) : Resource(id,ResourceType::MESH)
 	{
 		m_meshIndex = index;
-		Load();
+		if (loadNow)
+			Load();
 	}
 
 	bool Mesh::Load()
@@ -24,4 +29,23 @@ namespace Loopie {
 		}
 		return false;
 	}
+
+	const std::shared_ptr<VertexArray> Mesh::GetVAO()
+	{
+		if (!m_vao && this != s_Mesh.get())
+			return GetDefault()->m_vao;
+		return m_vao;
+	}
+
+	std::shared_ptr<Mesh> Mesh::GetDefault()
+	{
+		if (s_Mesh)
+			return s_Mesh;
+		Metadata& metadata = AssetRegistry::GetOrCreateMetadata("assets/models/primitives/cube.fbx");
+		if (!metadata.HasCache) {
+			MeshImporter::ImportModel("assets/models/primitives/cube.fbx", metadata);
+		}
+		s_Mesh = ResourceManager::GetMesh(metadata, 0);
+		return s_Mesh;
+	}
 }
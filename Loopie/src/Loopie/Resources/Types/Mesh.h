@@ -3,11 +3,13 @@
 #include "Loopie/Math/MathTypes.h"
 #include "Loopie/Math/AABB.h"
 #include "Loopie/Math/OBB.h"
+#include "Loopie/Math/BVH.h"
 
 #include "Loopie/Render/IndexBuffer.h"
 #include "Loopie/Render/VertexBuffer.h"
 #include "Loopie/Render/VertexArray.h"
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -31,8 +33,17 @@ namespace Loopie {
 		bool HasTangent = false;
 		bool HasColor = false;
 
-		std::vector<float> Vertices;
+		// Packed GPU layout: half float uvs, 10:10:10:2 normals and tangents, RGBA8 colors and,
+		// with QuantizedPositions, 16 bit positions relative to the bounding box
+		bool CompactAttributes = false;
+		bool QuantizedPositions = false;
+		bool ShortIndices = false; // Stored and drawn as uint16, Indices itself is always uint32
+
+		std::vector<float> Vertices; // Interleaved attributes, only the positions when CompactAttributes
 		std::vector<unsigned int> Indices;
+		std::vector<uint8_t> PackedVertices; // Vertex buffer contents when CompactAttributes, dropped after the upload
+
+		BVH TriangleBVH; // Mesh space, used for triangle ray queries
 
 	};
 	
@@ -42,14 +53,21 @@ namespace Loopie {
 	public :
 		DEFINE_TYPE(Mesh)
 
-		Mesh(const UUID& id, unsigned int index);
+		// loadNow = false leaves the mesh empty for ResourceManager::GetMeshAsync to fill
+		Mesh(const UUID& id, unsigned int index, bool loadNow = true);
 		~Mesh() = default;
 
+		// Drawn in place of meshes that are still loading
+		static std::shared_ptr<Mesh> GetDefault();
+
 		bool Load() override;
 
+		bool IsLoaded() const { return m_vao != nullptr; }
+		// Empty until the mesh is loaded
 		const MeshData& GetData() { return m_data; }
 		unsigned int GetMeshIndex() { return m_meshIndex; }
-		const std::shared_ptr<VertexArray> GetVAO() { return m_vao; }
+		// Falls back to the default mesh while the mesh is still loading
+		const std::shared_ptr<VertexArray> GetVAO();
 	private:
 		MeshData m_data;
 
@@ -59,5 +77,7 @@ namespace Loopie {
 
 		unsigned int m_meshIndex = 0;
 
+		static std::shared_ptr<Mesh> s_Mesh;
+
 	};
 }
\ No newline at end of file
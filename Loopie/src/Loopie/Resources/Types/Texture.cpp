@@ -12,8 +12,9 @@ namespace Loopie {
 
 	std::shared_ptr<Texture> Texture::s_Texture = nullptr;
 
-	Texture::Texture(const UUID& id) : Resource(id, ResourceType::TEXTURE) {
-		Load();
+	Texture::Texture(const UUID& id, bool loadNow) : Resource(id, ResourceType::TEXTURE) {
+		if (loadNow)
+			Load();
 	}
 
 	bool Texture::Load()
@@ -26,6 +27,24 @@ namespace Loopie {
 		return false;
 	}
 
+	void Texture::TrimMips(unsigned int firstMip)
+	{
+		if (!m_tb || firstMip <= m_firstMip)
+			return;
+		std::shared_ptr<TextureBuffer> trimmed = m_tb->CopyLevels(firstMip - m_firstMip);
+		if (!trimmed)
+			return;
+		m_tb = trimmed;
+		m_firstMip = firstMip;
+	}
+
+	unsigned int Texture::GetRendererId()
+	{
+		if (!m_tb && this != s_Texture.get())
+			return GetDefault()->GetRendererId();
+		return m_tb->GetRendererID();
+	}
+
 	std::shared_ptr<Texture> Texture::GetDefault() {
 		if (s_Texture)
 			return s_Texture;
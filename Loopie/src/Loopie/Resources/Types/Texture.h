@@ -9,13 +9,25 @@
 
 namespace Loopie {
 
+	// Pixels of a .texture cache after decompression, ready to upload
+	struct TextureData {
+		int Width = 0;
+		int Height = 0;
+		int Channels = 0;
+		TextureCompression Compression = TextureCompression::NONE;
+		unsigned int MipCount = 1;
+		unsigned int FirstMip = 0; // Largest level in Pixels, the ones above it were not read
+		std::vector<unsigned char> Pixels; // Mip levels back to back from FirstMip, largest first
+	};
+
 	class Texture : public Resource {
 		friend class Material;
 		friend class TextureImporter;
 	public:
 		DEFINE_TYPE(Texture)
 
-		Texture(const UUID& id);
+		// loadNow = false leaves the texture empty for ResourceManager::GetTextureAsync to fill
+		Texture(const UUID& id, bool loadNow = true);
 		~Texture() = default;
 
 		static std::shared_ptr<Texture> GetDefault();
@@ -23,13 +35,20 @@ namespace Loopie {
 		bool Load() override;
 
 		ivec2 GetSize() { return ivec2(m_width, m_height); }
-
-		unsigned int GetRendererId() { return m_tb->GetRendererID(); }
+		// Largest mip on the GPU, above 0 while the TextureStreamer keeps the texture at a lower resolution
+		unsigned int GetFirstMip() const { return m_firstMip; }
+		// Drops the levels above firstMip, the remaining ones are copied on the GPU
+		void TrimMips(unsigned int firstMip);
+
+		bool IsLoaded() const { return m_tb != nullptr; }
+		// Falls back to the default texture while the texture is still loading
+		unsigned int GetRendererId();
 	private:
 		//std::vector<unsigned char> m_pixels;
 		int m_width = 0;
 		int m_height = 0;
 		int m_channels = 0;
+		unsigned int m_firstMip = 0;
 
 		std::shared_ptr<TextureBuffer> m_tb;
 
@@ -0,0 +1,155 @@
+#pragma once
+#include "Loopie/Components/Component.h"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Loopie {
+	class Entity;
+
+	constexpr uint32_t COMPONENT_POOL_CHUNK_SIZE = 64;
+	constexpr uint32_t COMPONENT_INVALID_SLOT = UINT32_MAX;
+
+	class IComponentPool
+	{
+	public:
+		virtual ~IComponentPool() = default;
+		// Destroys a component created by this pool and frees its slot
+		virtual void Release(Component* component) = 0;
+	};
+
+	// *** Component pool ***
+	// Components of one type are constructed in place inside fixed size chunks, so their
+	// addresses never change (observers and the editor keep raw pointers to them) and
+	// neighbours in a chunk are neighbours in memory. m_dense lists the live ones packed
+	// together with their owners, which is what Scene::View walks.
+	template<typename T>
+	class ComponentPool : public IComponentPool
+	{
+	public:
+		template<typename... Args>
+		T* Emplace(Entity* owner, Args&&... args)
+		{
+			uint32_t slot;
+			if (!m_freeSlots.empty()) {
+				slot = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			else {
+				slot = static_cast<uint32_t>(m_slotToDense.size());
+				if (slot % COMPONENT_POOL_CHUNK_SIZE == 0)
+					m_chunks.push_back(std::make_unique<Chunk>());
+				m_slotToDense.push_back(COMPONENT_INVALID_SLOT);
+			}
+
+			T* component = new (GetSlotAddress(slot)) T(std::forward<Args>(args)...);
+			component->m_registrySlot = slot;
+
+			m_slotToDense[slot] = static_cast<uint32_t>(m_dense.size());
+			m_dense.push_back(component);
+			m_owners.push_back(owner);
+			return component;
+		}
+
+		void Release(Component* component) override
+		{
+			uint32_t slot = component->m_registrySlot;
+			uint32_t denseIndex = m_slotToDense[slot];
+			uint32_t lastIndex = static_cast<uint32_t>(m_dense.size() - 1);
+
+			if (denseIndex != lastIndex) {
+				m_dense[denseIndex] = m_dense[lastIndex];
+				m_owners[denseIndex] = m_owners[lastIndex];
+				m_slotToDense[m_dense[denseIndex]->m_registrySlot] = denseIndex;
+			}
+			m_dense.pop_back();
+			m_owners.pop_back();
+			m_slotToDense[slot] = COMPONENT_INVALID_SLOT;
+
+			static_cast<T*>(component)->~T();
+			m_freeSlots.push_back(slot);
+		}
+
+		size_t Size() const { return m_dense.size(); }
+		T* GetComponent(size_t index) const { return m_dense[index]; }
+		Entity* GetOwner(size_t index) const { return m_owners[index]; }
+
+	private:
+		struct Chunk
+		{
+			alignas(T) unsigned char Storage[sizeof(T) * COMPONENT_POOL_CHUNK_SIZE];
+		};
+
+		void* GetSlotAddress(uint32_t slot)
+		{
+			return m_chunks[slot / COMPONENT_POOL_CHUNK_SIZE]->Storage + sizeof(T) * (slot % COMPONENT_POOL_CHUNK_SIZE);
+		}
+
+	private:
+		std::vector<std::unique_ptr<Chunk>> m_chunks;
+		std::vector<uint32_t> m_freeSlots;
+		std::vector<uint32_t> m_slotToDense;
+		std::vector<T*> m_dense;
+		std::vector<Entity*> m_owners;
+	};
+
+	// Deleter used by Entity for its components. Pooled components go back to their pool,
+	// the pool is shared so it stays alive while any entity still holds one of its components.
+	struct ComponentDeleter
+	{
+		std::shared_ptr<IComponentPool> Pool;
+
+		void operator()(Component* component) const
+		{
+			if (Pool)
+				Pool->Release(component);
+			else
+				delete component;
+		}
+	};
+
+	using ComponentPtr = std::unique_ptr<Component, ComponentDeleter>;
+
+	// Owns one pool per component type, Scene holds one and hands it to its entities
+	class ComponentRegistry
+	{
+	public:
+		template<typename T>
+		ComponentPool<T>& GetPool()
+		{
+			return static_cast<ComponentPool<T>&>(*GetPoolHandle<T>());
+		}
+
+		template<typename T>
+		const ComponentPool<T>* FindPool() const
+		{
+			auto it = m_pools.find(T::GetTypeIDStatic());
+			return it != m_pools.end() ? static_cast<const ComponentPool<T>*>(it->second.get()) : nullptr;
+		}
+
+		template<typename T, typename... Args>
+		ComponentPtr Emplace(Entity* owner, Args&&... args)
+		{
+			std::shared_ptr<IComponentPool>& pool = GetPoolHandle<T>();
+			T* component = static_cast<ComponentPool<T>&>(*pool).Emplace(owner, std::forward<Args>(args)...);
+			return ComponentPtr(component, ComponentDeleter{ pool });
+		}
+
+	private:
+		template<typename T>
+		std::shared_ptr<IComponentPool>& GetPoolHandle()
+		{
+			std::shared_ptr<IComponentPool>& pool = m_pools[T::GetTypeIDStatic()];
+			if (!pool)
+				pool = std::make_shared<ComponentPool<T>>();
+			return pool;
+		}
+
+	private:
+		std::unordered_map<size_t, std::shared_ptr<IComponentPool>> m_pools; // Keyed by component type id
+	};
+}
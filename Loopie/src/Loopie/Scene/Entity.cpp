@@ -13,6 +13,7 @@ namespace Loopie {
 	Entity::~Entity()
 	{
 		m_components.clear();
+		m_componentTypes.clear();
 		m_childrenEntities.clear();
 	}
 
@@ -25,6 +26,7 @@ namespace Loopie {
 		{
 			if (m_components[i].get() == component) {
 				m_components.erase(m_components.begin() + i);
+				m_componentTypes.erase(m_componentTypes.begin() + i);
 				return true;
 			}
 		}
@@ -43,6 +45,8 @@ namespace Loopie {
 
 			m_childrenEntities.push_back(child);
 			child->m_parentEntity = weak_from_this();
+			if (child->m_transform)
+				child->m_transform->OnParentChanged(m_transform);
 		}
 	}
 
@@ -52,6 +56,8 @@ namespace Loopie {
 		if (it != m_childrenEntities.end())
 		{
 			(*it)->m_parentEntity.reset();
+			if ((*it)->m_transform)
+				(*it)->m_transform->OnParentChanged(nullptr);
 			m_childrenEntities.erase(it);
 		}
 	}
@@ -63,6 +69,8 @@ namespace Loopie {
 			if ((*it)->GetUUID() == childUuid)
 			{
 				(*it)->m_parentEntity.reset();
+				if ((*it)->m_transform)
+					(*it)->m_transform->OnParentChanged(nullptr);
 				m_childrenEntities.erase(it);
 				return;
 			}
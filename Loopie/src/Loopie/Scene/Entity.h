@@ -2,6 +2,7 @@
 
 #include "Loopie/Core/UUID.h"
 #include "Loopie/Core/IIdentificable.h"
+#include "Loopie/Scene/ComponentRegistry.h"
 
 #include <string>
 #include <vector>
@@ -16,6 +17,7 @@ namespace Loopie {
 	/// Maybe Add a CopyComponent
 	class Entity : public std::enable_shared_from_this<Entity>
 	{
+		friend class Scene;
 	public:
 		Entity(const std::string& name);
 		~Entity();
@@ -28,7 +30,12 @@ namespace Loopie {
 					return GetTransform();
 			}
 
-			m_components.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+			// Entities of a scene keep their components in the scene's registry, loose entities on the heap
+			if (std::shared_ptr<ComponentRegistry> registry = m_registry.lock())
+				m_components.push_back(registry->Emplace<T>(this, std::forward<Args>(args)...));
+			else
+				m_components.push_back(ComponentPtr(new T(std::forward<Args>(args)...)));
+			m_componentTypes.push_back(T::GetTypeIDStatic());
 			T* componentPtr = static_cast<T*>(m_components.back().get());
 
 			componentPtr->m_owner = weak_from_this();
@@ -45,9 +52,12 @@ namespace Loopie {
 		template<typename T, typename = std::enable_if_t<std::is_base_of_v<Component, T>>>
 		T* GetComponent() const
 		{
-			for (const auto& component : m_components) {
-				if (component->GetTypeID() == T::GetTypeIDStatic())
-					return static_cast<T*>(component.get());
+			if constexpr (std::is_same_v<T, Transform>)
+				return m_transform;
+
+			for (size_t i = 0; i < m_componentTypes.size(); i++) {
+				if (m_componentTypes[i] == T::GetTypeIDStatic())
+					return static_cast<T*>(m_components[i].get());
 			}
 			
 			return nullptr;
@@ -66,10 +76,11 @@ namespace Loopie {
 			if constexpr (std::is_same_v<T, Transform>)
 				return false;
 
-			for (size_t i = 0; i < m_components.size(); i++)
+			for (size_t i = 0; i < m_componentTypes.size(); i++)
 			{
-				if (m_components[i]->GetTypeID() == T::GetTypeIDStatic()){
+				if (m_componentTypes[i] == T::GetTypeIDStatic()){
 					m_components.erase(m_components.begin() + i);
+					m_componentTypes.erase(m_componentTypes.begin() + i);
 					return true;
 				}
 			}
@@ -105,7 +116,9 @@ namespace Loopie {
 	private:
 		std::weak_ptr<Entity> m_parentEntity;
 		std::vector<std::shared_ptr<Entity>> m_childrenEntities;
-		std::vector<std::unique_ptr<Component>> m_components; // Might want to re-do this to a map for optimization
+		std::vector<ComponentPtr> m_components;
+		std::vector<size_t> m_componentTypes; // Type id of each component, so lookups skip the virtual call
+		std::weak_ptr<ComponentRegistry> m_registry; // Set by the owning Scene before any component is added
 		Transform* m_transform = nullptr;
 
 		UUID m_uuid;
@@ -13,15 +13,19 @@
 #include "Loopie/Components/AutoMovement.h"
 
 #include <unordered_set>
+#include <chrono>
 
 
 namespace Loopie {
 	Scene::Scene(const std::string& filePath)
 	{
 		m_filePath = filePath;
+		m_registry = std::make_shared<ComponentRegistry>();
+		m_transformSystem = std::make_unique<TransformSystem>();
 
 		m_rootEntity = std::make_shared<Entity>("scene");
 		m_rootEntity->AddComponent<Transform>();
+		m_transformSystem->Add(m_rootEntity->GetTransform(), nullptr);
 
 		m_octree = std::make_unique<Octree>(DEFAULT_WORLD_BOUNDS);
 
@@ -66,29 +70,27 @@ namespace Loopie {
 		Log::Info("Scene saved.");
 	}
 
-	// *** Octree rebuild TEMP *** - PSS 13/12/25
-	// The create entities functions are doing an m_octree->Rebuild();
-	// This is a temporal call to the function. The reason is because
-	// the after creating the entity, if the entity had no mesh originally
-	// it will create an AABB based on its transform. 
-	// This makes it so that the Octree will never be fully accurate because
-	// the last entity may not be accurate. 
-	// A rebuild / update of the entity should be called AFTER the entity gets its mesh.
+	// *** Octree insertion is deferred ***
+	// The create entities functions only queue the entity in the octree.
+	// Right after creation the entity has no mesh yet, so inserting it immediately
+	// would use an AABB based only on its transform. The octree reconciles the queue
+	// once per frame in Scene::Update (or at Scene::EndBatch), by which point the
+	// entity usually has its MeshRenderer, so each entity is inserted only once.
 	std::shared_ptr<Entity> Scene::CreateEntity(const std::string& name,
 												std::shared_ptr<Entity> parentEntity)
 	{
 		std::shared_ptr<Entity> realParent = parentEntity ? parentEntity : m_rootEntity;
 		std::string uniqueName = GetUniqueName(realParent, name);
 		std::shared_ptr<Entity> entity = std::make_shared<Entity>(uniqueName);
+		entity->m_registry = m_registry;
 
 		realParent->AddChild(entity);
 
 		entity->AddComponent<Transform>();
+		m_transformSystem->Add(entity->GetTransform(), realParent->GetTransform());
 
 		m_entities[entity->GetUUID()] = entity;
-		m_octree->Insert(entity);
-
-		m_octree->Rebuild();
+		m_octree->MarkDirty(entity);
 		return entity;
 	}
 
@@ -100,16 +102,16 @@ namespace Loopie {
 
 		std::string uniqueName = GetUniqueName(realParent, name);
 		std::shared_ptr<Entity> entity = std::make_shared<Entity>(uniqueName);
+		entity->m_registry = m_registry;
 		entity->SetUUID(uuid);
 
 		realParent->AddChild(entity);
 
 		entity->AddComponent<Transform>();
+		m_transformSystem->Add(entity->GetTransform(), realParent->GetTransform());
 
 		m_entities[entity->GetUUID()] = entity;
-		m_octree->Insert(entity);
-
-		m_octree->Rebuild();
+		m_octree->MarkDirty(entity);
 		return entity;
 	}
 
@@ -119,14 +121,14 @@ namespace Loopie {
 		std::shared_ptr<Entity> realParent = parentEntity ? parentEntity : m_rootEntity;
 		std::string uniqueName = GetUniqueName(realParent, name);
 		std::shared_ptr<Entity> entity = std::make_shared<Entity>(uniqueName);
+		entity->m_registry = m_registry;
 
 		realParent->AddChild(entity);
 
 		entity->AddComponent<Transform>(position, rotation, scale);
+		m_transformSystem->Add(entity->GetTransform(), realParent->GetTransform());
 		m_entities[entity->GetUUID()] = entity;
-		m_octree->Insert(entity);
-
-		m_octree->Rebuild();
+		m_octree->MarkDirty(entity);
 		return entity;
 	}
 
@@ -137,6 +139,7 @@ namespace Loopie {
 		std::shared_ptr<Entity> realParent = parentEntity ? parentEntity : m_rootEntity;
 		std::string uniqueName = GetUniqueName(realParent, name);
 		std::shared_ptr<Entity> entity = std::make_shared<Entity>(uniqueName);
+		entity->m_registry = m_registry;
 		realParent->AddChild(entity);
 
 		if (!transform)
@@ -147,10 +150,9 @@ namespace Loopie {
 		{
 			entity->AddComponent<Transform>(*transform);
 		}
+		m_transformSystem->Add(entity->GetTransform(), realParent->GetTransform());
 		m_entities[entity->GetUUID()] = entity;
-		m_octree->Insert(entity);
-
-		m_octree->Rebuild();
+		m_octree->MarkDirty(entity);
 		return entity;
 	}
 
@@ -161,7 +163,6 @@ namespace Loopie {
 			return;
 
 		RemoveEntityRecursive(it->second);
-		m_octree->Rebuild();
 	}
 
 	void Scene::RemoveEntity(std::shared_ptr<Entity> entity)
@@ -170,7 +171,34 @@ namespace Loopie {
 			return;
 
 		RemoveEntityRecursive(entity);
-		m_octree->Rebuild();
+	}
+
+	void Scene::Update()
+	{
+		if (m_batchDepth > 0)
+			return;
+
+		// Transforms first, their OnDirty notifications are what queue entities in the octree
+		m_transformSystem->Update();
+		m_octree->ProcessDirtyEntities();
+	}
+
+	void Scene::BeginBatch()
+	{
+		m_batchDepth++;
+	}
+
+	void Scene::EndBatch()
+	{
+		if (m_batchDepth == 0)
+			return;
+
+		m_batchDepth--;
+		if (m_batchDepth == 0)
+		{
+			m_transformSystem->Update();
+			m_octree->ProcessDirtyEntities();
+		}
 	}
 
 	void Scene::SetFilePath(std::string filePath)
@@ -206,6 +234,16 @@ namespace Loopie {
 		return nullptr;
 	}
 
+	ComponentRegistry& Scene::GetComponentRegistry() const
+	{
+		return *m_registry;
+	}
+
+	TransformSystem& Scene::GetTransformSystem() const
+	{
+		return *m_transformSystem;
+	}
+
 	Octree& Scene::GetOctree() const
 	{
 		return *m_octree;
@@ -255,6 +293,7 @@ namespace Loopie {
 
 		m_rootEntity = std::make_shared<Entity>("scene");
 		m_rootEntity->AddComponent<Transform>();
+		m_transformSystem->Add(m_rootEntity->GetTransform(), nullptr);
 		
 		JsonData saveData = Json::ReadFromFile(filePath);
 
@@ -272,6 +311,9 @@ namespace Loopie {
 			return true;
 		}
 
+		auto loadStart = std::chrono::steady_clock::now();
+		BeginBatch();
+
 		// First iteration: Create all entities
 		for (unsigned int i = 0; i < rootNode.Size(); ++i)
 		{
@@ -378,7 +420,9 @@ namespace Loopie {
 				}
 			}
 		}
-		Log::Info("Scene loaded successfully");
+		EndBatch();
+		float loadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+		Log::Info("Scene loaded successfully ({0} entities in {1:.2f} ms)", m_entities.size(), loadTime);
 
 		if (safeSceneAsLastLoaded) {
 			m_filePath = filePath;
@@ -399,8 +443,6 @@ namespace Loopie {
 			}
 		}
 
-		m_octree->Rebuild();
-
 		return true;
 	}
 
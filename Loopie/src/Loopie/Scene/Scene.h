@@ -2,10 +2,13 @@
 
 #include "Loopie/Core/UUID.h"
 #include "Loopie/Scene/Entity.h"
+#include "Loopie/Scene/ComponentRegistry.h"
+#include "Loopie/Scene/TransformSystem.h"
 #include "Loopie/Math/MathTypes.h"
 #include "Loopie/Math/Octree.h"
 
 #include <string>
+#include <tuple>
 #include <unordered_map>
 	
 namespace Loopie {
@@ -34,6 +37,12 @@ namespace Loopie {
 		void RemoveEntity(UUID uuid);
 		void RemoveEntity(std::shared_ptr<Entity> entity);
 
+		// Propagates transform changes and reconciles pending octree changes, call once per frame
+		void Update();
+		// Defers both until the matching EndBatch, batches can be nested
+		void BeginBatch();
+		void EndBatch();
+
 		void SetFilePath(std::string filePath);
 
 		std::string GetFilePath() const;
@@ -48,6 +57,34 @@ namespace Loopie {
 		std::vector<std::shared_ptr<Entity>> GetAllSiblings(std::shared_ptr<Entity> parentEntity = nullptr) const;
 		bool ReadAndLoadSceneFile(std::string filePath, bool safeSceneAsLastLoaded = true);
 
+		ComponentRegistry& GetComponentRegistry() const;
+		TransformSystem& GetTransformSystem() const;
+
+		// Calls func(Entity&, T&, Others&...) for every entity of the scene having all those components.
+		// Walks T's pool, so put the rarest component first. Usage:
+		// scene.View<MeshRenderer, Transform>([](Entity& entity, MeshRenderer& renderer, Transform& transform) { ... });
+		// Adding or removing components of type T inside func is not allowed.
+		template<typename T, typename... Others, typename Func>
+		void View(Func&& func) const
+		{
+			const ComponentPool<T>* pool = m_registry->FindPool<T>();
+			if (!pool)
+				return;
+
+			for (size_t i = 0; i < pool->Size(); i++)
+			{
+				Entity* owner = pool->GetOwner(i);
+				if constexpr (sizeof...(Others) == 0) {
+					func(*owner, *pool->GetComponent(i));
+				}
+				else {
+					std::tuple<Others*...> others(owner->GetComponent<Others>()...);
+					if (((std::get<Others*>(others) != nullptr) && ...))
+						func(*owner, *pool->GetComponent(i), *std::get<Others*>(others)...);
+				}
+			}
+		}
+
 	public:
 
 		// Devuelve la primera entidad cuyo nombre coincide con el proporcionado, o nullptr si no existe
@@ -67,10 +104,13 @@ namespace Loopie {
 		void RemoveEntityRecursive(std::shared_ptr<Entity> parent);
 
 	private:
+		std::shared_ptr<ComponentRegistry> m_registry; // Declared first so it is destroyed after the entities
+		std::unique_ptr<TransformSystem> m_transformSystem;
 		std::unique_ptr<Octree> m_octree;
 		std::unordered_map<UUID, std::shared_ptr<Entity>> m_entities; // Fast lookup
 		std::shared_ptr<Entity> m_rootEntity; // Hierarchy based
 		std::string m_filePath;
+		unsigned int m_batchDepth = 0;
 		const AABB DEFAULT_WORLD_BOUNDS = AABB(vec3(-500, -450, -500), vec3(500, 550, 500));
 	};	
 }
\ No newline at end of file
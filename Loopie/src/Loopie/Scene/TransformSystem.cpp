@@ -0,0 +1,331 @@
+#include "TransformSystem.h"
+#include "Loopie/Components/Transform.h"
+#include "Loopie/Core/JobSystem.h"
+
+#include <algorithm>
+
+namespace Loopie {
+	TransformSystem::~TransformSystem()
+	{
+		// Transforms outliving the scene fall back to refreshing themselves
+		for (Transform* transform : m_transforms)
+		{
+			if (transform)
+			{
+				transform->m_systemSlot.System = nullptr;
+				transform->m_systemSlot.Index = TRANSFORM_INVALID_INDEX;
+			}
+		}
+	}
+
+	void TransformSystem::Add(Transform* transform, Transform* parent)
+	{
+		uint32_t index = static_cast<uint32_t>(m_transforms.size());
+		transform->m_systemSlot.System = this;
+		transform->m_systemSlot.Index = index;
+
+		uint32_t parentIndex = TRANSFORM_INVALID_INDEX;
+		if (parent && parent->m_systemSlot.System == this)
+			parentIndex = parent->m_systemSlot.Index;
+
+		m_transforms.push_back(transform);
+		m_parents.push_back(parentIndex);
+		m_localMatrices.push_back(matrix4(1.0f));
+		m_worldMatrices.push_back(matrix4(1.0f));
+		m_versions.push_back(0);
+		m_parentVersions.push_back(0);
+		m_flags.push_back(LOCAL_DIRTY | WORLD_DIRTY);
+		m_hasPendingChanges = true;
+		// Appending keeps the parent before its child, but the new node sits outside its parent's
+		// subtree range, which the parallel update relies on
+		m_orderDirty = true;
+	}
+
+	void TransformSystem::Remove(Transform* transform)
+	{
+		uint32_t index = transform->m_systemSlot.Index;
+		m_transforms[index] = nullptr;
+		m_flags[index] = 0;
+		transform->m_systemSlot.System = nullptr;
+		transform->m_systemSlot.Index = TRANSFORM_INVALID_INDEX;
+		m_orderDirty = true;
+	}
+
+	void TransformSystem::SetParent(Transform* transform, Transform* parent)
+	{
+		uint32_t index = transform->m_systemSlot.Index;
+		uint32_t parentIndex = TRANSFORM_INVALID_INDEX;
+		if (parent && parent->m_systemSlot.System == this)
+			parentIndex = parent->m_systemSlot.Index;
+
+		m_parents[index] = parentIndex;
+		m_orderDirty = true;
+
+		m_flags[index] |= WORLD_DIRTY;
+		m_hasPendingChanges = true;
+	}
+
+	void TransformSystem::MarkLocalDirty(Transform* transform)
+	{
+		m_flags[transform->m_systemSlot.Index] |= LOCAL_DIRTY;
+		m_hasPendingChanges = true;
+	}
+
+	void TransformSystem::MarkWorldDirty(Transform* transform)
+	{
+		m_flags[transform->m_systemSlot.Index] |= WORLD_DIRTY;
+		m_hasPendingChanges = true;
+	}
+
+	bool TransformSystem::IsStale(const Transform* transform) const
+	{
+		if (!m_hasPendingChanges)
+			return false;
+
+		for (uint32_t index = transform->m_systemSlot.Index; index != TRANSFORM_INVALID_INDEX; index = m_parents[index])
+		{
+			if (NeedsUpdate(index))
+				return true;
+		}
+		return false;
+	}
+
+	void TransformSystem::Refresh(const Transform* transform)
+	{
+		if (!m_hasPendingChanges)
+			return;
+
+		m_refreshPath.clear();
+		for (uint32_t index = transform->m_systemSlot.Index; index != TRANSFORM_INVALID_INDEX; index = m_parents[index])
+			m_refreshPath.push_back(index);
+
+		// Top down, so a recomputed ancestor bumps its version before its child is checked
+		for (auto it = m_refreshPath.rbegin(); it != m_refreshPath.rend(); ++it)
+		{
+			if (NeedsUpdate(*it))
+				UpdateNode(*it);
+		}
+	}
+
+	void TransformSystem::Update()
+	{
+		if (m_orderDirty)
+			RebuildOrder();
+
+		if (!m_hasPendingChanges)
+			return;
+
+		uint32_t count = static_cast<uint32_t>(m_transforms.size());
+		unsigned int threadCount = JobSystem::IsRunning() ? JobSystem::GetThreadCount() : 1;
+		if (threadCount > 1 && count >= TRANSFORM_PARALLEL_THRESHOLD)
+		{
+			if (m_batchThreadCount != threadCount)
+				BuildBatches(threadCount);
+
+			for (uint32_t index : m_serialNodes)
+			{
+				if (NeedsUpdate(index))
+					UpdateNode(index);
+			}
+
+			JobSystem::ParallelFor(static_cast<uint32_t>(m_batches.size()), 1, [this](uint32_t batchIndex) {
+				UpdateRange(m_batches[batchIndex].First, m_batches[batchIndex].End);
+			});
+		}
+		else
+		{
+			UpdateRange(0, count);
+		}
+
+		m_notifyQueue.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (m_flags[i] & NOTIFY_PENDING)
+			{
+				m_flags[i] &= ~NOTIFY_PENDING;
+				m_notifyQueue.push_back(m_transforms[i]);
+			}
+		}
+		m_hasPendingChanges = false;
+
+		// Observers may move transforms again, those changes are picked up next Update
+		for (Transform* transform : m_notifyQueue)
+			transform->m_transformNotifier.Notify(TransformNotification::OnDirty);
+	}
+
+	void TransformSystem::UpdateRange(uint32_t first, uint32_t end)
+	{
+		for (uint32_t i = first; i < end; ++i)
+		{
+			if (NeedsUpdate(i))
+				UpdateNode(i);
+		}
+	}
+
+	bool TransformSystem::NeedsUpdate(uint32_t index) const
+	{
+		// Removed slots stay in the parent chain of their orphans until the next RebuildOrder
+		if (!m_transforms[index])
+			return false;
+
+		if (m_flags[index] & (LOCAL_DIRTY | WORLD_DIRTY))
+			return true;
+
+		uint32_t parentIndex = m_parents[index];
+		return parentIndex != TRANSFORM_INVALID_INDEX && m_parentVersions[index] != m_versions[parentIndex];
+	}
+
+	void TransformSystem::UpdateNode(uint32_t index)
+	{
+		Transform* transform = m_transforms[index];
+		if (m_flags[index] & LOCAL_DIRTY)
+			m_localMatrices[index] = transform->ComputeLocalMatrix();
+
+		uint32_t parentIndex = m_parents[index];
+		if (parentIndex != TRANSFORM_INVALID_INDEX)
+		{
+			m_worldMatrices[index] = m_worldMatrices[parentIndex] * m_localMatrices[index];
+			m_parentVersions[index] = m_versions[parentIndex];
+		}
+		else
+		{
+			m_worldMatrices[index] = m_localMatrices[index];
+		}
+
+		m_versions[index]++;
+		m_flags[index] = (m_flags[index] & ~(LOCAL_DIRTY | WORLD_DIRTY)) | NOTIFY_PENDING;
+
+		transform->m_localToWorld = m_worldMatrices[index];
+		transform->m_worldToLocal = inverse(m_worldMatrices[index]);
+	}
+
+	void TransformSystem::RebuildOrder()
+	{
+		uint32_t count = static_cast<uint32_t>(m_transforms.size());
+
+		// Children lists threaded through two index arrays, built backwards so siblings keep their order
+		std::vector<uint32_t> firstChild(count, TRANSFORM_INVALID_INDEX);
+		std::vector<uint32_t> nextSibling(count, TRANSFORM_INVALID_INDEX);
+		std::vector<uint32_t> roots;
+		for (uint32_t i = count; i-- > 0;)
+		{
+			if (!m_transforms[i])
+				continue;
+
+			uint32_t parentIndex = m_parents[i];
+			if (parentIndex != TRANSFORM_INVALID_INDEX && !m_transforms[parentIndex])
+			{
+				// The parent was removed before its child, treat the child as a root from now on
+				parentIndex = TRANSFORM_INVALID_INDEX;
+				m_parents[i] = TRANSFORM_INVALID_INDEX;
+				m_flags[i] |= WORLD_DIRTY;
+				m_hasPendingChanges = true;
+			}
+
+			if (parentIndex == TRANSFORM_INVALID_INDEX)
+			{
+				roots.push_back(i);
+			}
+			else
+			{
+				nextSibling[i] = firstChild[parentIndex];
+				firstChild[parentIndex] = i;
+			}
+		}
+
+		// Depth first, so every subtree ends up contiguous right after its root
+		std::vector<uint32_t> order;
+		order.reserve(count);
+		std::vector<uint32_t> stack;
+		for (auto root = roots.rbegin(); root != roots.rend(); ++root)
+		{
+			stack.push_back(*root);
+			while (!stack.empty())
+			{
+				uint32_t index = stack.back();
+				stack.pop_back();
+				order.push_back(index);
+
+				size_t firstPushed = stack.size();
+				for (uint32_t child = firstChild[index]; child != TRANSFORM_INVALID_INDEX; child = nextSibling[child])
+					stack.push_back(child);
+				std::reverse(stack.begin() + firstPushed, stack.end());
+			}
+		}
+
+		std::vector<uint32_t> newIndices(count, TRANSFORM_INVALID_INDEX);
+		for (uint32_t i = 0; i < order.size(); ++i)
+			newIndices[order[i]] = i;
+
+		std::vector<Transform*> transforms(order.size());
+		std::vector<uint32_t> parents(order.size());
+		std::vector<matrix4> localMatrices(order.size());
+		std::vector<matrix4> worldMatrices(order.size());
+		std::vector<uint32_t> versions(order.size());
+		std::vector<uint32_t> parentVersions(order.size());
+		std::vector<uint8_t> flags(order.size());
+		for (uint32_t i = 0; i < order.size(); ++i)
+		{
+			uint32_t oldIndex = order[i];
+			transforms[i] = m_transforms[oldIndex];
+			parents[i] = m_parents[oldIndex] != TRANSFORM_INVALID_INDEX ? newIndices[m_parents[oldIndex]] : TRANSFORM_INVALID_INDEX;
+			localMatrices[i] = m_localMatrices[oldIndex];
+			worldMatrices[i] = m_worldMatrices[oldIndex];
+			versions[i] = m_versions[oldIndex];
+			parentVersions[i] = m_parentVersions[oldIndex];
+			flags[i] = m_flags[oldIndex];
+			transforms[i]->m_systemSlot.Index = i;
+		}
+
+		m_transforms = std::move(transforms);
+		m_parents = std::move(parents);
+		m_localMatrices = std::move(localMatrices);
+		m_worldMatrices = std::move(worldMatrices);
+		m_versions = std::move(versions);
+		m_parentVersions = std::move(parentVersions);
+		m_flags = std::move(flags);
+		m_orderDirty = false;
+		m_batchThreadCount = 0;
+	}
+
+	void TransformSystem::BuildBatches(unsigned int threadCount)
+	{
+		uint32_t count = static_cast<uint32_t>(m_transforms.size());
+
+		// Parents come first, so walking backwards adds every finished subtree to its parent
+		std::vector<uint32_t> subtreeSizes(count, 1);
+		for (uint32_t i = count; i-- > 0;)
+		{
+			if (m_parents[i] != TRANSFORM_INVALID_INDEX)
+				subtreeSizes[m_parents[i]] += subtreeSizes[i];
+		}
+
+		// A few batches per thread leave room for stealing when subtrees are unbalanced
+		uint32_t batchSize = std::max(TRANSFORM_MINIMUM_BATCH, count / (threadCount * 4));
+
+		m_serialNodes.clear();
+		m_batches.clear();
+		for (uint32_t i = 0; i < count; i += subtreeSizes[i])
+			SplitSubtree(i, batchSize, subtreeSizes);
+
+		m_batchThreadCount = threadCount;
+	}
+
+	void TransformSystem::SplitSubtree(uint32_t index, uint32_t batchSize, const std::vector<uint32_t>& subtreeSizes)
+	{
+		uint32_t size = subtreeSizes[index];
+		if (size <= batchSize)
+		{
+			// Small neighbouring subtrees share a batch
+			if (!m_batches.empty() && m_batches.back().End == index && m_batches.back().End - m_batches.back().First + size <= batchSize)
+				m_batches.back().End += size;
+			else
+				m_batches.push_back({ index, index + size });
+			return;
+		}
+
+		m_serialNodes.push_back(index);
+		for (uint32_t child = index + 1; child < index + size; child += subtreeSizes[child])
+			SplitSubtree(child, batchSize, subtreeSizes);
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Loopie/Math/MathTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Loopie {
+	class Transform;
+	class TransformSystem;
+
+	constexpr uint32_t TRANSFORM_INVALID_INDEX = UINT32_MAX;
+	constexpr uint32_t TRANSFORM_PARALLEL_THRESHOLD = 2048; // Smaller hierarchies are updated on the calling thread
+	constexpr uint32_t TRANSFORM_MINIMUM_BATCH = 256;
+
+	// Where a Transform lives inside its TransformSystem. Copies of a Transform are not registered,
+	// so copying or assigning the slot leaves the destination untouched.
+	struct TransformSystemSlot
+	{
+		TransformSystem* System = nullptr;
+		uint32_t Index = TRANSFORM_INVALID_INDEX;
+
+		TransformSystemSlot() = default;
+		TransformSystemSlot(const TransformSystemSlot&) {}
+		TransformSystemSlot& operator=(const TransformSystemSlot&) { return *this; }
+	};
+
+	// *** Transform hierarchy ***
+	// Local and world matrices of every transform of a scene are kept in flat arrays ordered parent
+	// before child, so Update recomputes whatever changed in one linear pass reading the parent's
+	// world matrix from the same array, without locking any weak_ptr.
+	// Marking a transform dirty only flags its own slot. Each slot remembers the version of its
+	// parent's world matrix it was built from, so children notice a moved parent by themselves.
+	// Reading a matrix before Update refreshes just the chain of ancestors it depends on.
+	// TransformNotification::OnDirty is sent once per changed transform at the end of Update,
+	// when the whole hierarchy is already up to date.
+	// Subtrees are stored contiguously, so big hierarchies are split into ranges of whole subtrees
+	// updated in parallel. Each transform is written by exactly one task and notifications are
+	// sent in array order afterwards, so the result does not depend on the thread count.
+	class TransformSystem
+	{
+	public:
+		TransformSystem() = default;
+		~TransformSystem();
+
+		TransformSystem(const TransformSystem&) = delete;
+		TransformSystem& operator=(const TransformSystem&) = delete;
+
+		// parent must already be registered (or be nullptr for a root)
+		void Add(Transform* transform, Transform* parent);
+		void Remove(Transform* transform);
+		void SetParent(Transform* transform, Transform* parent);
+
+		void MarkLocalDirty(Transform* transform);
+		void MarkWorldDirty(Transform* transform);
+		bool IsStale(const Transform* transform) const;
+		// Brings the transform and the ancestors it depends on up to date
+		void Refresh(const Transform* transform);
+
+		// Recomputes every changed transform and sends the OnDirty notifications, call once per frame.
+		// Big hierarchies are split across the JobSystem threads when it is running.
+		void Update();
+
+		size_t Size() const { return m_transforms.size(); }
+
+	private:
+		bool NeedsUpdate(uint32_t index) const;
+		void UpdateNode(uint32_t index);
+		void UpdateRange(uint32_t first, uint32_t end);
+		void RebuildOrder();
+		void BuildBatches(unsigned int threadCount);
+		void SplitSubtree(uint32_t index, uint32_t batchSize, const std::vector<uint32_t>& subtreeSizes);
+
+	private:
+		enum Flags : uint8_t
+		{
+			LOCAL_DIRTY = 1 << 0,
+			WORLD_DIRTY = 1 << 1,
+			NOTIFY_PENDING = 1 << 2
+		};
+
+		std::vector<Transform*> m_transforms; // nullptr marks a removed slot until the next RebuildOrder
+		std::vector<uint32_t> m_parents;
+		std::vector<matrix4> m_localMatrices;
+		std::vector<matrix4> m_worldMatrices;
+		std::vector<uint32_t> m_versions; // Bumped every time the world matrix is recomputed
+		std::vector<uint32_t> m_parentVersions; // Parent version the world matrix was built from
+		std::vector<uint8_t> m_flags;
+
+		// Parallel split of the current order. Serial nodes are the heads of subtrees too big for one
+		// batch, updated first and in order, then every batch is a range of whole subtrees below them.
+		struct Batch
+		{
+			uint32_t First;
+			uint32_t End;
+		};
+		std::vector<uint32_t> m_serialNodes;
+		std::vector<Batch> m_batches;
+		unsigned int m_batchThreadCount = 0; // 0 when the batches have to be rebuilt
+
+		std::vector<uint32_t> m_refreshPath; // Scratch for Refresh
+		std::vector<Transform*> m_notifyQueue; // Scratch for Update
+		bool m_hasPendingChanges = false;
+		bool m_orderDirty = false; // The hierarchy changed since the last RebuildOrder
+	};
+}
@@ -13,7 +13,12 @@ layout (std140, binding = 0) uniform Matrices
     mat4 lp_View;
 };
 
-uniform mat4 lp_Transform;
+// Model matrices of the drawn instances, streamed by the renderer. Index it with
+// gl_BaseInstance + gl_InstanceID, gl_BaseInstance needs GLSL 4.60 (or ARB_shader_draw_parameters)
+layout (std430, binding = 1) readonly buffer Instances
+{
+    mat4 lp_Transforms[];
+};
 ///
 
 out vec2 v_TexCoord;
@@ -21,9 +26,10 @@ out vec3 v_Normal;
 
 void main()
 {
-    gl_Position = lp_Projection * lp_View* lp_Transform * vec4(a_Position, 1.0);
+    mat4 transform = lp_Transforms[gl_BaseInstance + gl_InstanceID];
+    gl_Position = lp_Projection * lp_View * transform * vec4(a_Position, 1.0);
     v_TexCoord = a_TexCoord;
-    v_Normal = mat3(lp_Transform) * a_Normal;
+    v_Normal = mat3(transform) * a_Normal;
 }
 
 
@@ -13,17 +13,23 @@ layout (std140, binding = 0) uniform Matrices
     mat4 lp_View;
 };
 
-uniform mat4 lp_Transform;
+// Model matrices of the drawn instances, streamed by the renderer. Index it with
+// gl_BaseInstance + gl_InstanceID, gl_BaseInstance needs GLSL 4.60 (or ARB_shader_draw_parameters)
+layout (std430, binding = 1) readonly buffer Instances
+{
+    mat4 lp_Transforms[];
+};
 ///
 
 uniform float outlineThickness = 0.01;
 
 void main()
 {
+    mat4 transform = lp_Transforms[gl_BaseInstance + gl_InstanceID];
     // Transform to view space
-    vec4 viewPos = lp_View * lp_Transform * vec4(a_Position, 1.0);
+    vec4 viewPos = lp_View * transform * vec4(a_Position, 1.0);
     // Compute normal in view space
-    vec3 normalViewSpace = normalize(mat3(lp_View * lp_Transform) * a_Normal);
+    vec3 normalViewSpace = normalize(mat3(lp_View * transform) * a_Normal);
     // Distance scaling so outline looks constant
     float dist = length(viewPos.xyz);
     // Extract projection info
@@ -1,11 +1,19 @@
 #include "EditorMenuInterface.h"
 
+#include "Editor/Others/Benchmarks.h"
+#include "Editor/Interfaces/Workspace/HierarchyInterface.h"
+
 #include "Loopie/Core/Application.h"
 #include "Loopie/Core/Time.h"
 #include "Loopie/Core/Window.h"
 #include "Loopie/Files/FileDialog.h"
 #include "Loopie/Files/DirectoryManager.h"
+#include "Loopie/Importers/MeshImporter.h"
+#include "Loopie/Importers/TextureImporter.h"
+#include "Loopie/Render/Renderer.h"
+#include "Loopie/Resources/AssetPack.h"
 #include "Loopie/Resources/AssetRegistry.h"
+#include "Loopie/Resources/TextureStreamer.h"
 
 #include <imgui.h>
 #include <imgui_stdlib.h>
@@ -68,6 +76,32 @@ namespace Loopie {
 					m_newScenePath = "";
 				}
 
+				if (ImGui::MenuItem("Build Asset Pack", nullptr, false, AssetPack::CanRebuild()))
+				{
+					const Project& project = Application::GetInstance().m_activeProject;
+					AssetPack::Build(project.GetProjectPath() / ASSET_PACK_FILE_NAME);
+				}
+
+				if (ImGui::BeginMenu("Mesh Import Settings"))
+				{
+					MeshImportSettings settings = MeshImporter::GetImportSettings();
+					bool changed = ImGui::MenuItem("Compact Vertices", nullptr, &settings.CompactVertices);
+					changed |= ImGui::MenuItem("Quantize Positions", nullptr, &settings.QuantizePositions);
+					if (changed)
+						MeshImporter::SetImportSettings(settings);
+					ImGui::EndMenu();
+				}
+
+				if (ImGui::BeginMenu("Texture Import Settings"))
+				{
+					TextureImportSettings settings = TextureImporter::GetImportSettings();
+					bool changed = ImGui::MenuItem("Block Compression (BC1/BC3)", nullptr, &settings.CompressBlocks);
+					changed |= ImGui::MenuItem("Generate Mipmaps", nullptr, &settings.GenerateMipmaps);
+					if (changed)
+						TextureImporter::SetImportSettings(settings);
+					ImGui::EndMenu();
+				}
+
 				if (ImGui::MenuItem("Exit"))
 					Application::GetInstance().Close();
 
@@ -121,6 +155,71 @@ namespace Loopie {
 					Application::GetInstance().GetScene().GetOctree().ToggleShouldDraw();
 				}
 
+				if (ImGui::MenuItem("Render Queue Stats Console Information"))
+				{
+					Renderer::LogStatistics();
+				}
+
+				if (ImGui::MenuItem("Benchmark Octree (1k / 10k / 100k)"))
+				{
+					Benchmarks::RunOctree();
+				}
+
+				if (ImGui::MenuItem("Benchmark Culling Allocations"))
+				{
+					Benchmarks::RunCullingAllocations();
+				}
+
+				if (ImGui::MenuItem("Benchmark Frustum Culling"))
+				{
+					Benchmarks::RunFrustumCulling();
+				}
+
+				if (ImGui::MenuItem("Benchmark Raycast (Selected Mesh)"))
+				{
+					Benchmarks::RunMeshRaycast(HierarchyInterface::s_SelectedEntity.lock());
+				}
+
+				if (ImGui::MenuItem("Benchmark Entity Lookup"))
+				{
+					Benchmarks::RunEntityLookup(Application::GetInstance().GetScene());
+				}
+
+				if (ImGui::MenuItem("Benchmark Scene Creation (1k / 10k / 100k)"))
+				{
+					Benchmarks::RunSceneCreation();
+				}
+
+				if (ImGui::MenuItem("Benchmark Render Queue Sort"))
+				{
+					Benchmarks::RunRenderQueueSort();
+				}
+
+				if (ImGui::MenuItem("Benchmark Texture Import (PNG Folder)"))
+				{
+					DialogResult result = FileDialog::SelectFolder();
+					if (result.Status == DialogResultType::SUCCESS && !result.Paths.empty())
+						Benchmarks::RunTextureImport(result.Paths[0]);
+				}
+
+				if (ImGui::BeginMenu("Texture Streaming"))
+				{
+					if (ImGui::MenuItem("Statistics Console Information"))
+					{
+						TextureStreamer::LogStatistics();
+					}
+
+					ImGui::Separator();
+					constexpr size_t BUDGETS_MB[] = { 64, 128, 256, 512, 1024 };
+					for (size_t budget : BUDGETS_MB)
+					{
+						std::string label = "Budget " + std::to_string(budget) + "MB";
+						if (ImGui::MenuItem(label.c_str(), nullptr, TextureStreamer::GetMemoryBudget() == budget * 1024 * 1024))
+							TextureStreamer::SetMemoryBudget(budget * 1024 * 1024);
+					}
+					ImGui::EndMenu();
+				}
+
 				ImGui::EndMenu();
 			}
 
@@ -122,29 +122,22 @@ namespace Loopie {
 		ImGui::PushID(transform);
 
 		bool open = ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen);
-		bool modified = false;
 		if (open) {
 			vec3 position = transform->GetLocalPosition();
 			vec3 rotation = transform->GetLocalEulerAngles();
 			vec3 scale = transform->GetLocalScale();
 
 			if (ImGui::DragFloat3("Position", &position.x, 0.1f)) {
-				modified = true;
 				transform->SetLocalPosition(position);
 			}
 			if (ImGui::DragFloat3("Rotation", &rotation.x, 0.5f)) {
-				modified = true;
 				transform->SetLocalEulerAngles(rotation);
 			}
 			if (ImGui::DragFloat3("Scale", &scale.x, 0.1f)) {
-				modified = true;
 				transform->SetLocalScale(scale);
 			}
 		}
 		ImGui::PopID();
-
-		if(modified)
-			Application::GetInstance().GetScene().GetOctree().Rebuild();
 	}
 
 	void InspectorInterface::DrawCamera(Camera* camera)
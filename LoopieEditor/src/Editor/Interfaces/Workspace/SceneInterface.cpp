@@ -107,8 +107,7 @@ namespace Loopie {
 				ImGuizmo::SetRect(cursorScreenPos.x, cursorScreenPos.y, (float)m_windowSize.x, (float)m_windowSize.y);
 				ImGuizmo::SetDrawlist();
 				if (ImGuizmo::Manipulate(&m_camera->GetCamera()->GetViewMatrix()[0][0], &m_camera->GetCamera()->GetProjectionMatrix()[0][0], (ImGuizmo::OPERATION)m_gizmoOperation, (ImGuizmo::MODE)m_gizmoMode, &worldMatrix[0][0])) {
-					transform->SetWorldMatrix(worldMatrix);
-					Application::GetInstance().GetScene().GetOctree().Rebuild();				
+					transform->SetWorldMatrix(worldMatrix);				
 				}
 				Renderer::EnableDepth();
 			}
@@ -240,9 +239,12 @@ namespace Loopie {
 		MeshImporter::ImportModel(modelPath, meta);
 		std::shared_ptr<Entity> parent;
 
+		Scene& scene = Application::GetInstance().GetScene();
+		scene.BeginBatch();
+
 		auto selected = HierarchyInterface::s_SelectedEntity.lock();
 		if (meta.CachesPath.size() > 0) {
-			parent = Application::GetInstance().GetScene().CreateEntity("ModelEntity", selected);
+			parent = scene.CreateEntity("ModelEntity", selected);
 		}
 		for (size_t i = 0; i < meta.CachesPath.size(); i++)
 		{			
@@ -250,9 +252,9 @@ namespace Loopie {
 			if (mesh) {
 				std::shared_ptr<Entity> newEntity;
 				if (!parent) {
-					newEntity = Application::GetInstance().GetScene().CreateEntity(mesh->GetData().Name, selected);
+					newEntity = scene.CreateEntity(mesh->GetData().Name, selected);
 				}else
-					newEntity = Application::GetInstance().GetScene().CreateEntity(mesh->GetData().Name, parent);
+					newEntity = scene.CreateEntity(mesh->GetData().Name, parent);
 
 				MeshRenderer* renderer = newEntity->AddComponent<MeshRenderer>();
 				renderer->SetMesh(mesh);
@@ -261,6 +263,8 @@ namespace Loopie {
 				renderer->GetTransform()->SetLocalScale(mesh->GetData().Scale);
 			}
 		}
+
+		scene.EndBatch();
 	}
 	void SceneInterface::ChargeTexture(const std::string& texturePath)
 	{
@@ -317,47 +321,10 @@ namespace Loopie {
 	void SceneInterface::MousePick()
 	{
 		Ray mouseRay = MouseRay();
-		float minDistance = std::numeric_limits<float>::max();
-		std::shared_ptr<Entity> selectedEntity;
-
-		std::vector<vec3> triVertexData;
-		triVertexData.reserve(3);
-		triVertexData.resize(3);
-		vec3 meshHitPoint;
+		float maxDistance = glm::distance(mouseRay.StartPoint(), mouseRay.EndPoint());
 
-		std::unordered_set<std::shared_ptr<Entity>> possibleEntities;
-		Application::GetInstance().GetScene().GetOctree().CollectIntersectingObjectsWithRay(mouseRay.StartPoint(), mouseRay.Direction(), possibleEntities);
-		for (const auto& entity : possibleEntities)
-		{
-			if (!entity->GetIsActive())
-				continue;
-			MeshRenderer* renderer = entity->GetComponent<MeshRenderer>();
-			if (!renderer || !renderer->GetIsActive() || !renderer->GetMesh())
-				continue;
-			const AABB& aabb = renderer->GetWorldAABB();
-			if(!aabb.IntersectsRay(mouseRay.StartPoint(), mouseRay.EndPoint()))
-				continue;
-			const MeshData& meshData = renderer->GetMesh()->GetData();
-			Triangle triangle;
-
-			unsigned int  triangleCount = (unsigned int)meshData.Indices.size() / 3;
-
-			for (unsigned int i = 0; i < triangleCount; i++)
-			{
-				if (!renderer->GetTriangle(i, triangle)) continue;
-				triVertexData[0] = triangle.v0;
-				triVertexData[1] = triangle.v1;
-				triVertexData[2] = triangle.v2;
-				if (!mouseRay.Intersects(triVertexData, true, meshHitPoint))
-					continue;
-				float distance = glm::distance(mouseRay.StartPoint(), meshHitPoint);
-				if (distance < minDistance)
-				{
-					minDistance = distance;
-					selectedEntity = entity;
-				}
-			}
-		}
-		HierarchyInterface::SelectEntity(selectedEntity);
+		RaycastHit hit;
+		Application::GetInstance().GetScene().GetOctree().Raycast(mouseRay.StartPoint(), mouseRay.Direction(), maxDistance, hit);
+		HierarchyInterface::SelectEntity(hit.HitEntity);
 	}
 }
\ No newline at end of file
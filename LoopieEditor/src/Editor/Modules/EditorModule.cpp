@@ -11,6 +11,7 @@
 #include "Loopie/Math/MathTypes.h"
 
 #include "Loopie/Resources/ResourceManager.h"
+#include "Loopie/Resources/TextureStreamer.h"
 #include "Loopie/Importers/TextureImporter.h"
 #include "Loopie/Math/Ray.h"
 #include "Loopie/Importers/MaterialImporter.h"
@@ -94,6 +95,8 @@ namespace Loopie
 		m_scene.Update(inputEvent);
 		m_topBar.Update(inputEvent);
 
+		m_currentScene->Update();
+
 		const std::vector<Camera*>& cameras = Renderer::GetRendererCameras();
 		for (const auto cam : cameras)
 		{
@@ -196,14 +199,15 @@ namespace Loopie
 		Renderer::Clear();
 
 		// POST
-		std::unordered_set<std::shared_ptr<Entity>> entities;
-		m_currentScene->GetOctree().CollectVisibleEntitiesFrustum(camera->GetFrustum(), entities);
+		// Both vectors keep their capacity between frames, so culling doesn't allocate once warmed up
+		std::vector<Entity*>& entities = m_visibleEntities;
+		entities.clear();
+		m_currentScene->GetOctree().CollectVisibleEntitiesFrustum(camera->GetFrustum(), entities, camera->GetCullingContext());
 
-		std::vector<MeshRenderer*> renderers;
-		renderers.reserve(1);
+		std::vector<MeshRenderer*>& renderers = m_visibleRenderers;
 
 		auto selectedEntity = HierarchyInterface::s_SelectedEntity.lock();
-		for (const auto& entity : entities)
+		for (Entity* entity : entities)
 		{
 			if (!entity->GetIsActive())
 				continue;
@@ -231,15 +235,19 @@ namespace Loopie
 			{
 				MeshRenderer* renderer = renderers[i];
 
-				if (!Renderer::IsGizmoActive() || entity != selectedEntity) {
-					Renderer::AddRenderItem(renderer->GetMesh()->GetVAO(), renderer->GetMaterial(), entity->GetTransform());
+				std::shared_ptr<Material> material = renderer->GetMaterial();
+				if (material && material->GetTexture())
+					TextureStreamer::RequestTexture(*material->GetTexture(), TextureStreamer::EstimateScreenSize(camera->GetViewProjectionMatrix(), camera->GetViewport(), renderer->GetWorldAABB()));
+
+				if (!Renderer::IsGizmoActive() || entity != selectedEntity.get()) {
+					Renderer::AddRenderItem(renderer->GetMesh()->GetVAO(), material, entity->GetTransform());
 				}
 				else {
 					Renderer::SetStencilFunc(Renderer::StencilFunc::ALWAYS, 1, 0xFF);
 					Renderer::SetStencilOp(Renderer::StencilOp::KEEP, Renderer::StencilOp::KEEP, Renderer::StencilOp::REPLACE);
 					Renderer::SetStencilMask(0xFF);
 
-					Renderer::FlushRenderItem(renderer->GetMesh()->GetVAO(), renderer->GetMaterial(), entity->GetTransform());
+					Renderer::FlushRenderItem(renderer->GetMesh()->GetVAO(), material, entity->GetTransform());
 
 					Renderer::SetStencilFunc(Renderer::StencilFunc::NOTEQUAL, 1, 0xFF);
 					Renderer::SetStencilMask(0x00);
@@ -13,10 +13,14 @@
 #include "Editor/Interfaces/Workspace/AssetsExplorerInterface.h"
 #include "Editor/Interfaces/Workspace/TopBarInterface.h"
 
+#include <vector>
+
 namespace Loopie {
 
 	class Camera;
+	class Entity;
 	class Material;
+	class MeshRenderer;
 	class Shader;
 
 	class EditorModule : public Module, public IObserver<EngineNotification> {
@@ -56,6 +60,9 @@ namespace Loopie {
 		std::shared_ptr<Material> m_selectedObjectMaterial;
 		Shader* m_selectedObjectShader;
 
+		std::vector<Entity*> m_visibleEntities; // Reused by RenderWorld every frame
+		std::vector<MeshRenderer*> m_visibleRenderers;
+
 		
 	};
 }
\ No newline at end of file
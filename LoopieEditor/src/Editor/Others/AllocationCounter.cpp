@@ -0,0 +1,36 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// Per thread so worker jobs don't show up in a main thread measurement, and no atomics are needed
+	thread_local size_t t_Allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++t_Allocations;
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+	std::abort(); // Built without exceptions, there is no std::bad_alloc to throw
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+namespace Loopie
+{
+	size_t AllocationCounter::GetThreadAllocations()
+	{
+		return t_Allocations;
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+
+namespace Loopie
+{
+	// Counts the global operator new calls made by the calling thread, the editor replaces
+	// operator new / delete in AllocationCounter.cpp. Used by the benchmarks to check that
+	// per frame paths don't allocate.
+	class AllocationCounter
+	{
+	public:
+		static size_t GetThreadAllocations();
+	};
+}
@@ -0,0 +1,579 @@
+#include "Benchmarks.h"
+#include "AllocationCounter.h"
+#include "Loopie/Components/Camera.h"
+#include "Loopie/Components/MeshRenderer.h"
+#include "Loopie/Scene/Entity.h"
+#include "Loopie/Scene/Scene.h"
+#include "Loopie/Math/Ray.h"
+#include "Loopie/Math/AABBArray.h"
+#include "Loopie/Math/Frustum.h"
+#include "Loopie/Math/Octree.h"
+#include "Loopie/Core/Random.h"
+#include "Loopie/Core/Log.h"
+#include "Loopie/Files/ChunkedLZ4.h"
+#include "Loopie/Importers/ImageDecoder.h"
+#include "Loopie/Render/RenderSort.h"
+#include "Loopie/Resources/Types/Mesh.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <lz4.h>
+
+namespace Loopie
+{
+	namespace
+	{
+		constexpr size_t BENCHMARK_BOX_COUNT = 100000;
+		constexpr int BENCHMARK_ITERATIONS = 50;
+		constexpr float BENCHMARK_WORLD_EXTENT = 500.0f;
+		constexpr int BENCHMARK_RAY_COUNT = 200;
+		constexpr int BENCHMARK_LOOKUP_ITERATIONS = 1000;
+		constexpr int BENCHMARK_UUID_COUNT = 100000;
+		constexpr uint32_t BENCHMARK_RENDER_ITEM_COUNT = 20000;
+		constexpr uint32_t BENCHMARK_SHADER_COUNT = 8;
+		constexpr uint32_t BENCHMARK_MATERIAL_COUNT = 64;
+		constexpr uint32_t BENCHMARK_VERTEX_ARRAY_COUNT = 200;
+		constexpr uint32_t BENCHMARK_SCENE_SIZES[] = { 1000, 10000, 100000 };
+		constexpr uint32_t BENCHMARK_ENTITIES_PER_GROUP = 100;
+		constexpr int BENCHMARK_QUERY_COUNT = 200;
+		constexpr float BENCHMARK_QUERY_HALF_SIZE = 25.0f;
+		constexpr int BENCHMARK_OCTREE_RAY_COUNT = 50; // The brute force side tests every mesh per ray
+		constexpr uint32_t BENCHMARK_CULLING_ENTITY_COUNT = 10000;
+
+		// Cubes at random positions inside the world extent. They are spread under group entities because
+		// the scene makes every name unique among its siblings, which scans all of them
+		void PopulateScene(Scene& scene, uint32_t count)
+		{
+			std::shared_ptr<Mesh> cube = Mesh::GetDefault();
+			std::shared_ptr<Entity> group;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (i % BENCHMARK_ENTITIES_PER_GROUP == 0)
+					group = scene.CreateEntity(std::string("Group"));
+
+				float extent = BENCHMARK_WORLD_EXTENT * 0.9f;
+				vec3 position(Random::Get(-extent, extent), Random::Get(-extent, extent), Random::Get(-extent, extent));
+				std::shared_ptr<Entity> entity = scene.CreateEntity(position, quaternion(1, 0, 0, 0), vec3(Random::Get(0.5f, 4.0f)), group, "Cube");
+				entity->AddComponent<MeshRenderer>()->SetMesh(cube);
+			}
+		}
+	}
+
+	void Benchmarks::RunFrustumCulling()
+	{
+		Camera* camera = Camera::GetMainCamera();
+		if (!camera)
+		{
+			Log::Warn("Frustum culling benchmark needs a main camera");
+			return;
+		}
+		const Frustum& frustum = camera->GetFrustum();
+
+		AABBArray boxes;
+		boxes.Reserve(BENCHMARK_BOX_COUNT);
+		for (size_t i = 0; i < BENCHMARK_BOX_COUNT; ++i)
+		{
+			vec3 center(Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+						Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+						Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT));
+			vec3 halfSize(Random::Get(0.1f, 5.0f), Random::Get(0.1f, 5.0f), Random::Get(0.1f, 5.0f));
+			boxes.PushBack(AABB(center - halfSize, center + halfSize));
+		}
+
+		std::vector<uint32_t> scalarMask((BENCHMARK_BOX_COUNT + 31) / 32);
+		std::vector<uint32_t> simdMask((BENCHMARK_BOX_COUNT + 31) / 32);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+			frustum.IntersectsScalar(boxes, 0, BENCHMARK_BOX_COUNT, scalarMask.data());
+		double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+			frustum.Intersects(boxes, 0, BENCHMARK_BOX_COUNT, simdMask.data());
+		double simdMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		size_t mismatches = 0;
+		size_t visible = 0;
+		for (size_t i = 0; i < BENCHMARK_BOX_COUNT; ++i)
+		{
+			bool scalarVisible = (scalarMask[i >> 5] >> (i & 31)) & 1u;
+			bool simdVisible = (simdMask[i >> 5] >> (i & 31)) & 1u;
+			if (scalarVisible != simdVisible)
+				++mismatches;
+			if (simdVisible)
+				++visible;
+		}
+
+		double totalBoxes = static_cast<double>(BENCHMARK_BOX_COUNT) * BENCHMARK_ITERATIONS;
+		Log::Info("--- Frustum Culling Benchmark ({0} boxes x {1}) ---", BENCHMARK_BOX_COUNT, BENCHMARK_ITERATIONS);
+		Log::Info("Scalar: {0:.2f} ms ({1:.1f} M boxes/s)", scalarMs, totalBoxes / (scalarMs * 1000.0));
+		Log::Info("SIMD:   {0:.2f} ms ({1:.1f} M boxes/s)", simdMs, totalBoxes / (simdMs * 1000.0));
+		Log::Info("Speedup = {0:.2f}x, Visible = {1}, Mismatches = {2}", scalarMs / simdMs, visible, mismatches);
+	}
+
+	void Benchmarks::RunMeshRaycast(const std::shared_ptr<Entity>& entity)
+	{
+		MeshRenderer* renderer = entity ? entity->GetComponent<MeshRenderer>() : nullptr;
+		if (!renderer || !renderer->GetMesh())
+		{
+			Log::Warn("Mesh raycast benchmark needs a selected entity with a mesh");
+			return;
+		}
+
+		// Rays from outside the bounds aimed at random points inside them
+		const AABB& bounds = renderer->GetWorldAABB();
+		vec3 center = bounds.GetCenter();
+		float radius = length(bounds.GetExtents()) * 2.0f + 1.0f;
+		std::vector<vec3> origins(BENCHMARK_RAY_COUNT);
+		std::vector<vec3> directions(BENCHMARK_RAY_COUNT);
+		for (int i = 0; i < BENCHMARK_RAY_COUNT; ++i)
+		{
+			vec3 offset = normalize(vec3(Random::Get(-1.0f, 1.0f), Random::Get(-1.0f, 1.0f), Random::Get(-1.0f, 1.0f)) + vec3(0.0001f));
+			vec3 target(Random::Get(bounds.MinPoint.x, bounds.MaxPoint.x),
+						 Random::Get(bounds.MinPoint.y, bounds.MaxPoint.y),
+						 Random::Get(bounds.MinPoint.z, bounds.MaxPoint.z));
+			origins[i] = center + offset * radius;
+			directions[i] = normalize(target - origins[i]);
+		}
+
+		unsigned int triangleCount = (unsigned int)renderer->GetMesh()->GetData().Indices.size() / 3;
+		std::vector<unsigned int> bruteForceHits(BENCHMARK_RAY_COUNT, UINT32_MAX);
+		std::vector<unsigned int> bvhHits(BENCHMARK_RAY_COUNT, UINT32_MAX);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_RAY_COUNT; ++i)
+		{
+			float closest = std::numeric_limits<float>::max();
+			Triangle triangle;
+			for (unsigned int t = 0; t < triangleCount; ++t)
+			{
+				float distance, u, v;
+				if (!renderer->GetTriangle(t, triangle) ||
+					!Ray::IntersectsTriangle(origins[i], directions[i], triangle.v0, triangle.v1, triangle.v2, distance, u, v))
+					continue;
+				if (distance < closest)
+				{
+					closest = distance;
+					bruteForceHits[i] = t;
+				}
+			}
+		}
+		double bruteForceMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_RAY_COUNT; ++i)
+		{
+			float distance;
+			vec2 barycentric;
+			renderer->Raycast(origins[i], directions[i], std::numeric_limits<float>::max(), distance, bvhHits[i], barycentric);
+		}
+		double bvhMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		int mismatches = 0;
+		for (int i = 0; i < BENCHMARK_RAY_COUNT; ++i)
+		{
+			if (bruteForceHits[i] != bvhHits[i])
+				++mismatches;
+		}
+
+		Log::Info("--- Mesh Raycast Benchmark ({0}, {1} triangles, {2} rays) ---", entity->GetName(), triangleCount, BENCHMARK_RAY_COUNT);
+		Log::Info("Brute force: {0:.3f} ms per ray", bruteForceMs / BENCHMARK_RAY_COUNT);
+		Log::Info("BVH:         {0:.3f} ms per ray ({1} nodes)", bvhMs / BENCHMARK_RAY_COUNT, renderer->GetMesh()->GetData().TriangleBVH.GetNodeCount());
+		Log::Info("Speedup = {0:.1f}x, Mismatches = {1}", bruteForceMs / bvhMs, mismatches);
+	}
+
+	void Benchmarks::RunEntityLookup(const Scene& scene)
+	{
+		const auto& entities = scene.GetAllEntities();
+		if (entities.empty())
+		{
+			Log::Warn("Entity lookup benchmark needs a scene with entities");
+			return;
+		}
+
+		std::vector<UUID> ids;
+		std::vector<std::string> textIds;
+		std::unordered_map<std::string, Entity*> textLookup; // Same layout the scene used with string ids
+		ids.reserve(entities.size());
+		textIds.reserve(entities.size());
+		for (const auto& [id, entity] : entities)
+		{
+			ids.push_back(id);
+			textIds.push_back(id.Get());
+			textLookup[textIds.back()] = entity.get();
+		}
+
+		size_t found = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_LOOKUP_ITERATIONS; ++i)
+		{
+			for (const std::string& id : textIds)
+				found += textLookup.find(id) != textLookup.end();
+		}
+		double textMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_LOOKUP_ITERATIONS; ++i)
+		{
+			for (const UUID& id : ids)
+				found += scene.GetEntity(id) != nullptr;
+		}
+		double binaryMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		size_t mismatches = 0;
+		for (int i = 0; i < BENCHMARK_UUID_COUNT; ++i)
+		{
+			UUID id;
+			if (UUID(id.Get()) != id)
+				++mismatches;
+		}
+		double roundTripMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		double lookups = static_cast<double>(ids.size()) * BENCHMARK_LOOKUP_ITERATIONS;
+		Log::Info("--- Entity Lookup Benchmark ({0} entities x {1}) ---", ids.size(), BENCHMARK_LOOKUP_ITERATIONS);
+		Log::Info("Text keys:   {0:.1f} ns per lookup", textMs * 1000000.0 / lookups);
+		Log::Info("UUID keys:   {0:.1f} ns per lookup (Scene::GetEntity)", binaryMs * 1000000.0 / lookups);
+		Log::Info("Speedup = {0:.2f}x, Found = {1}", textMs / binaryMs, found);
+		Log::Info("Generate + format + parse: {0:.1f} ns per id, Mismatches = {1}", roundTripMs * 1000000.0 / BENCHMARK_UUID_COUNT, mismatches);
+	}
+
+	void Benchmarks::RunTextureImport(const std::filesystem::path& folder)
+	{
+		std::vector<std::filesystem::path> files;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+		{
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			if (entry.is_regular_file() && extension == ".png")
+				files.push_back(entry.path());
+		}
+		if (files.empty())
+		{
+			Log::Warn("Texture import benchmark found no PNG files in {0}", folder.string());
+			return;
+		}
+
+		double devilMs = 0.0, decoderMs = 0.0;
+		double blockCompressMs = 0.0, chunkCompressMs = 0.0;
+		double blockDecompressMs = 0.0, chunkDecompressMs = 0.0;
+		size_t totalBytes = 0, blockBytes = 0, chunkBytes = 0;
+		size_t mismatches = 0, failed = 0;
+
+		std::vector<unsigned char> devilPixels, pixels, decompressed;
+		std::vector<char> compressed;
+		std::vector<uint32_t> chunkSizes;
+		for (const std::filesystem::path& file : files)
+		{
+			int devilWidth = 0, devilHeight = 0, devilChannels = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			bool devilLoaded = ImageDecoder::DecodeWithDevIL(file.string(), devilPixels, devilWidth, devilHeight, devilChannels);
+			devilMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			int width = 0, height = 0, channels = 0;
+			start = std::chrono::high_resolution_clock::now();
+			bool loaded = ImageDecoder::Decode(file.string(), pixels, width, height, channels);
+			decoderMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (!devilLoaded || !loaded)
+			{
+				++failed;
+				continue;
+			}
+			if (devilPixels != pixels)
+				++mismatches;
+			totalBytes += pixels.size();
+			decompressed.resize(pixels.size());
+
+			int bound = LZ4_compressBound(static_cast<int>(pixels.size()));
+			compressed.resize(bound);
+			start = std::chrono::high_resolution_clock::now();
+			int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(pixels.data()), compressed.data(), static_cast<int>(pixels.size()), bound);
+			blockCompressMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			blockBytes += compressedSize;
+
+			start = std::chrono::high_resolution_clock::now();
+			LZ4_decompress_safe(compressed.data(), reinterpret_cast<char*>(decompressed.data()), compressedSize, static_cast<int>(decompressed.size()));
+			blockDecompressMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			compressed.clear();
+			chunkSizes.clear();
+			start = std::chrono::high_resolution_clock::now();
+			ChunkedLZ4::Compress(pixels.data(), pixels.size(), LZ4_CHUNK_SIZE, compressed, chunkSizes);
+			chunkCompressMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			chunkBytes += compressed.size();
+
+			start = std::chrono::high_resolution_clock::now();
+			if (!ChunkedLZ4::Decompress(compressed.data(), chunkSizes.data(), decompressed.data(), decompressed.size(), LZ4_CHUNK_SIZE) || decompressed != pixels)
+				++mismatches;
+			chunkDecompressMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+
+		// MB of RGBA8 pixels per second
+		double megabytes = totalBytes / (1024.0 * 1024.0);
+		auto throughput = [megabytes](double ms) { return ms > 0.0 ? megabytes * 1000.0 / ms : 0.0; };
+		Log::Info("--- Texture Import Benchmark ({0} PNGs, {1:.1f}MB of RGBA8) ---", files.size() - failed, megabytes);
+		Log::Info("Decode DevIL:           {0:.1f} MB/s", throughput(devilMs));
+		Log::Info("Decode stb_image + SIMD: {0:.1f} MB/s ({1:.2f}x)", throughput(decoderMs), devilMs / decoderMs);
+		Log::Info("LZ4 one block:    compress {0:.1f} MB/s, decompress {1:.1f} MB/s, ratio {2:.2f}", throughput(blockCompressMs), throughput(blockDecompressMs),
+			blockBytes > 0 ? double(totalBytes) / blockBytes : 0.0);
+		Log::Info("LZ4 {0}KB chunks: compress {1:.1f} MB/s, decompress {2:.1f} MB/s, ratio {3:.2f}", LZ4_CHUNK_SIZE / 1024, throughput(chunkCompressMs), throughput(chunkDecompressMs),
+			chunkBytes > 0 ? double(totalBytes) / chunkBytes : 0.0);
+		Log::Info("Failed = {0}, Mismatches = {1}", failed, mismatches);
+	}
+
+	void Benchmarks::RunRenderQueueSort()
+	{
+		// Items as the editor would submit them, in scene order: every material belongs to one shader,
+		// one in ten items is blended
+		std::vector<RenderSortEntry> submitted(BENCHMARK_RENDER_ITEM_COUNT);
+		for (uint32_t i = 0; i < BENCHMARK_RENDER_ITEM_COUNT; ++i)
+		{
+			uint32_t material = static_cast<uint32_t>(Random::Get(0, static_cast<int>(BENCHMARK_MATERIAL_COUNT) - 1));
+			uint32_t vertexArray = static_cast<uint32_t>(Random::Get(0, static_cast<int>(BENCHMARK_VERTEX_ARRAY_COUNT) - 1));
+			RenderPass pass = Random::Get(0.0f, 1.0f) < 0.1f ? RenderPass::BLENDED : RenderPass::SOLID;
+			submitted[i].Key = RenderSort::MakeKey(pass, material % BENCHMARK_SHADER_COUNT + 1, material, vertexArray + 1, Random::Get(0.5f, BENCHMARK_WORLD_EXTENT));
+			submitted[i].Index = i;
+		}
+
+		std::vector<RenderSortEntry> radixSorted;
+		std::vector<RenderSortEntry> scratch;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			radixSorted = submitted;
+			RenderSort::RadixSort(radixSorted, scratch);
+		}
+		double radixMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		std::vector<RenderSortEntry> stdSorted;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			stdSorted = submitted;
+			std::stable_sort(stdSorted.begin(), stdSorted.end(), [](const RenderSortEntry& a, const RenderSortEntry& b) { return a.Key < b.Key; });
+		}
+		double stdMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		size_t mismatches = 0;
+		for (uint32_t i = 0; i < BENCHMARK_RENDER_ITEM_COUNT; ++i)
+		{
+			if (radixSorted[i].Index != stdSorted[i].Index)
+				++mismatches;
+		}
+
+		RenderStats submittedStats = RenderSort::CountStateChanges(submitted.data(), submitted.size());
+		RenderStats sortedStats = RenderSort::CountStateChanges(radixSorted.data(), radixSorted.size());
+
+		Log::Info("--- Render Queue Sort Benchmark ({0} items x {1}) ---", BENCHMARK_RENDER_ITEM_COUNT, BENCHMARK_ITERATIONS);
+		Log::Info("Radix sort:  {0:.3f} ms per frame", radixMs / BENCHMARK_ITERATIONS);
+		Log::Info("std::stable_sort: {0:.3f} ms per frame, Mismatches = {1}", stdMs / BENCHMARK_ITERATIONS, mismatches);
+		Log::Info("Submitted: {0} draw calls, shader {1}, material {2}, vertex array {3} changes",
+			submittedStats.DrawCalls, submittedStats.ShaderChanges, submittedStats.MaterialChanges, submittedStats.VertexArrayChanges);
+		Log::Info("Sorted:    {0} draw calls, shader {1}, material {2}, vertex array {3} changes",
+			sortedStats.DrawCalls, sortedStats.ShaderChanges, sortedStats.MaterialChanges, sortedStats.VertexArrayChanges);
+	}
+
+	void Benchmarks::RunSceneCreation()
+	{
+		Log::Info("--- Scene Creation Benchmark (BeginBatch / EndBatch) ---");
+		for (uint32_t count : BENCHMARK_SCENE_SIZES)
+		{
+			Scene scene("");
+			auto start = std::chrono::high_resolution_clock::now();
+			scene.BeginBatch();
+			PopulateScene(scene, count);
+			scene.EndBatch();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			Log::Info("{0} entities: {1:.2f} ms ({2:.2f} us per entity), {3} octree nodes",
+				count, ms, ms * 1000.0 / count, scene.GetOctree().GetStatistics().totalNodes);
+		}
+	}
+
+	void Benchmarks::RunOctree()
+	{
+		Log::Info("--- Octree Benchmark ({0} AABB queries, {1} rays per size) ---", BENCHMARK_QUERY_COUNT, BENCHMARK_OCTREE_RAY_COUNT);
+		for (uint32_t count : BENCHMARK_SCENE_SIZES)
+		{
+			Scene scene("");
+			scene.BeginBatch();
+			PopulateScene(scene, count);
+			scene.EndBatch();
+
+			std::vector<std::shared_ptr<Entity>> entities;
+			std::vector<MeshRenderer*> renderers;
+			entities.reserve(count);
+			renderers.reserve(count);
+			for (const auto& [id, entity] : scene.GetAllEntities())
+			{
+				if (MeshRenderer* renderer = entity->GetComponent<MeshRenderer>())
+				{
+					entities.push_back(entity);
+					renderers.push_back(renderer);
+				}
+			}
+
+			// Insert into a tree of its own, the scene's one was filled at EndBatch
+			Octree octree(AABB(vec3(-BENCHMARK_WORLD_EXTENT), vec3(BENCHMARK_WORLD_EXTENT)));
+			auto start = std::chrono::high_resolution_clock::now();
+			for (const std::shared_ptr<Entity>& entity : entities)
+				octree.Insert(entity);
+			double insertMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			std::vector<AABB> queries(BENCHMARK_QUERY_COUNT);
+			for (AABB& query : queries)
+			{
+				vec3 center(Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+							Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+							Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT));
+				query = AABB(center - vec3(BENCHMARK_QUERY_HALF_SIZE), center + vec3(BENCHMARK_QUERY_HALF_SIZE));
+			}
+
+			std::vector<Entity*> found;
+			size_t octreeFound = 0;
+			start = std::chrono::high_resolution_clock::now();
+			for (const AABB& query : queries)
+			{
+				found.clear();
+				octree.CollectIntersectingObjectsWithAABB(query, found);
+				octreeFound += found.size();
+			}
+			double queryMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			// Same queries through the set overload, the only one the pointer based octree had
+			std::unordered_set<std::shared_ptr<Entity>> foundSet;
+			size_t octreeSetFound = 0;
+			start = std::chrono::high_resolution_clock::now();
+			for (const AABB& query : queries)
+			{
+				foundSet.clear();
+				octree.CollectIntersectingObjectsWithAABB(query, foundSet);
+				octreeSetFound += foundSet.size();
+			}
+			double querySetMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			size_t bruteForceFound = 0;
+			start = std::chrono::high_resolution_clock::now();
+			for (const AABB& query : queries)
+			{
+				for (MeshRenderer* renderer : renderers)
+					bruteForceFound += renderer->GetWorldAABB().Intersects(query);
+			}
+			double bruteForceQueryMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			std::vector<vec3> origins(BENCHMARK_OCTREE_RAY_COUNT);
+			std::vector<vec3> directions(BENCHMARK_OCTREE_RAY_COUNT);
+			for (int i = 0; i < BENCHMARK_OCTREE_RAY_COUNT; ++i)
+			{
+				origins[i] = vec3(Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+								  Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT),
+								  Random::Get(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT));
+				directions[i] = normalize(vec3(Random::Get(-1.0f, 1.0f), Random::Get(-1.0f, 1.0f), Random::Get(-1.0f, 1.0f)) + vec3(0.0001f));
+			}
+			const float maxDistance = BENCHMARK_WORLD_EXTENT * 4.0f;
+
+			std::vector<float> octreeDistances(BENCHMARK_OCTREE_RAY_COUNT, -1.0f);
+			start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < BENCHMARK_OCTREE_RAY_COUNT; ++i)
+			{
+				RaycastHit hit;
+				if (octree.Raycast(origins[i], directions[i], maxDistance, hit))
+					octreeDistances[i] = hit.Distance;
+			}
+			double raycastMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			std::vector<float> bruteForceDistances(BENCHMARK_OCTREE_RAY_COUNT, -1.0f);
+			start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < BENCHMARK_OCTREE_RAY_COUNT; ++i)
+			{
+				float closest = maxDistance;
+				for (MeshRenderer* renderer : renderers)
+				{
+					float distance;
+					unsigned int triangleIndex;
+					vec2 barycentric;
+					if (renderer->Raycast(origins[i], directions[i], closest, distance, triangleIndex, barycentric) && distance < closest)
+					{
+						closest = distance;
+						bruteForceDistances[i] = distance;
+					}
+				}
+			}
+			double bruteForceRaycastMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			size_t mismatches = (octreeFound != bruteForceFound ? 1 : 0) + (octreeSetFound != bruteForceFound ? 1 : 0);
+			for (int i = 0; i < BENCHMARK_OCTREE_RAY_COUNT; ++i)
+			{
+				if (std::abs(octreeDistances[i] - bruteForceDistances[i]) > 0.001f)
+					++mismatches;
+			}
+
+			Log::Info("{0} entities: insert {1:.2f} ms ({2:.2f} us per entity)", count, insertMs, insertMs * 1000.0 / count);
+			Log::Info("  AABB query: {0:.1f} us, set overload {1:.1f} us, brute force {2:.1f} us ({3} found)",
+				queryMs * 1000.0 / BENCHMARK_QUERY_COUNT, querySetMs * 1000.0 / BENCHMARK_QUERY_COUNT,
+				bruteForceQueryMs * 1000.0 / BENCHMARK_QUERY_COUNT, octreeFound);
+			Log::Info("  Raycast:    {0:.1f} us, brute force {1:.1f} us, Mismatches = {2}",
+				raycastMs * 1000.0 / BENCHMARK_OCTREE_RAY_COUNT, bruteForceRaycastMs * 1000.0 / BENCHMARK_OCTREE_RAY_COUNT, mismatches);
+		}
+	}
+
+	void Benchmarks::RunCullingAllocations()
+	{
+		Scene scene("");
+		scene.BeginBatch();
+		PopulateScene(scene, BENCHMARK_CULLING_ENTITY_COUNT);
+		scene.EndBatch();
+		Octree& octree = scene.GetOctree();
+
+		// From outside one side of the world looking at its center
+		matrix4 view = glm::lookAt(vec3(0.0f, 0.0f, -BENCHMARK_WORLD_EXTENT * 1.5f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+		matrix4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.3f, BENCHMARK_WORLD_EXTENT * 3.0f);
+		Frustum frustum;
+		frustum.FromMatrix(projection * view);
+
+		// Warm up first, so the octree's own scratch buffers don't count against either side
+		std::vector<Entity*> visibleEntities;
+		octree.CollectVisibleEntitiesFrustum(frustum, visibleEntities);
+
+		// Before: a fresh set of shared_ptr every frame, the way RenderWorld collected entities
+		size_t setVisible = 0;
+		size_t allocations = AllocationCounter::GetThreadAllocations();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			std::unordered_set<std::shared_ptr<Entity>> visibleSet;
+			octree.CollectVisibleEntitiesFrustum(frustum, visibleSet);
+			setVisible = visibleSet.size();
+		}
+		double setMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		size_t setAllocations = AllocationCounter::GetThreadAllocations() - allocations;
+
+		// After: raw pointers into a vector kept between frames
+		allocations = AllocationCounter::GetThreadAllocations();
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			visibleEntities.clear();
+			octree.CollectVisibleEntitiesFrustum(frustum, visibleEntities);
+		}
+		double vectorMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		size_t vectorAllocations = AllocationCounter::GetThreadAllocations() - allocations;
+
+		Log::Info("--- Culling Allocations Benchmark ({0} entities, {1} passes) ---", BENCHMARK_CULLING_ENTITY_COUNT, BENCHMARK_ITERATIONS);
+		Log::Info("Set of shared_ptr:  {0:.3f} ms, {1} allocations per pass, Visible = {2}",
+			setMs / BENCHMARK_ITERATIONS, setAllocations / BENCHMARK_ITERATIONS, setVisible);
+		Log::Info("Reused vector:      {0:.3f} ms, {1} allocations per pass, Visible = {2}",
+			vectorMs / BENCHMARK_ITERATIONS, vectorAllocations / BENCHMARK_ITERATIONS, visibleEntities.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+
+namespace Loopie
+{
+	class Entity;
+	class Scene;
+
+	// Micro benchmarks run from the Debug menu, results are written to the console
+	class Benchmarks
+	{
+	public:
+		// Compares the scalar and SIMD frustum vs AABB batch tests against the main camera frustum
+		static void RunFrustumCulling();
+		// Compares picking the entity's mesh by brute force over its world space triangles against its BVH
+		static void RunMeshRaycast(const std::shared_ptr<Entity>& entity);
+		// Times Scene::GetEntity(UUID) over every entity of the scene against a map keyed by the text UUID,
+		// plus generating and round tripping ids through their text form. Scene load times are logged on load.
+		static void RunEntityLookup(const Scene& scene);
+		// Radix against std::stable_sort over random render sort keys, and the draw calls (instanced runs)
+		// and state changes of drawing them in submission order against sorted. The renderer's own counts
+		// are under Render Queue Stats
+		static void RunRenderQueueSort();
+		// Creates scenes of 1k, 10k and 100k mesh entities inside BeginBatch / EndBatch, the way scenes and
+		// models load, timing creation plus the single transform and octree pass at EndBatch
+		static void RunSceneCreation();
+		// Octree insert, AABB query and nearest-hit raycast on scenes of 1k, 10k and 100k cubes, each against
+		// a brute force pass over every entity that also checks the octree's results. AABB queries are also
+		// timed through the shared_ptr set overload, the one callers of the old pointer octree used
+		static void RunOctree();
+		// Heap allocations and time of one frustum culling pass over a 10k entity scene, collecting into a new
+		// set of shared_ptr each pass against the reused vector of raw pointers that RenderWorld uses
+		static void RunCullingAllocations();
+		// Over every PNG in the folder: DevIL decode + convert against stb_image + SIMD expansion, and one
+		// LZ4 block against parallel LZ4 chunks both ways, in MB/s of RGBA8 pixels
+		static void RunTextureImport(const std::filesystem::path& folder);
+	};
+}